@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../test/test.h"
+
+#include <chrono>
+
+// benchmarks are plain gtest cases that report their measurements
+// using TEST_PRINTF. they are not part of the unit tests.
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------
+//
+//! run a function the given number of times and return the average duration in nanoseconds
+template<typename Func>
+double bench_ns(size_t a_iterations, Func a_func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < a_iterations; i++) {
+		a_func();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / a_iterations;
+}
+
+//! storage that the compiler must not optimize away
+template<typename T>
+struct bench_sink
+{
+	static volatile T value;
+};
+template<typename T>
+volatile T bench_sink<T>::value;
+
+//! prevent the compiler from optimizing away a value
+template<typename T>
+inline void bench_keep(const T& a_value)
+{
+	bench_sink<T>::value = a_value;
+}
@@ -0,0 +1,94 @@
+#include "../bench.h"
+
+#include "l0_system/socket.h"
+#include "l0_system/system.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#if REMO_SYSTEM & REMO_SYS_POSIX
+	#include <sys/resource.h>
+#endif
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------
+//
+using namespace remo::sys;
+
+//! number of wakeups measured per set size
+static const size_t ITERATIONS = 2000;
+
+//! idle sockets that fit into the descriptor limit, at most the given number
+static size_t max_idle_sockets(size_t a_wanted)
+{
+#if REMO_SYSTEM & REMO_SYS_POSIX
+	rlimit lim {};
+	if (::getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur != RLIM_INFINITY) {
+		// leave some room for the active pair, gtest and the set itself
+		const size_t avail = lim.rlim_cur > 64 ? (size_t)lim.rlim_cur - 64 : 0;
+		return std::min(a_wanted, avail);
+	}
+#endif
+	return a_wanted;
+}
+
+//! average duration in nanoseconds of waking up for one ready socket,
+//! with the given number of idle sockets in the set
+static double bench_wakeup(SocketSet::Backend a_backend, size_t a_idle)
+{
+	SocketSet ss(a_backend);
+
+	// idle sockets never become ready
+	std::vector<std::unique_ptr<Socket>> idle;
+	for (size_t i = 0; i < a_idle; i++) {
+		idle.emplace_back(new Socket(SockProto::UDP));
+		idle.back()->bind(SockAddr::localhost);
+		ss.add(idle.back().get());
+	}
+
+	// one active pair
+	Socket tx(SockProto::UDP);
+	Socket rx(SockProto::UDP);
+	tx.bind(SockAddr::localhost);
+	rx.bind(SockAddr::localhost);
+	tx.connect(rx.get_socket_addr());
+	rx.set_blocking(false);
+	rx.on_receive_ready([&rx](){
+		char buf [1];
+		rx.recv(buf, sizeof(buf));
+	});
+	ss.add(&rx);
+
+	const char data = 0;
+	double ns = bench_ns(ITERATIONS, [&]() {
+		tx.send(&data, sizeof(data));
+		ss.poll(WAIT_FOREVER);
+	});
+
+	ss.remove(&rx);
+	for (auto& socket : idle) {
+		ss.remove(socket.get());
+	}
+	return ns;
+}
+
+//------------------------------------------------------------------------------
+// benchmarks
+//------------------------------------------------------------------------------
+//
+TEST(SocketBench, wakeup)
+{
+	const size_t max_idle = max_idle_sockets(10000);
+	for (size_t idle = 10; idle <= max_idle; idle *= 10) {
+		double poll_ns = bench_wakeup(SocketSet::Backend::Poll, idle);
+		double epoll_ns = bench_wakeup(SocketSet::Backend::Epoll, idle);
+		TEST_PRINTF("%5zu idle sockets: %9.0f -> %7.0f ns per wakeup (x%.1f)\n",
+			idle, poll_ns, epoll_ns, poll_ns / epoll_ns);
+	}
+}
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------
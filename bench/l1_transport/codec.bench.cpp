@@ -0,0 +1,428 @@
+#include "../bench.h"
+
+#include "l1_transport/packet.h"
+#include "l1_transport/reader.h"
+#include "l1_transport/writer.h"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------
+//
+using namespace remo::trans;
+using namespace remo;
+
+//! number of values encoded per packet
+static const size_t VALUES_PER_PACKET = 64;
+//! number of packets encoded per measurement
+static const size_t ITERATIONS = 20000;
+
+//! original byte-wise encoder, used as baseline
+template<typename T>
+static void legacy_write_value(Writer& a_writer, const T& a_value)
+{
+	T value = a_value;
+	unsigned char* p = reinterpret_cast<unsigned char*>(&value);
+	uint8_t wire_size = 0;
+	LITTLE_ENDIAN_FOR(i, sizeof(value)) {
+		if (!value) {
+			break;
+		}
+		++wire_size;
+		p[i] = 0;
+	}
+	value = a_value;
+	a_writer.write<uint8_t>((wire_size << 4) | TypeInfo<T>::id());
+	LITTLE_ENDIAN_FOR(i, wire_size) {
+		a_writer.write<uint8_t>(p[i]);
+	}
+}
+
+//! original byte-wise decoder, used as baseline
+template<typename T>
+static T legacy_read_value(Reader& a_reader)
+{
+	// limited to the value size, as the original decoder had no checks at all
+	size_t wire_size = std::min<size_t>(a_reader.read<uint8_t>() >> 4, sizeof(T));
+	T value{};
+	uint8_t* p = reinterpret_cast<unsigned char*>(&value);
+	LITTLE_ENDIAN_FOR(i, wire_size) {
+		p[i] = a_reader.read<uint8_t>();
+	}
+	return value;
+}
+
+//! original byte-wise array encoder, used as baseline
+template<typename T>
+static void legacy_write_array(Writer& a_writer, const T* a_ptr, size_t a_count)
+{
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(a_ptr);
+	a_writer.write<uint8_t>(TypeInfo<T*>::id());
+	for (size_t j = 0; j < a_count; j++, p += sizeof(T)) {
+		LITTLE_ENDIAN_FOR(i, sizeof(T)) {
+			a_writer.write<uint8_t>(p[i]);
+		}
+	}
+}
+
+//! original byte-wise array decoder, used as baseline
+template<typename T>
+static void legacy_read_array(Reader& a_reader, T* a_dest, size_t a_count)
+{
+	a_reader.read<uint8_t>();
+	uint8_t* p = reinterpret_cast<unsigned char*>(a_dest);
+	for (size_t j = 0; j < a_count; j++, p += sizeof(T)) {
+		LITTLE_ENDIAN_FOR(i, sizeof(T)) {
+			p[i] = a_reader.read<uint8_t>();
+		}
+	}
+}
+
+//! original byte-wise string encoder, used as baseline
+static void legacy_write_cstr(Writer& a_writer, const char* a_string)
+{
+	a_writer.write<uint8_t>(TypeId::type_cstr);
+	for (const char* p = a_string; *p; ++p) {
+		a_writer.write<uint8_t>(*p);
+	}
+	a_writer.write<uint8_t>(0);
+}
+
+//! original byte-wise string decoder, used as baseline
+static const char* legacy_read_cstr(Reader& a_reader, const char* a_data)
+{
+	a_reader.read<uint8_t>();
+	const char* str = a_data;
+	while (a_reader.read<uint8_t>()) { ++str; }
+	return str;
+}
+
+//! values of random magnitude
+template<typename T>
+static std::vector<T> random_values()
+{
+	std::mt19937_64 rng(1986);
+	std::vector<T> values;
+	for (size_t i = 0; i < VALUES_PER_PACKET; i++) {
+		values.push_back(T(rng() >> (rng() % 64)));
+	}
+	return values;
+}
+
+//------------------------------------------------------------------------------
+// benchmarks
+//------------------------------------------------------------------------------
+//
+template<typename T>
+struct CodecBench : public testing::Test
+{
+    using MyParamType = T;
+};
+
+//------------------------------------------------------------------------------
+//
+// booleans have their own encoding, which is not affected
+using NumericTypes = testing::Types<
+    uint8_t, uint16_t, uint32_t, uint64_t,
+    int8_t, int16_t, int32_t, int64_t,
+    float, double
+>;
+TYPED_TEST_SUITE(CodecBench, NumericTypes);
+
+//------------------------------------------------------------------------------
+//
+TYPED_TEST(CodecBench, scalar_values)
+{
+    using NumericType  = typename TestFixture::MyParamType;
+
+    const std::vector<NumericType> values = random_values<NumericType>();
+    Packet packet;
+
+    // encoding
+    double legacy_write_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        Writer writer(packet.get_payload());
+        for (NumericType value : values) {
+            legacy_write_value(writer, value);
+        }
+    });
+    double write_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        BinaryWriter writer(packet.get_payload());
+        for (NumericType value : values) {
+            writer.write_value(value);
+        }
+    });
+
+    // decoding. the original decoder only understands the original encoding
+    Packet legacy_packet;
+    {
+        Writer writer(legacy_packet.get_payload());
+        for (NumericType value : values) {
+            legacy_write_value(writer, value);
+        }
+    }
+    double legacy_read_ns = bench_ns(ITERATIONS, [&]() {
+        Reader reader(legacy_packet.get_payload());
+        for (size_t i = 0; i < values.size(); i++) {
+            bench_keep(legacy_read_value<NumericType>(reader));
+        }
+    });
+    double read_ns = bench_ns(ITERATIONS, [&]() {
+        BinaryReader reader(packet.get_payload());
+        uint8_t wire_size = 0;
+        for (size_t i = 0; i < values.size(); i++) {
+            reader.read_type(wire_size);
+            bench_keep(reader.read_value<NumericType>(wire_size));
+        }
+    });
+
+    TEST_PRINTF("%-9s write: %6.2f -> %6.2f ns/value (x%.1f), read: %6.2f -> %6.2f ns/value (x%.1f)\n",
+        get_type_name(TypeInfo<NumericType>::id()),
+        legacy_write_ns / values.size(), write_ns / values.size(), legacy_write_ns / write_ns,
+        legacy_read_ns / values.size(), read_ns / values.size(), legacy_read_ns / read_ns);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(CodecBench, double_wire_size)
+{
+    // telemetry-like samples: counters, readings with one decimal, and raw measurements
+    std::mt19937_64 rng(1986);
+    std::vector<double> values;
+    for (size_t i = 0; i < VALUES_PER_PACKET; i++) {
+        switch (i % 3) {
+        case 0: values.push_back(double(rng() % 100000)); break;
+        case 1: values.push_back(double(rng() % 10000) / 10.0); break;
+        default: values.push_back(double(rng() % 1000000) / 997.0); break;
+        }
+    }
+
+    Packet legacy_packet;
+    Writer legacy_writer(legacy_packet.get_payload());
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    for (double value : values) {
+        legacy_write_value(legacy_writer, value);
+        writer.write_value(value);
+    }
+
+    TEST_PRINTF("double wire size: %5.2f -> %5.2f bytes/value\n",
+        double(legacy_packet.get_payload().get_size()) / values.size(),
+        double(packet.get_payload().get_size()) / values.size());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(CodecBench, float_array)
+{
+    //! number of floats, such that they fit into a packet
+    const size_t COUNT = 200;
+
+    std::vector<float> values(COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        values[i] = i * 0.5f;
+    }
+    std::vector<float> received(COUNT);
+    Packet packet;
+
+    // encoding
+    double legacy_write_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        Writer writer(packet.get_payload());
+        legacy_write_array(writer, values.data(), COUNT);
+    });
+    double write_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        BinaryWriter writer(packet.get_payload());
+        writer.write_value(values);
+    });
+
+    // decoding: the original decoder copies, the new one provides the items in place
+    packet.get_payload().set_size(0);
+    {
+        Writer writer(packet.get_payload());
+        legacy_write_array(writer, values.data(), COUNT);
+    }
+    double legacy_read_ns = bench_ns(ITERATIONS, [&]() {
+        Reader reader(packet.get_payload());
+        legacy_read_array(reader, received.data(), COUNT);
+        bench_keep(received[COUNT - 1]);
+    });
+    packet.get_payload().set_size(0);
+    {
+        BinaryWriter writer(packet.get_payload());
+        writer.write_value(values);
+    }
+    double read_ns = bench_ns(ITERATIONS, [&]() {
+        BinaryReader reader(packet.get_payload());
+        reader.read_typed_value();
+        bench_keep(reader.read_typed_value().get<const float*>()[COUNT - 1]);
+    });
+
+    TEST_PRINTF("%zu floats write: %8.2f -> %6.2f ns (x%.1f), read: %8.2f -> %6.2f ns (x%.1f)\n",
+        COUNT,
+        legacy_write_ns, write_ns, legacy_write_ns / write_ns,
+        legacy_read_ns, read_ns, legacy_read_ns / read_ns);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(CodecBench, timestamp_array)
+{
+    //! number of timestamps, such that the plain ones fit into a packet
+    const size_t COUNT = 100;
+
+    // microsecond timestamps with some jitter
+    std::mt19937_64 rng(1986);
+    std::vector<uint64_t> values;
+    uint64_t timestamp = 1700000000000000ULL;
+    for (size_t i = 0; i < COUNT; i++) {
+        timestamp += 1000 + rng() % 50;
+        values.push_back(timestamp);
+    }
+    Packet packet;
+
+    // plain: mutable pointers are never delta-encoded
+    std::vector<uint64_t> mutable_values = values;
+    uint64_t* plain = mutable_values.data();
+    size_t plain_size = 0;
+    double plain_write_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        BinaryWriter writer(packet.get_payload());
+        writer.write_value(arraysize_t(COUNT));
+        writer.write_value(plain);
+        plain_size = packet.get_payload().get_size();
+    });
+    double plain_read_ns = bench_ns(ITERATIONS, [&]() {
+        BinaryReader reader(packet.get_payload());
+        reader.read_typed_value();
+        bench_keep(reader.read_typed_value().get<uint64_t*>()[COUNT - 1]);
+    });
+
+    // delta-encoded
+    size_t delta_size = 0;
+    double delta_write_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        BinaryWriter writer(packet.get_payload());
+        writer.write_value(values);
+        delta_size = packet.get_payload().get_size();
+    });
+    double delta_read_ns = bench_ns(ITERATIONS, [&]() {
+        BinaryReader reader(packet.get_payload());
+        reader.read_typed_value();
+        bench_keep(reader.read_typed_value().get<const uint64_t*>()[COUNT - 1]);
+    });
+
+    TEST_PRINTF("%zu timestamps: %zu -> %zu bytes, write: %8.2f -> %8.2f ns, read: %8.2f -> %8.2f ns\n",
+        COUNT, plain_size, delta_size, 
+        plain_write_ns, delta_write_ns, plain_read_ns, delta_read_ns);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(CodecBench, strings)
+{
+    //! typical key or path
+    const std::string value = "devices/sensor-0042/temperature";
+    //! number of strings, such that they fit into a packet
+    const size_t COUNT = 16;
+    Packet packet;
+
+    // encoding
+    double legacy_write_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        Writer writer(packet.get_payload());
+        for (size_t i = 0; i < COUNT; i++) {
+            legacy_write_cstr(writer, value.c_str());
+        }
+    });
+    double write_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        BinaryWriter writer(packet.get_payload());
+        for (size_t i = 0; i < COUNT; i++) {
+            writer.write_value(value);
+        }
+    });
+
+    // decoding
+    packet.get_payload().set_size(0);
+    {
+        Writer writer(packet.get_payload());
+        for (size_t i = 0; i < COUNT; i++) {
+            legacy_write_cstr(writer, value.c_str());
+        }
+    }
+    double legacy_read_ns = bench_ns(ITERATIONS, [&]() {
+        Reader reader(packet.get_payload());
+        for (size_t i = 0; i < COUNT; i++) {
+            bench_keep(legacy_read_cstr(reader, value.c_str()));
+        }
+    });
+    double nul_read_ns = bench_ns(ITERATIONS, [&]() {
+        BinaryReader reader(packet.get_payload());
+        for (size_t i = 0; i < COUNT; i++) {
+            bench_keep(reader.read_typed_value().get<const char*>());
+        }
+    });
+    packet.get_payload().set_size(0);
+    {
+        BinaryWriter writer(packet.get_payload());
+        for (size_t i = 0; i < COUNT; i++) {
+            writer.write_value(value);
+        }
+    }
+    double read_ns = bench_ns(ITERATIONS, [&]() {
+        BinaryReader reader(packet.get_payload());
+        for (size_t i = 0; i < COUNT; i++) {
+            bench_keep(reader.read_typed_value().get<const char*>());
+        }
+    });
+
+    TEST_PRINTF("%zu-char string write: %6.2f -> %6.2f ns (x%.1f), read: %6.2f -> %6.2f (memchr) / %6.2f (length) ns\n",
+        value.size(),
+        legacy_write_ns / COUNT, write_ns / COUNT, legacy_write_ns / write_ns,
+        legacy_read_ns / COUNT, nul_read_ns / COUNT, read_ns / COUNT);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(CodecBench, scalar_call)
+{
+    //! call with scalar arguments only, whose size is bounded at compile time
+    uint32_t id = 123456;
+    double value = 21.5;
+    int16_t offset = -3;
+    bool enabled = true;
+    uint64_t timestamp = 1700000000000000ull;
+    Packet packet;
+
+    double per_value_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        BinaryWriter writer(packet.get_payload());
+        writer.write<uint8_t>(PacketType::packet_call);
+        writer.write_value(uint32_t(42));
+        writer.write_value(id);
+        writer.write_value(value);
+        writer.write_value(offset);
+        writer.write_value(enabled);
+        writer.write_value(timestamp);
+        bench_keep(packet.get_payload().get_size());
+    });
+    double reserved_ns = bench_ns(ITERATIONS, [&]() {
+        packet.get_payload().set_size(0);
+        BinaryWriter writer(packet.get_payload());
+        writer.write_call(42, id, value, offset, enabled, timestamp);
+        bench_keep(packet.get_payload().get_size());
+    });
+
+    TEST_PRINTF("5-argument scalar call write: %6.2f ns per value -> %6.2f ns reserved (x%.1f)\n",
+        per_value_ns, reserved_ns, per_value_ns / reserved_ns);
+}
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------
@@ -0,0 +1,231 @@
+#include "../bench.h"
+
+#include "l1_transport/reader.h"
+#include "l1_transport/writer.h"
+#include "l1_transport/tcp/tcp-transport.h"
+#include "l1_transport/uds/uds-transport.h"
+#include "utils/logger.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------
+//
+using namespace remo::trans;
+using namespace remo;
+
+//! number of packets sent per measurement
+static const size_t ITERATIONS = 50000;
+
+//! send small packets as fast as possible and return the average duration
+//! until each of them was received, in nanoseconds
+static double bench_receive(const TcpTransport::Settings& a_settings)
+{
+	TcpTransport transport(a_settings);
+
+	std::promise<void> p;
+	auto f = p.get_future();
+	std::atomic<size_t> received(0);
+	transport.on_accept([&p, &received](Channel* a_channel) {
+		a_channel->on_receive([&p, &received](Channel*, packet_ptr&) {
+			if (++received == ITERATIONS) {
+				p.set_value();
+			}
+		});
+	});
+
+	Channel* channel = transport.connect("localhost:1986");
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < ITERATIONS; i++) {
+		packet_ptr packet = transport.take_packet();
+		Writer writer(packet->get_payload());
+		writer.write<uint64_t>(i);
+		channel->send(packet);
+	}
+	f.wait();
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / ITERATIONS;
+}
+
+//! send small packets on the given number of connections at once, each from
+//! its own thread, and return the number of packets received per second
+static double bench_receive_parallel(const TcpTransport::Settings& a_settings,
+	size_t a_connections)
+{
+	TcpTransport transport(a_settings);
+
+	std::promise<void> p;
+	auto f = p.get_future();
+	std::atomic<size_t> received(0);
+	const size_t total = ITERATIONS * a_connections;
+	transport.on_accept([&p, &received, total](Channel* a_channel) {
+		a_channel->on_receive([&p, &received, total](Channel*, packet_ptr&) {
+			if (++received == total) {
+				p.set_value();
+			}
+		});
+	});
+
+	std::vector<Channel*> channels;
+	for (size_t i = 0; i < a_connections; i++) {
+		channels.push_back(transport.connect("localhost:1986"));
+	}
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> senders;
+	for (Channel* channel : channels) {
+		senders.emplace_back([&transport, channel]() {
+			for (size_t i = 0; i < ITERATIONS; i++) {
+				packet_ptr packet = transport.take_packet();
+				Writer writer(packet->get_payload());
+				writer.write<uint64_t>(i);
+				channel->send(packet);
+			}
+		});
+	}
+	for (std::thread& sender : senders) {
+		sender.join();
+	}
+	f.wait();
+	auto stop = std::chrono::steady_clock::now();
+	return total / std::chrono::duration<double>(stop - start).count();
+}
+
+//! send small packets one at a time, each after the previous one was echoed,
+//! and return the average round trip time in nanoseconds
+template<typename SomeTransport>
+static double bench_round_trip(const typename SomeTransport::Settings& a_settings)
+{
+	const size_t ROUND_TRIPS = ITERATIONS / 10;
+
+	SomeTransport transport(a_settings);
+	transport.on_accept([&transport](Channel* a_channel) {
+		a_channel->on_receive([&transport](Channel* a_channel, packet_ptr& a_packet) {
+			packet_ptr reply = transport.take_packet();
+			Writer(reply->get_payload()).write<uint64_t>(Reader(a_packet->get_payload()).read<uint64_t>());
+			a_channel->send(reply);
+		});
+	});
+
+	std::promise<void> p;
+	auto f = p.get_future();
+	Channel* channel = transport.connect(a_settings.listen_addr.to_string());
+	auto send_next = [&transport, channel](uint64_t a_value) {
+		packet_ptr packet = transport.take_packet();
+		Writer(packet->get_payload()).write<uint64_t>(a_value);
+		channel->send(packet);
+	};
+	channel->on_receive([&p, &send_next, ROUND_TRIPS](Channel*, packet_ptr& a_packet) {
+		const uint64_t value = Reader(a_packet->get_payload()).read<uint64_t>() + 1;
+		if (value == ROUND_TRIPS) {
+			p.set_value();
+		} else {
+			send_next(value);
+		}
+	});
+
+	auto start = std::chrono::steady_clock::now();
+	send_next(0);
+	f.wait();
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / ROUND_TRIPS;
+}
+
+//------------------------------------------------------------------------------
+// benchmarks
+//------------------------------------------------------------------------------
+//
+TEST(TransportBench, receive)
+{
+	// logging would dominate
+	const LogLevel level = Logger::get_global_level();
+	Logger::set_global_level(LogLevel::eLogError);
+
+	TcpTransport::Settings settings;
+	settings.listen_addr = SockAddr("localhost:1986");
+	double socket_set_ns = bench_receive(settings);
+	settings.io_uring = true;
+	double io_uring_ns = bench_receive(settings);
+
+	Logger::set_global_level(level);
+
+	TEST_PRINTF("socket set: %7.0f ns per packet, io_uring: %7.0f ns per packet (x%.1f)\n",
+		socket_set_ns, io_uring_ns, socket_set_ns / io_uring_ns);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(TransportBench, coalescing)
+{
+	// logging would dominate
+	const LogLevel level = Logger::get_global_level();
+	Logger::set_global_level(LogLevel::eLogError);
+
+	TcpTransport::Settings settings;
+	settings.listen_addr = SockAddr("localhost:1986");
+	settings.tcp_nodelay = true;
+	double immediate_ns = bench_receive(settings);
+	settings.send_coalesce_us = 50;
+	double coalesced_ns = bench_receive(settings);
+
+	Logger::set_global_level(level);
+
+	TEST_PRINTF("sent right away: %7.0f ns per packet, coalesced: %7.0f ns per packet (x%.1f)\n",
+		immediate_ns, coalesced_ns, immediate_ns / coalesced_ns);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(TransportBench, uds)
+{
+	// logging would dominate
+	const LogLevel level = Logger::get_global_level();
+	Logger::set_global_level(LogLevel::eLogError);
+
+	TcpTransport::Settings tcp_settings;
+	tcp_settings.listen_addr = SockAddr("localhost:1986");
+	tcp_settings.tcp_nodelay = true;
+	double tcp_ns = bench_round_trip<TcpTransport>(tcp_settings);
+	UdsTransport::Settings uds_settings;
+	uds_settings.listen_addr = SockAddr("unix:///tmp/remo-bench.sock");
+	double uds_ns = bench_round_trip<UdsTransport>(uds_settings);
+
+	Logger::set_global_level(level);
+
+	TEST_PRINTF("TCP: %7.0f ns per round trip, Unix domain socket: %7.0f ns per round trip (x%.1f)\n",
+		tcp_ns, uds_ns, tcp_ns / uds_ns);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(TransportBench, reactors)
+{
+	const size_t CONNECTIONS = 8;
+
+	// logging would dominate
+	const LogLevel level = Logger::get_global_level();
+	Logger::set_global_level(LogLevel::eLogError);
+
+	TcpTransport::Settings settings;
+	settings.listen_addr = SockAddr("localhost:1986");
+	const unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+	double single = 0;
+	for (size_t reactors = 1; reactors <= std::min<size_t>(cores, CONNECTIONS); reactors *= 2) {
+		settings.reactors = reactors;
+		double rate = bench_receive_parallel(settings, CONNECTIONS);
+		if (reactors == 1) {
+			single = rate;
+		}
+		TEST_PRINTF("%2zu reactors: %9.0f packets per second (x%.1f)\n",
+			reactors, rate, rate / single);
+	}
+
+	Logger::set_global_level(level);
+}
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+#include "../bench.h"
+
+#include "utils/recycling.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------
+//
+using namespace remo;
+
+//! number of take/recycle pairs per thread
+static const size_t ITERATIONS = 200000;
+
+class BenchObject: public Recyclable<BenchObject>
+{
+public:
+	using Recyclable<BenchObject>::recycle;
+};
+
+//! original pool, a stack protected by a mutex, used as baseline
+class MutexPool
+{
+public:
+	~MutexPool()
+	{
+		for (BenchObject* obj : m_objects) {
+			delete obj;
+		}
+	}
+	void add(BenchObject* a_object)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_objects.push_back(a_object);
+	}
+	BenchObject* take()
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (m_objects.empty()) {
+			return nullptr;
+		}
+		BenchObject* obj = m_objects.back();
+		m_objects.pop_back();
+		return obj;
+	}
+private:
+	std::vector<BenchObject*> m_objects;
+	std::mutex m_lock;
+};
+
+//! take and give back objects on the given number of threads at once.
+//! returns the average duration of a take/recycle pair in nanoseconds
+template<typename Take, typename Recycle>
+static double bench_threads(size_t a_threads, Take a_take, Recycle a_recycle)
+{
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t t = 0; t < a_threads; t++) {
+		threads.emplace_back([&]() {
+			for (size_t i = 0; i < ITERATIONS; i++) {
+				BenchObject* obj = a_take();
+				if (obj) {
+					a_recycle(obj);
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(stop - start).count() / (a_threads * ITERATIONS);
+}
+
+//------------------------------------------------------------------------------
+// benchmarks
+//------------------------------------------------------------------------------
+//
+TEST(RecyclingBench, contention)
+{
+	for (size_t threads = 1; threads <= 32; threads *= 2) {
+		// enough objects for every thread
+		MutexPool mutex_pool;
+		RecyclingPool<BenchObject> pool;
+		for (size_t i = 0; i < 2 * threads; i++) {
+			mutex_pool.add(new BenchObject());
+			pool.add(new BenchObject());
+		}
+
+		double mutex_ns = bench_threads(threads, 
+			[&]() { return mutex_pool.take(); }, 
+			[&](BenchObject* a_obj) { mutex_pool.add(a_obj); });
+		double lockfree_ns = bench_threads(threads, 
+			[&]() { return pool.take(); }, 
+			[&](BenchObject* a_obj) { a_obj->recycle(); });
+
+		TEST_PRINTF("%2zu threads: %7.2f -> %7.2f ns per take/recycle (x%.1f)\n",
+			threads, mutex_ns, lockfree_ns, mutex_ns / lockfree_ns);
+	}
+}
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------
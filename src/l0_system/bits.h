@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+#include "system.h"
+//
+// C++
+#include <stdint.h>
+//
+// system
+#if REMO_SYSTEM & REMO_SYS_WINDOWS
+	#include <intrin.h>
+#endif
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace sys {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// function declarations
+//------------------------------------------------------------------------------
+//
+//! number of leading zero bits. the result is undefined for a value of 0
+inline unsigned count_leading_zeros(uint64_t a_value);
+
+
+//------------------------------------------------------------------------------
+// function implementations
+//------------------------------------------------------------------------------
+//
+inline unsigned count_leading_zeros(uint64_t a_value)
+{
+#if REMO_SYSTEM & REMO_SYS_WINDOWS
+	unsigned long index = 0;
+	#ifdef _WIN64
+		_BitScanReverse64(&index, a_value);
+		return 63 - (unsigned)index;
+	#else
+		// no 64 bit intrinsic available, scan the two halves separately
+		if (a_value >> 32) {
+			_BitScanReverse(&index, (unsigned long)(a_value >> 32));
+			return 31 - (unsigned)index;
+		}
+		_BitScanReverse(&index, (unsigned long)a_value);
+		return 63 - (unsigned)index;
+	#endif
+#else
+	return (unsigned)__builtin_clzll(a_value);
+#endif
+}
+
+
+//------------------------------------------------------------------------------
+	} // end namespace sys
+} // end namespace remo
+//------------------------------------------------------------------------------
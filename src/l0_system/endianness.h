@@ -18,7 +18,9 @@
 //
 // C++ 
 #include <stdint.h>
+#include <stddef.h> // size_t
 #include <cstring> // memcpy
+#include <algorithm> // reverse
 //
 //
 //------------------------------------------------------------------------------
@@ -94,6 +96,9 @@ inline void set_le_ua(uint16_t* a_dst, uint16_t a_value);
 inline void set_le_ua(uint32_t* a_dst, uint32_t a_value);
 inline void set_le_ua(uint64_t* a_dst, uint64_t a_value);
 
+//! in-place conversion of an array between little-endian and native byte order
+inline void convert_le_array(void* a_data, size_t a_count, size_t a_item_size);
+
 
 //------------------------------------------------------------------------------
 // function implementations
@@ -219,6 +224,21 @@ inline void set_le_ua(uint64_t* a_dst, uint64_t a_value)
 	std::memcpy(a_dst, &a_value, sizeof(a_value));
 }
 
+//------------------------------------------------------------------------------
+//
+inline void convert_le_array(void* a_data, size_t a_count, size_t a_item_size)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	uint8_t* p = static_cast<uint8_t*>(a_data);
+	for (size_t i = 0; i < a_count; i++, p += a_item_size) {
+		std::reverse(p, p + a_item_size);
+	}
+#else
+	// already in little-endian order
+	(void)a_data; (void)a_count; (void)a_item_size;
+#endif
+}
+
 
 //------------------------------------------------------------------------------
 	} // end namespace sys
@@ -59,6 +59,10 @@ enum ErrorCode {
 	ERR_SOCKET_RECV_FAILED = 36,
 	ERR_SOCKET_RECV_INCOMPLETE = 37,
 	ERR_WORKER_BAD_THREAD_STATE = 38,
+	ERR_SLAB_ALLOC_FAILED = 39,
+	ERR_IO_URING_FAILED = 40,
+	ERR_SEND_QUEUE_FULL = 41,
+	ERR_SOCKET_INVALID_ADDRESS = 42,
 };
 
 //------------------------------------------------------------------------------
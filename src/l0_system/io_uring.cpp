@@ -0,0 +1,492 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#include "io_uring.h"
+
+#include "system.h"
+#include "error.h"
+#include "utils/logger.h"
+#include "utils/contracts.h"
+
+#include <algorithm>
+
+//! io_uring support, on by default under Linux. define as 0 to build without it
+#ifndef REMO_IO_URING
+	#define REMO_IO_URING ((REMO_SYSTEM & REMO_SYS_LINUX) == REMO_SYS_LINUX)
+#endif
+// kernel headers too old to know about it
+#if REMO_IO_URING && defined(__has_include)
+	#if !__has_include(<linux/io_uring.h>)
+		#undef REMO_IO_URING
+		#define REMO_IO_URING 0
+	#endif
+#endif
+
+#if REMO_IO_URING
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <sys/utsname.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#include <errno.h>
+	#include <string.h>
+	#include <stdio.h>
+	// multishot receive came last, with Linux 6.0
+	#ifndef IORING_RECV_MULTISHOT
+		#undef REMO_IO_URING
+		#define REMO_IO_URING 0
+	#endif
+#endif
+
+
+//------------------------------------------------------------------------------
+namespace remo {
+namespace sys {
+//------------------------------------------------------------------------------
+
+//! logger instance
+static Logger logger("IoUring");
+
+#if REMO_IO_URING
+
+//! the one group of provided buffers
+static const uint16_t BUFFER_GROUP = 0;
+
+//------------------------------------------------------------------------------
+// class implementation
+//------------------------------------------------------------------------------
+//
+struct IoUring::impl {
+	int m_fd = -1;
+	//! submission and completion rings, possibly mapped at once
+	void* m_sq_ptr = MAP_FAILED;
+	size_t m_sq_size = 0;
+	void* m_cq_ptr = MAP_FAILED;
+	size_t m_cq_size = 0;
+	io_uring_sqe* m_sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+	size_t m_sqes_size = 0;
+	//! submission ring, shared with the kernel
+	unsigned* m_sq_head = nullptr;
+	unsigned* m_sq_tail = nullptr;
+	unsigned m_sq_mask = 0;
+	unsigned m_sq_entries = 0;
+	//! tail of the operations queued, published on submission
+	unsigned m_sqe_tail = 0;
+	//! completion ring, shared with the kernel
+	unsigned* m_cq_head = nullptr;
+	unsigned* m_cq_tail = nullptr;
+	unsigned m_cq_mask = 0;
+	io_uring_cqe* m_cqes = nullptr;
+	//! ring of provided buffers. NOTE: not accessed through io_uring_buf_ring::bufs,
+	//! which C++ compilers may place after an empty struct of its flexible array macro
+	io_uring_buf* m_buffers = static_cast<io_uring_buf*>(MAP_FAILED);
+	size_t m_buffers_size = 0;
+	uint16_t m_buffers_mask = 0;
+	uint16_t m_buffers_tail = 0;
+
+	io_uring_sqe* get_sqe();
+	int enter(unsigned a_to_submit, unsigned a_min_complete, unsigned a_flags,
+		void* a_arg = nullptr, size_t a_argsz = 0);
+	void release();
+};
+
+//------------------------------------------------------------------------------
+//
+static void throw_syscall_failed(const char* a_syscall, int a_err)
+{
+	REMO_THROW(ErrorCode::ERR_IO_URING_FAILED,
+		"Syscall %s() failed with error %d: %s",
+		a_syscall, a_err, strerror(a_err));
+}
+
+//------------------------------------------------------------------------------
+//
+IoUring::IoUring(unsigned a_entries):
+	pimpl(new impl)
+{
+	// cooperative task running avoids interrupting us for completions,
+	// as we pick them up in our own loop anyway
+	io_uring_params params {};
+	params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP |
+		IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+	// multishot operations complete much more often than they are submitted
+	params.cq_entries = 4 * a_entries;
+	pimpl->m_fd = static_cast<int>(syscall(__NR_io_uring_setup, a_entries, &params));
+	if (pimpl->m_fd < 0 && errno == EINVAL) {
+		// flags not known by older kernels
+		const unsigned cq_entries = params.cq_entries;
+		params = io_uring_params();
+		params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+		params.cq_entries = cq_entries;
+		pimpl->m_fd = static_cast<int>(syscall(__NR_io_uring_setup, a_entries, &params));
+	}
+	if REMO_UNLIKELY(pimpl->m_fd < 0) {
+		int err = errno;
+		delete pimpl;
+		throw_syscall_failed("io_uring_setup", err);
+	}
+
+	// map rings
+	pimpl->m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	pimpl->m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		pimpl->m_sq_size = pimpl->m_cq_size = std::max(pimpl->m_sq_size, pimpl->m_cq_size);
+	}
+	pimpl->m_sq_ptr = mmap(nullptr, pimpl->m_sq_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, pimpl->m_fd, IORING_OFF_SQ_RING);
+	if (pimpl->m_sq_ptr != MAP_FAILED) {
+		if (params.features & IORING_FEAT_SINGLE_MMAP) {
+			pimpl->m_cq_ptr = pimpl->m_sq_ptr;
+		} else {
+			pimpl->m_cq_ptr = mmap(nullptr, pimpl->m_cq_size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, pimpl->m_fd, IORING_OFF_CQ_RING);
+		}
+	}
+	pimpl->m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	if (pimpl->m_cq_ptr != MAP_FAILED) {
+		pimpl->m_sqes = static_cast<io_uring_sqe*>(mmap(nullptr, pimpl->m_sqes_size,
+			PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pimpl->m_fd, IORING_OFF_SQES));
+	}
+	if REMO_UNLIKELY(pimpl->m_sqes == MAP_FAILED) {
+		int err = errno;
+		pimpl->release();
+		delete pimpl;
+		throw_syscall_failed("mmap", err);
+	}
+
+	uint8_t* sq = static_cast<uint8_t*>(pimpl->m_sq_ptr);
+	pimpl->m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+	pimpl->m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	pimpl->m_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	pimpl->m_sq_entries = params.sq_entries;
+	pimpl->m_sqe_tail = *pimpl->m_sq_tail;
+	// submission entries are used in ring order, so map them one to one
+	unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+	for (unsigned i = 0; i < params.sq_entries; i++) {
+		array[i] = i;
+	}
+
+	uint8_t* cq = static_cast<uint8_t*>(pimpl->m_cq_ptr);
+	pimpl->m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	pimpl->m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	pimpl->m_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	pimpl->m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+	REMO_INFO("created ring #%d with %u/%u entries",
+		pimpl->m_fd, params.sq_entries, params.cq_entries);
+}
+
+//------------------------------------------------------------------------------
+//
+IoUring::~IoUring()
+{
+	pimpl->release();
+	delete pimpl;
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::impl::release()
+{
+	// closing the ring also unregisters the provided buffers
+	if (m_fd >= 0) {
+		::close(m_fd);
+	}
+	if (m_buffers != MAP_FAILED) {
+		munmap(m_buffers, m_buffers_size);
+	}
+	if (m_sqes != MAP_FAILED) {
+		munmap(m_sqes, m_sqes_size);
+	}
+	if (m_cq_ptr != MAP_FAILED && m_cq_ptr != m_sq_ptr) {
+		munmap(m_cq_ptr, m_cq_size);
+	}
+	if (m_sq_ptr != MAP_FAILED) {
+		munmap(m_sq_ptr, m_sq_size);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+bool IoUring::is_supported()
+{
+	static const bool supported = []() {
+		// multishot receive needs Linux 6.0
+		utsname name;
+		unsigned major = 0, minor = 0;
+		if (uname(&name) != 0 || sscanf(name.release, "%u.%u", &major, &minor) != 2) {
+			return false;
+		}
+		if (major < 6) {
+			REMO_INFO("not supported by Linux %u.%u", major, minor);
+			return false;
+		}
+		// the system call may still be disabled, e.g. by seccomp or sysctl
+		try {
+			IoUring ring(2);
+			ring.setup_buffers(1);
+			return true;
+		} catch (const error& e) {
+			REMO_INFO("not available: %s", e.what());
+			return false;
+		}
+	}();
+	return supported;
+}
+
+//------------------------------------------------------------------------------
+//
+io_uring_sqe* IoUring::impl::get_sqe()
+{
+	// ring full? submit what we have to make room
+	if (m_sqe_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+		__atomic_store_n(m_sq_tail, m_sqe_tail, __ATOMIC_RELEASE);
+		enter(m_sq_entries, 0, 0);
+		REMO_THROW_IF(m_sqe_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries,
+			ErrorCode::ERR_IO_URING_FAILED, "submission ring full");
+	}
+	io_uring_sqe* sqe = &m_sqes[m_sqe_tail & m_sq_mask];
+	memset(sqe, 0, sizeof(*sqe));
+	++m_sqe_tail;
+	return sqe;
+}
+
+//------------------------------------------------------------------------------
+//
+int IoUring::impl::enter(unsigned a_to_submit, unsigned a_min_complete, unsigned a_flags,
+	void* a_arg, size_t a_argsz)
+{
+	int ret = static_cast<int>(syscall(__NR_io_uring_enter, m_fd, a_to_submit, a_min_complete,
+		a_flags, a_arg, a_argsz));
+	if (ret < 0) {
+		switch (errno) {
+		case EINTR:   // interrupted by a signal
+		case ETIME:   // timeout expired
+		case EAGAIN:  // out of resources for now
+		case EBUSY:   // completion ring full, reap some first
+			return 0;
+		default:
+			throw_syscall_failed("io_uring_enter", errno);
+		}
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::accept_multishot(int a_fd, uint64_t a_user_data)
+{
+	io_uring_sqe* sqe = pimpl->get_sqe();
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = a_fd;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->user_data = a_user_data;
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::recv_multishot(int a_fd, uint64_t a_user_data)
+{
+	io_uring_sqe* sqe = pimpl->get_sqe();
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = a_fd;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = BUFFER_GROUP;
+	sqe->user_data = a_user_data;
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::poll_multishot(int a_fd, uint64_t a_user_data)
+{
+	io_uring_sqe* sqe = pimpl->get_sqe();
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = a_fd;
+	sqe->len = IORING_POLL_ADD_MULTI;
+	sqe->poll32_events = POLLIN;
+	sqe->user_data = a_user_data;
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::poll_send(int a_fd, uint64_t a_user_data)
+{
+	io_uring_sqe* sqe = pimpl->get_sqe();
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = a_fd;
+	sqe->poll32_events = POLLOUT;
+	sqe->user_data = a_user_data;
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::cancel(uint64_t a_target, uint64_t a_user_data)
+{
+	io_uring_sqe* sqe = pimpl->get_sqe();
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = a_target;
+	sqe->user_data = a_user_data;
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::setup_buffers(uint16_t a_entries)
+{
+	REMO_ASSERT(a_entries > 0 && (a_entries & (a_entries - 1)) == 0,
+		"number of buffers must be a power of two");
+	REMO_ASSERT(pimpl->m_buffers == MAP_FAILED,
+		"buffers must be set up only once");
+
+	// the ring must be page aligned, so map it
+	const size_t size = a_entries * sizeof(io_uring_buf);
+	void* buffers = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if REMO_UNLIKELY(buffers == MAP_FAILED) {
+		throw_syscall_failed("mmap", errno);
+	}
+
+	io_uring_buf_reg reg {};
+	reg.ring_addr = reinterpret_cast<uint64_t>(buffers);
+	reg.ring_entries = a_entries;
+	reg.bgid = BUFFER_GROUP;
+	if REMO_UNLIKELY(syscall(__NR_io_uring_register, pimpl->m_fd,
+		IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+		int err = errno;
+		munmap(buffers, size);
+		throw_syscall_failed("io_uring_register", err);
+	}
+
+	pimpl->m_buffers = static_cast<io_uring_buf*>(buffers);
+	pimpl->m_buffers_size = size;
+	pimpl->m_buffers_mask = static_cast<uint16_t>(a_entries - 1);
+	pimpl->m_buffers_tail = 0;
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::provide_buffer(uint16_t a_id, void* a_data, size_t a_size)
+{
+	// NOTE: the tail shares its place with a reserved field of the first entry,
+	// so that field must be left alone
+	io_uring_buf* buf = &pimpl->m_buffers[pimpl->m_buffers_tail & pimpl->m_buffers_mask];
+	buf->addr = reinterpret_cast<uint64_t>(a_data);
+	buf->len = static_cast<uint32_t>(a_size);
+	buf->bid = a_id;
+	++pimpl->m_buffers_tail;
+	io_uring_buf_ring* ring = reinterpret_cast<io_uring_buf_ring*>(pimpl->m_buffers);
+	__atomic_store_n(&ring->tail, pimpl->m_buffers_tail, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::wait(int a_timeout_ms)
+{
+	wait_us(a_timeout_ms < 0 ? -1 : a_timeout_ms * 1000LL);
+}
+
+//------------------------------------------------------------------------------
+//
+void IoUring::wait_us(int64_t a_timeout_us)
+{
+	// publish queued operations
+	__atomic_store_n(pimpl->m_sq_tail, pimpl->m_sqe_tail, __ATOMIC_RELEASE);
+	const unsigned to_submit = pimpl->m_sqe_tail - __atomic_load_n(pimpl->m_sq_head, __ATOMIC_ACQUIRE);
+
+	// completions left? just submit
+	if (*pimpl->m_cq_head != __atomic_load_n(pimpl->m_cq_tail, __ATOMIC_ACQUIRE)) {
+		if (to_submit > 0) {
+			pimpl->enter(to_submit, 0, 0);
+		}
+		return;
+	}
+
+	if (a_timeout_us < 0) {
+		pimpl->enter(to_submit, 1, IORING_ENTER_GETEVENTS);
+	} else {
+		__kernel_timespec ts {};
+		ts.tv_sec = a_timeout_us / 1000000;
+		ts.tv_nsec = (a_timeout_us % 1000000) * 1000;
+		io_uring_getevents_arg arg {};
+		arg.ts = reinterpret_cast<uint64_t>(&ts);
+		pimpl->enter(to_submit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+			&arg, sizeof(arg));
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+bool IoUring::next(Completion& o_completion)
+{
+	const unsigned head = *pimpl->m_cq_head;
+	if (head == __atomic_load_n(pimpl->m_cq_tail, __ATOMIC_ACQUIRE)) {
+		return false;
+	}
+	const io_uring_cqe& cqe = pimpl->m_cqes[head & pimpl->m_cq_mask];
+	o_completion.user_data = cqe.user_data;
+	o_completion.result = cqe.res;
+	o_completion.flags = cqe.flags;
+	__atomic_store_n(pimpl->m_cq_head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//
+bool IoUring::Completion::has_more() const
+{
+	return (flags & IORING_CQE_F_MORE) != 0;
+}
+
+//------------------------------------------------------------------------------
+//
+bool IoUring::Completion::has_buffer() const
+{
+	return (flags & IORING_CQE_F_BUFFER) != 0;
+}
+
+#else // REMO_IO_URING
+
+//------------------------------------------------------------------------------
+// stubs for systems without io_uring
+//------------------------------------------------------------------------------
+//
+struct IoUring::impl {};
+
+IoUring::IoUring(unsigned a_entries):
+	pimpl(nullptr)
+{
+	(void)a_entries;
+	REMO_THROW(ErrorCode::ERR_IO_URING_FAILED, "io_uring not available on this system");
+}
+
+IoUring::~IoUring() {}
+
+bool IoUring::is_supported() { return false; }
+
+void IoUring::accept_multishot(int, uint64_t) {}
+void IoUring::recv_multishot(int, uint64_t) {}
+void IoUring::poll_multishot(int, uint64_t) {}
+void IoUring::poll_send(int, uint64_t) {}
+void IoUring::cancel(uint64_t, uint64_t) {}
+void IoUring::setup_buffers(uint16_t) {}
+void IoUring::provide_buffer(uint16_t, void*, size_t) {}
+void IoUring::wait(int) {}
+void IoUring::wait_us(int64_t) {}
+bool IoUring::next(Completion&) { return false; }
+bool IoUring::Completion::has_more() const { return false; }
+bool IoUring::Completion::has_buffer() const { return false; }
+
+#endif // REMO_IO_URING
+
+//------------------------------------------------------------------------------
+} // end namespace sys
+} // end namespace remo
+//------------------------------------------------------------------------------
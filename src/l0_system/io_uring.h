@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+namespace remo {
+namespace sys {
+//------------------------------------------------------------------------------	
+
+/**
+ * Minimal io_uring instance, driven by raw system calls
+ *
+ * Operations are queued in the submission ring, and all of them are submitted
+ * by the next wait(), together with waiting for completions. Multishot ones
+ * complete repeatedly, until they fail, run out of buffers or are cancelled,
+ * which is indicated by a completion without has_more().
+ *
+ * Receive operations pick their buffer from a ring of buffers provided in
+ * advance, and tell its id in the completion. Only one such ring is supported.
+ *
+ * Available on Linux 6.0 or later only, see is_supported().
+ */
+class IoUring
+{
+public:
+	//! a completed operation
+	struct Completion {
+		uint64_t user_data;
+		//! result of the operation, negative errno on failure
+		int32_t result;
+		uint32_t flags;
+
+		//! false if this is the last completion of a multishot operation
+		bool has_more() const;
+		//! true if a provided buffer was consumed
+		bool has_buffer() const;
+		uint16_t get_buffer_id() const { return static_cast<uint16_t>(flags >> 16); }
+	};
+
+public:
+	//! create a ring with room for the given number of queued operations
+	explicit IoUring(unsigned a_entries);
+	~IoUring();
+
+	IoUring(const IoUring&) = delete;
+	IoUring& operator=(const IoUring&) = delete;
+
+	//! true if the system provides everything needed, i.e. multishot receive
+	//! and provided buffer rings
+	static bool is_supported();
+
+	//! accept connections on a listening socket. the result is the new descriptor
+	void accept_multishot(int a_fd, uint64_t a_user_data);
+	//! receive into provided buffers. the result is the number of bytes, 0 on shutdown
+	void recv_multishot(int a_fd, uint64_t a_user_data);
+	//! get notified when the descriptor is ready to receive
+	void poll_multishot(int a_fd, uint64_t a_user_data);
+	//! get notified once when the descriptor is ready to send
+	void poll_send(int a_fd, uint64_t a_user_data);
+	//! cancel the operation with the given user data
+	void cancel(uint64_t a_target, uint64_t a_user_data);
+
+	//! register the ring of buffers to receive into, with the given number of entries
+	//! (a power of two). it is empty first
+	void setup_buffers(uint16_t a_entries);
+	//! hand the given buffer to the kernel, to be reported with the given id
+	void provide_buffer(uint16_t a_id, void* a_data, size_t a_size);
+
+	//! submit queued operations and wait for at least one completion, or until
+	//! the timeout expired
+	void wait(int a_timeout_ms);
+	//! like wait, with a timeout in microseconds
+	void wait_us(int64_t a_timeout_us);
+	//! take the next completion. false if there is none left
+	bool next(Completion& o_completion);
+
+private:
+	struct impl;
+	impl* pimpl;
+};
+
+//------------------------------------------------------------------------------
+} // end namespace sys
+} // end namespace remo
+//------------------------------------------------------------------------------
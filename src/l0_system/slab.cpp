@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#include "slab.h"
+
+#include "system.h"
+#include "error.h"
+#include "utils/logger.h"
+
+#if REMO_SYSTEM & REMO_SYS_WINDOWS
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <unistd.h>
+	#include <errno.h>
+#endif
+
+
+//------------------------------------------------------------------------------
+namespace remo {
+namespace sys {
+//------------------------------------------------------------------------------	
+
+//! logger instance
+static Logger logger("Slab");
+
+//! size of huge pages tried. 2 MB is the common one on x86 and ARM
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+//------------------------------------------------------------------------------	
+//
+static size_t round_up(size_t a_size, size_t a_alignment)
+{
+	return (a_size + a_alignment - 1) / a_alignment * a_alignment;
+}
+
+//------------------------------------------------------------------------------	
+//
+Slab::Slab(size_t a_size, bool a_huge_pages):
+	m_data(nullptr),
+	m_size(0),
+	m_huge_pages(false)
+{
+#if REMO_SYSTEM & REMO_SYS_WINDOWS
+	// large pages need a privilege that is rarely granted, so use normal ones
+	(void)a_huge_pages;
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	m_size = round_up(a_size, info.dwPageSize);
+	m_data = static_cast<uint8_t*>(VirtualAlloc(nullptr, m_size, 
+		MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+	REMO_THROW_IF(m_data == nullptr, ErrorCode::ERR_SLAB_ALLOC_FAILED,
+		"VirtualAlloc of %zu bytes failed: error %lu", m_size, GetLastError());
+	const size_t page_size = info.dwPageSize;
+#else
+	void* data = MAP_FAILED;
+	#ifdef MAP_HUGETLB
+	// explicit huge pages, if the system has some reserved
+	if (a_huge_pages) {
+		m_size = round_up(a_size, HUGE_PAGE_SIZE);
+		data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, 
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		m_huge_pages = data != MAP_FAILED;
+	}
+	#endif
+	// normal pages otherwise
+	if (data == MAP_FAILED) {
+		const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		m_size = round_up(a_size, page_size);
+		data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, 
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		REMO_THROW_IF(data == MAP_FAILED, ErrorCode::ERR_SLAB_ALLOC_FAILED,
+			"mmap of %zu bytes failed: errno %d", m_size, errno);
+		#ifdef MADV_HUGEPAGE
+		// let the kernel back it with transparent huge pages where it can
+		if (a_huge_pages) {
+			madvise(data, m_size, MADV_HUGEPAGE);
+		}
+		#endif
+	}
+	m_data = static_cast<uint8_t*>(data);
+	const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+
+	// fault in all pages now rather than on first use
+	for (size_t offset = 0; offset < m_size; offset += page_size) {
+		m_data[offset] = 0;
+	}
+
+	REMO_INFO("mapped %zu bytes%s", m_size, m_huge_pages ? " in huge pages" : "");
+}
+
+//------------------------------------------------------------------------------	
+//
+Slab::~Slab()
+{
+#if REMO_SYSTEM & REMO_SYS_WINDOWS
+	VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+	munmap(m_data, m_size);
+#endif
+}
+
+//------------------------------------------------------------------------------
+} // end namespace sys
+} // end namespace remo
+//------------------------------------------------------------------------------
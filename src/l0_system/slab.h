@@ -0,0 +1,51 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+namespace remo {
+namespace sys {
+//------------------------------------------------------------------------------	
+
+/**
+ * Contiguous memory mapped from the system at once
+ *
+ * Huge pages are tried first if requested, falling back to normal pages.
+ * The memory is faulted in up front, so that touching it later neither
+ * page faults nor costs more than the few TLB entries needed for it.
+ */
+class Slab
+{
+public:
+	//! map the given number of bytes, rounded up to whole pages
+	Slab(size_t a_size, bool a_huge_pages);
+	~Slab();
+
+	Slab(const Slab&) = delete;
+	Slab& operator=(const Slab&) = delete;
+
+	uint8_t* get_data() const { return m_data; }
+	size_t get_size() const { return m_size; }
+	//! true if explicitly mapped to huge pages. transparent ones are not known
+	bool has_huge_pages() const { return m_huge_pages; }
+
+private:
+	uint8_t* m_data;
+	size_t m_size;
+	bool m_huge_pages;
+};
+
+//------------------------------------------------------------------------------
+} // end namespace sys
+} // end namespace remo
+//------------------------------------------------------------------------------
@@ -17,6 +17,9 @@
 #include <sstream>
 #include <vector>
 
+#include <errno.h>
+#include <stddef.h> // offsetof
+#include <stdio.h> // remove
 #include <string.h>
 
 
@@ -38,13 +41,34 @@
 	// UNIX / Linux
 	#include <sys/types.h>
 	#include <sys/socket.h>
+	#include <sys/uio.h> // iovec
 	#include <sys/poll.h>
 	#include <netinet/in.h>
+	#include <sys/un.h> // sockaddr_un
+	#include <sys/stat.h> // stat
+	#include <netinet/tcp.h> // TCP_NODELAY
 	#include <netdb.h> // getaddrinfo
 	#include <unistd.h> // close
 	#include <errno.h>
 	#include <fcntl.h>
 #endif
+#if (REMO_SYSTEM & REMO_SYS_LINUX) == REMO_SYS_LINUX
+	#include <sys/eventfd.h>
+#endif
+
+//! epoll support, on by default under Linux. define as 0 to build with poll only
+#ifndef REMO_SOCKET_EPOLL
+	#define REMO_SOCKET_EPOLL ((REMO_SYSTEM & REMO_SYS_LINUX) == REMO_SYS_LINUX)
+#endif
+#if REMO_SOCKET_EPOLL
+	#include <sys/epoll.h>
+	//! epoll_pwait2 for timeouts below a millisecond, since glibc 2.35
+	#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35))
+		#define REMO_SOCKET_EPOLL_PWAIT2 1
+	#else
+		#define REMO_SOCKET_EPOLL_PWAIT2 0
+	#endif
+#endif
 
 //------------------------------------------------------------------------------	
 // macros
@@ -68,6 +92,8 @@ static Logger logger("Socket");
 
 //! constant indicating an invalid socket descriptor
 static const int INVALID_SOCKFD = -1;
+//! prefix of Unix socket addresses
+static const std::string UNIX_SCHEME = "unix://";
 
 //------------------------------------------------------------------------------
 // static variables
@@ -95,7 +121,11 @@ static struct WinsockGuard {
 //
 static int get_last_error();
 static std::string get_error_message(int err);
+static int get_timeout_ms(int64_t a_timeout_us);
 static const char* get_sdflag_str(Socket::ShutdownFlag sdf);
+static void remove_socket_file(const std::string& a_path);
+static void remove_stale_socket_file(const std::string& a_path, 
+	const sockaddr* a_addr, socklen_t a_addrlen);
 
 
 //------------------------------------------------------------------------------
@@ -106,8 +136,11 @@ static const char* get_sdflag_str(Socket::ShutdownFlag sdf);
 Socket::Socket():
 	m_sockfd(INVALID_SOCKFD),
 	m_receive_ready(),
+	m_send_ready(),
 	m_disconnected_handler(),
-	m_log_name()
+	m_log_name(),
+	m_notify_receive(true),
+	m_notify_send(false)
 {
 }
 
@@ -117,8 +150,11 @@ Socket::Socket():
 Socket::Socket(Socket&& a_other):
 	m_sockfd(a_other.m_sockfd),
 	m_receive_ready(std::move(a_other.m_receive_ready)),
+	m_send_ready(std::move(a_other.m_send_ready)),
 	m_disconnected_handler(std::move(a_other.m_disconnected_handler)),
-	m_log_name(std::move(a_other.m_log_name))
+	m_log_name(std::move(a_other.m_log_name)),
+	m_notify_receive(a_other.m_notify_receive),
+	m_notify_send(a_other.m_notify_send)
 {
 	// ensure descriptor is not closed twice
 	a_other.m_sockfd = INVALID_SOCKFD;
@@ -133,8 +169,11 @@ Socket& Socket::operator=(Socket&& a_other)
 
 	m_sockfd = a_other.m_sockfd;
 	m_receive_ready = std::move(a_other.m_receive_ready);
+	m_send_ready = std::move(a_other.m_send_ready);
 	m_disconnected_handler = std::move(a_other.m_disconnected_handler);
 	m_log_name = std::move(a_other.m_log_name);
+	m_notify_receive = a_other.m_notify_receive;
+	m_notify_send = a_other.m_notify_send;
 	
 	// ensure descriptor is not closed twice
 	a_other.m_sockfd = INVALID_SOCKFD;
@@ -195,6 +234,10 @@ void Socket::open(SockProto a_proto, AddrFamily a_family)
 		af = AF_INET6;
 		af_str = "IPv6";
 		break;
+	case AddrFamily::Unix:
+		af = AF_UNIX;
+		af_str = "Unix";
+		break;
 	default:
 		REMO_THROW(ErrorCode::ERR_SOCKET_UNSUPPORTED_FAMILY, 
 			"Unsupported socket family: %d", a_family);
@@ -215,6 +258,11 @@ void Socket::open(SockProto a_proto, AddrFamily a_family)
 		REMO_THROW(ErrorCode::ERR_SOCKET_UNSUPPORTED_PROTOCOL, 
 			"Unsupported socket protocol: %d", a_proto);		
 	}
+	if (a_family == AddrFamily::Unix) {
+		// just the socket type, there are no IP protocols
+		proto = 0;
+		proto_str = type == SOCK_STREAM ? "stream" : "datagram";
+	}
 
 	// ensure closed first
 	close();
@@ -346,6 +394,13 @@ Socket Socket::accept()
 	return socket;
 }
 
+//------------------------------------------------------------------------------
+//
+Socket Socket::adopt(int a_sockfd)
+{
+	return Socket(a_sockfd);
+}
+
 //------------------------------------------------------------------------------
 //
 Socket::IOResult Socket::send(const void* a_buffer, size_t a_bufsize, size_t* o_bytes_sent)
@@ -397,6 +452,57 @@ Socket::IOResult Socket::send(const void* a_buffer, size_t a_bufsize, size_t* o_
 	return IOResult::Success;
 }
 
+//------------------------------------------------------------------------------	
+//
+Socket::IOResult Socket::send(const IOVec* a_buffers, size_t a_count, size_t* o_bytes_sent)
+{
+	*o_bytes_sent = 0;
+
+	// further buffers are left to subsequent calls
+	if (a_count > MAX_IOVECS) {
+		a_count = MAX_IOVECS;
+	}
+
+#if REMO_SYSTEM & REMO_SYS_WINDOWS
+	WSABUF buffers[MAX_IOVECS];
+	for (size_t i = 0; i < a_count; i++) {
+		buffers[i].buf = (CHAR*)a_buffers[i].data;
+		buffers[i].len = (ULONG)a_buffers[i].size;
+	}
+	DWORD bytes_sent = 0;
+	int ret = ::WSASend(m_sockfd, buffers, (DWORD)a_count, &bytes_sent, 0, nullptr, nullptr);
+#else
+	struct iovec buffers[MAX_IOVECS];
+	for (size_t i = 0; i < a_count; i++) {
+		buffers[i].iov_base = const_cast<void*>(a_buffers[i].data);
+		buffers[i].iov_len = a_buffers[i].size;
+	}
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = buffers;
+	msg.msg_iovlen = a_count;
+	// ignore SIGPIPE signal, as for a single buffer
+	ssize_t ret = ::sendmsg(m_sockfd, &msg, MSG_NOSIGNAL);
+	size_t bytes_sent = ret < 0 ? 0 : (size_t)ret;
+#endif
+	if REMO_UNLIKELY(ret < 0) {
+		int err = get_last_error();
+		if (err == OS_ERROR(EWOULDBLOCK)) {
+			REMO_VERB("socket send would block");
+			return IOResult::WouldBlock;
+		} else {
+			REMO_THROW(ErrorCode::ERR_SOCKET_SEND_FAILED, 
+				"Sending to '%s' failed with error %d: %s", 
+				get_remote_addr().to_string().c_str(), 
+				err, get_error_message(err).c_str());		
+		}
+	}
+	*o_bytes_sent = (size_t)bytes_sent;
+
+	REMO_VERB("socket sent %zu bytes from %zu buffers", *o_bytes_sent, a_count);
+	return IOResult::Success;
+}
+
 //------------------------------------------------------------------------------
 //
 Socket::IOResult Socket::recv(void* a_buffer, size_t a_bufsize, size_t* o_bytes_received)
@@ -528,6 +634,79 @@ void Socket::set_reuse_addr(bool a_reuse_addr)
 		a_reuse_addr ? "set" : "cleared");
 }
 
+//------------------------------------------------------------------------------
+//
+void Socket::set_reuse_port(bool a_reuse_port)
+{
+#ifdef SO_REUSEPORT
+	const int enable = a_reuse_port ? 1 : 0;
+	int ret = ::setsockopt(m_sockfd, 
+		SOL_SOCKET, SO_REUSEPORT, (const char*)&enable, sizeof(enable));
+	if REMO_UNLIKELY(ret < 0) {
+		int err = get_last_error();
+		REMO_THROW(ErrorCode::ERR_SOCKET_SYSCALL_FAILED, 
+			"Syscall setsockopt(SO_REUSEPORT) failed with error %d: %s", 
+			err, get_error_message(err).c_str());		
+	}
+
+	REMO_INFO("socket option SO_REUSEPORT %s",
+		a_reuse_port ? "set" : "cleared");
+#else
+	(void)a_reuse_port;
+	REMO_THROW(ErrorCode::ERR_SOCKET_SYSCALL_FAILED, 
+		"Socket option SO_REUSEPORT not supported on this system");
+#endif
+}
+
+//------------------------------------------------------------------------------
+//
+bool Socket::has_reuse_port()
+{
+#ifdef SO_REUSEPORT
+	return true;
+#else
+	return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+//
+void Socket::remove_file(const SockAddr& a_addr)
+{
+	const std::string path = a_addr.get_path();
+	if (!path.empty()) {
+		remove_socket_file(path);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+void Socket::remove_stale_file(const SockAddr& a_addr)
+{
+	const std::string path = a_addr.get_path();
+	if (!path.empty()) {
+		remove_stale_socket_file(path, (const sockaddr*)&a_addr.m_addr, a_addr.m_addrlen);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+void Socket::set_nodelay(bool a_nodelay)
+{
+	const int enable = a_nodelay ? 1 : 0;
+	int ret = ::setsockopt(m_sockfd, 
+		IPPROTO_TCP, TCP_NODELAY, (const char*)&enable, sizeof(enable));
+	if REMO_UNLIKELY(ret < 0) {
+		int err = get_last_error();
+		REMO_THROW(ErrorCode::ERR_SOCKET_SYSCALL_FAILED, 
+			"Syscall setsockopt(TCP_NODELAY) failed with error %d: %s", 
+			err, get_error_message(err).c_str());		
+	}
+
+	REMO_INFO("socket option TCP_NODELAY %s",
+		a_nodelay ? "set" : "cleared");
+}
+
 //------------------------------------------------------------------------------
 //
 SockAddr Socket::get_socket_addr() const
@@ -587,6 +766,25 @@ void Socket::receive_ready()
 	}
 }
 
+//------------------------------------------------------------------------------
+//
+void Socket::on_send_ready(const ready_handler& a_handler)
+{
+	m_send_ready = a_handler;
+}
+
+//------------------------------------------------------------------------------
+//
+void Socket::send_ready()
+{
+	REMO_VERB("socket ready to send");
+
+	// invoke callback
+	if (m_send_ready) {
+		m_send_ready();
+	}
+}
+
 //------------------------------------------------------------------------------
 //
 void Socket::on_disconnected(const ready_handler& a_handler)
@@ -607,26 +805,154 @@ void Socket::disconnected()
 }
 
 
+//------------------------------------------------------------------------------
+// class implementation
+//------------------------------------------------------------------------------
+//
+EventSocket::EventSocket():
+	Socket()
+#if (REMO_SYSTEM & REMO_SYS_LINUX) != REMO_SYS_LINUX
+	, m_sender()
+#endif
+{
+#if (REMO_SYSTEM & REMO_SYS_LINUX) == REMO_SYS_LINUX
+	// a counter that is ready to be read while not zero
+	int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if REMO_UNLIKELY(fd < 0) {
+		int err = get_last_error();
+		REMO_THROW(ErrorCode::ERR_SOCKET_OPEN_FAILED, 
+			"Opening eventfd failed with error %d: %s", 
+			err, get_error_message(err).c_str());
+	}
+	set_sockfd(fd);
+	REMO_INFO("socket #%d opened (eventfd)", fd);
+#else
+	// "pseudo-queue" of datagrams sent to ourselves
+	open(SockProto::UDP, AddrFamily::Unspec);
+	set_blocking(false);
+	bind(SockAddr::localhost);
+	m_sender = Socket(SockProto::UDP);
+	m_sender.set_blocking(false);
+	m_sender.bind(SockAddr::localhost);
+	m_sender.connect(get_socket_addr());
+	connect(m_sender.get_socket_addr());
+#endif
+}
+
+//------------------------------------------------------------------------------
+//
+void EventSocket::signal()
+{
+#if (REMO_SYSTEM & REMO_SYS_LINUX) == REMO_SYS_LINUX
+	// fails only if the counter would overflow, when it is ready anyway
+	const uint64_t one = 1;
+	if REMO_UNLIKELY(::write(get_fd(), &one, sizeof(one)) < 0 && errno != EAGAIN) {
+		int err = get_last_error();
+		REMO_THROW(ErrorCode::ERR_SOCKET_SEND_FAILED, 
+			"Signalling eventfd failed with error %d: %s", 
+			err, get_error_message(err).c_str());
+	}
+#else
+	// would block only if plenty of datagrams are waiting already
+	const char one = 1;
+	m_sender.send(&one, sizeof(one));
+#endif
+}
+
+//------------------------------------------------------------------------------
+//
+void EventSocket::reset()
+{
+#if (REMO_SYSTEM & REMO_SYS_LINUX) == REMO_SYS_LINUX
+	// reading sets the counter to zero, fails if it is already
+	uint64_t count = 0;
+	if REMO_UNLIKELY(::read(get_fd(), &count, sizeof(count)) < 0 && errno != EAGAIN) {
+		int err = get_last_error();
+		REMO_THROW(ErrorCode::ERR_SOCKET_RECV_FAILED, 
+			"Resetting eventfd failed with error %d: %s", 
+			err, get_error_message(err).c_str());
+	}
+#else
+	char buffer[64];
+	size_t received = 0;
+	while (recv(buffer, sizeof(buffer), &received) == IOResult::Success) {
+	}
+#endif
+}
+
+
 //------------------------------------------------------------------------------
 // class implementation
 //------------------------------------------------------------------------------
 //
 struct SocketSet::impl {
+	Backend m_backend;
+	//! poll backend: sockets and their descriptors, at the same index
 	std::vector<Socket*> m_sockets;
 	std::vector<pollfd> m_pollfds;
+#if REMO_SOCKET_EPOLL
+	//! epoll backend: instance descriptor, the socket is stored in each event
+	int m_epfd = -1;
+	size_t m_count = 0;
+	//! events of the current poll, and index of the next one to dispatch
+	std::vector<epoll_event> m_events;
+	size_t m_num_events = 0;
+	size_t m_next_event = 0;
+	//! false if the kernel turned out not to support epoll_pwait2
+	bool m_pwait2 = true;
+#endif
+
+	size_t poll_poll(int64_t a_timeout_us);
+	void update_events(Socket* a_socket);
+#if REMO_SOCKET_EPOLL
+	size_t poll_epoll(int64_t a_timeout_us);
+#endif
 };
 
+#if REMO_SOCKET_EPOLL
+//! maximum number of events handled per wakeup, further ones are reported by the next poll
+static const size_t MAX_EPOLL_EVENTS = 256;
+#endif
+
 //------------------------------------------------------------------------------
 //
-SocketSet::SocketSet():
+SocketSet::SocketSet(Backend a_backend):
 	pimpl(new impl)
 {
+#if REMO_SOCKET_EPOLL
+	if (a_backend == Backend::Default) {
+		a_backend = Backend::Epoll;
+	}
+#else
+	// not available, use portable fallback
+	a_backend = Backend::Poll;
+#endif
+	pimpl->m_backend = a_backend;
+
+#if REMO_SOCKET_EPOLL
+	if (a_backend == Backend::Epoll) {
+		pimpl->m_epfd = ::epoll_create1(EPOLL_CLOEXEC);
+		if REMO_UNLIKELY(pimpl->m_epfd < 0) {
+			int err = get_last_error();
+			delete pimpl;
+			REMO_THROW(ErrorCode::ERR_SOCKET_SYSCALL_FAILED, 
+				"Syscall epoll_create1() failed with error %d: %s", 
+				err, get_error_message(err).c_str());
+		}
+		pimpl->m_events.resize(MAX_EPOLL_EVENTS);
+	}
+#endif
 }
 
 //------------------------------------------------------------------------------
 //
 SocketSet::~SocketSet()
 {
+#if REMO_SOCKET_EPOLL
+	if (pimpl->m_epfd >= 0) {
+		::close(pimpl->m_epfd);
+	}
+#endif
 	delete pimpl;
 }
 
@@ -635,6 +961,7 @@ SocketSet::~SocketSet()
 void SocketSet::add(Socket* a_socket)
 {
 	const size_t n = count();
+	(void)n; // only used by assertions
 
 	REMO_PRECOND({
 		REMO_ASSERT(a_socket, 
@@ -645,6 +972,28 @@ void SocketSet::add(Socket* a_socket)
 			"size must increase by one");
 	});
 
+	a_socket->m_notify_receive = true;
+	a_socket->m_notify_send = false;
+
+#if REMO_SOCKET_EPOLL
+	if (pimpl->m_backend == Backend::Epoll) {
+		// level-triggered, like poll
+		epoll_event ev {};
+		ev.events = EPOLLIN;
+		ev.data.ptr = a_socket;
+		if REMO_UNLIKELY(::epoll_ctl(pimpl->m_epfd, EPOLL_CTL_ADD, a_socket->get_fd(), &ev) < 0) {
+			int err = get_last_error();
+			REMO_THROW(ErrorCode::ERR_SOCKET_SYSCALL_FAILED, 
+				"Syscall epoll_ctl() failed with error %d: %s", 
+				err, get_error_message(err).c_str());
+		}
+		++pimpl->m_count;
+		REMO_INFO("added socket %s to set (count: %d)", 
+			a_socket->get_log_name().c_str(), count());
+		return;
+	}
+#endif
+
 	pollfd pfd {};
 	pfd.fd = a_socket->get_fd();
 	pfd.events = POLLIN;
@@ -671,6 +1020,32 @@ void SocketSet::remove(Socket* a_socket)
 			"size must decrease by one");
 	});
 
+#if REMO_SOCKET_EPOLL
+	if (pimpl->m_backend == Backend::Epoll) {
+		// a closed descriptor has already left the set by itself
+		epoll_event ev {}; // non-null for kernels before 2.6.9
+		if REMO_UNLIKELY(::epoll_ctl(pimpl->m_epfd, EPOLL_CTL_DEL, a_socket->get_fd(), &ev) < 0) {
+			int err = get_last_error();
+			if (err != EBADF) {
+				REMO_THROW(ErrorCode::ERR_SOCKET_SYSCALL_FAILED, 
+					"Syscall epoll_ctl() failed with error %d: %s", 
+					err, get_error_message(err).c_str());
+			}
+		}
+		--pimpl->m_count;
+		// the socket may be removed by a callback during poll,
+		// so forget any of its events not yet dispatched
+		for (size_t i = pimpl->m_next_event; i < pimpl->m_num_events; i++) {
+			if (pimpl->m_events[i].data.ptr == a_socket) {
+				pimpl->m_events[i].data.ptr = nullptr;
+			}
+		}
+		REMO_INFO("removed socket %s from set (count: %d)", 
+			a_socket->get_log_name().c_str(), count());
+		return;
+	}
+#endif
+
 	for (size_t i = 0; i < n; i++) {
 		if (pimpl->m_sockets[i] == a_socket) {
 			pimpl->m_sockets.erase(pimpl->m_sockets.begin() + i);
@@ -682,14 +1057,107 @@ void SocketSet::remove(Socket* a_socket)
 	}
 }
 
+//------------------------------------------------------------------------------
+//
+void SocketSet::notify_send_ready(Socket* a_socket, bool a_enable)
+{
+	REMO_PRECOND({
+		REMO_ASSERT(a_socket, 
+			"socket must not be null");
+	});
+
+	a_socket->m_notify_send = a_enable;
+	pimpl->update_events(a_socket);
+}
+
+//------------------------------------------------------------------------------
+//
+void SocketSet::notify_receive_ready(Socket* a_socket, bool a_enable)
+{
+	REMO_PRECOND({
+		REMO_ASSERT(a_socket, 
+			"socket must not be null");
+	});
+
+	a_socket->m_notify_receive = a_enable;
+	pimpl->update_events(a_socket);
+}
+
+//------------------------------------------------------------------------------
+//
+void SocketSet::impl::update_events(Socket* a_socket)
+{
+#if REMO_SOCKET_EPOLL
+	if (m_backend == Backend::Epoll) {
+		epoll_event ev {};
+		if (a_socket->m_notify_receive) {
+			ev.events |= EPOLLIN;
+		}
+		if (a_socket->m_notify_send) {
+			ev.events |= EPOLLOUT;
+		}
+		ev.data.ptr = a_socket;
+		if REMO_UNLIKELY(::epoll_ctl(m_epfd, EPOLL_CTL_MOD, a_socket->get_fd(), &ev) < 0) {
+			int err = get_last_error();
+			REMO_THROW(ErrorCode::ERR_SOCKET_SYSCALL_FAILED, 
+				"Syscall epoll_ctl() failed with error %d: %s", 
+				err, get_error_message(err).c_str());
+		}
+		return;
+	}
+#endif
+
+	for (size_t i = 0; i < m_sockets.size(); i++) {
+		if (m_sockets[i] == a_socket) {
+			m_pollfds[i].events = (a_socket->m_notify_receive ? POLLIN : 0) | 
+				(a_socket->m_notify_send ? POLLOUT : 0);
+			return;
+		}
+	}
+	REMO_THROW(ErrorCode::ERR_ITEM_NOT_FOUND, 
+		"Socket %s not in set", a_socket->get_log_name().c_str());
+}
+
 //------------------------------------------------------------------------------
 //
 size_t SocketSet::poll(int a_timeout_ms)
+{
+	return poll_us(a_timeout_ms < 0 ? WAIT_FOREVER : a_timeout_ms * 1000LL);
+}
+
+//------------------------------------------------------------------------------
+//
+size_t SocketSet::poll_us(int64_t a_timeout_us)
+{
+#if REMO_SOCKET_EPOLL
+	if (pimpl->m_backend == Backend::Epoll) {
+		return pimpl->poll_epoll(a_timeout_us);
+	}
+#endif
+	return pimpl->poll_poll(a_timeout_us);
+}
+
+//------------------------------------------------------------------------------
+//
+size_t SocketSet::impl::poll_poll(int64_t a_timeout_us)
 {
 	// wait for events
-	const size_t n = count();
-	int ret = ::poll(&pimpl->m_pollfds[0], (nfds_t)n, a_timeout_ms);
-	REMO_ASSERT(n == count(),
+	const size_t n = m_sockets.size();
+#if (REMO_SYSTEM & REMO_SYS_LINUX) == REMO_SYS_LINUX
+	int ret = 0;
+	if (a_timeout_us > 0 && a_timeout_us % 1000 != 0) {
+		// not a whole number of milliseconds
+		timespec ts {};
+		ts.tv_sec = a_timeout_us / 1000000;
+		ts.tv_nsec = (a_timeout_us % 1000000) * 1000;
+		ret = ::ppoll(&m_pollfds[0], (nfds_t)n, &ts, nullptr);
+	} else {
+		ret = ::poll(&m_pollfds[0], (nfds_t)n, get_timeout_ms(a_timeout_us));
+	}
+#else
+	int ret = ::poll(&m_pollfds[0], (nfds_t)n, get_timeout_ms(a_timeout_us));
+#endif
+	REMO_ASSERT(n == m_sockets.size(),
 		"set size must not change during poll");
 	if REMO_UNLIKELY(ret < 0) {
 		int err = get_last_error();
@@ -698,19 +1166,21 @@ size_t SocketSet::poll(int a_timeout_ms)
 			err, get_error_message(err).c_str());		
 	}
 
-	REMO_ASSERT(pimpl->m_pollfds.size() == n,
-		"incosistent array size");
-	REMO_ASSERT(pimpl->m_sockets.size() == n,
+	REMO_ASSERT(m_pollfds.size() == n,
 		"incosistent array size");
 
 	// check for events
 	// iterate downwards, to allow callbacks removing the socket
 	size_t num_receive_ready = 0;
 	for (size_t i = n; i --> 0 ;) {
-		REMO_ASSERT((int)pimpl->m_pollfds[i].fd == pimpl->m_sockets[i]->get_fd(),
+		REMO_ASSERT((int)m_pollfds[i].fd == m_sockets[i]->get_fd(),
 			"inconsistent socket descriptors");
-		auto revents = pimpl->m_pollfds[i].revents;
-		Socket* socket = pimpl->m_sockets[i];	
+		auto revents = m_pollfds[i].revents;
+		Socket* socket = m_sockets[i];	
+		if (revents & POLLOUT) {
+			// before receiving, which may remove the socket
+			socket->send_ready();
+		}
 		if (revents & POLLIN) {
 			socket->receive_ready();
 			++num_receive_ready;
@@ -722,13 +1192,82 @@ size_t SocketSet::poll(int a_timeout_ms)
 	return num_receive_ready;
 }
 
+#if REMO_SOCKET_EPOLL
+//------------------------------------------------------------------------------
+//
+size_t SocketSet::impl::poll_epoll(int64_t a_timeout_us)
+{
+	// wait for events
+	int ret = -1;
+	bool waited = false;
+#if REMO_SOCKET_EPOLL_PWAIT2
+	if (m_pwait2 && a_timeout_us > 0 && a_timeout_us % 1000 != 0) {
+		// not a whole number of milliseconds
+		timespec ts {};
+		ts.tv_sec = a_timeout_us / 1000000;
+		ts.tv_nsec = (a_timeout_us % 1000000) * 1000;
+		ret = ::epoll_pwait2(m_epfd, &m_events[0], (int)m_events.size(), &ts, nullptr);
+		waited = ret >= 0 || errno != ENOSYS;
+		// kernel before 5.11 otherwise, round up instead
+		m_pwait2 = waited;
+	}
+#endif
+	if (!waited) {
+		ret = ::epoll_wait(m_epfd, &m_events[0], (int)m_events.size(), get_timeout_ms(a_timeout_us));
+	}
+	if REMO_UNLIKELY(ret < 0) {
+		int err = get_last_error();
+		REMO_THROW(ErrorCode::ERR_SOCKET_POLL_FAILED, 
+			"Polling sockets failed with error %d: %s", 
+			err, get_error_message(err).c_str());		
+	}
+
+	// dispatch events straight to their sockets
+	size_t num_receive_ready = 0;
+	m_num_events = (size_t)ret;
+	for (m_next_event = 0; m_next_event < m_num_events; ) {
+		const epoll_event& ev = m_events[m_next_event++];
+		Socket* socket = (Socket*)ev.data.ptr;
+		if (!socket) {
+			// removed by a previous callback
+			continue;
+		}
+		if (ev.events & EPOLLOUT) {
+			// before receiving, which may remove the socket
+			socket->send_ready();
+		}
+		if (ev.events & EPOLLIN) {
+			socket->receive_ready();
+			++num_receive_ready;
+		} else if (ev.events & EPOLLHUP) {
+			socket->disconnected();
+		}
+	}
+	m_num_events = m_next_event = 0;
+
+	return num_receive_ready;
+}
+#endif
+
 //------------------------------------------------------------------------------
 //
 size_t SocketSet::count() const
 {
+#if REMO_SOCKET_EPOLL
+	if (pimpl->m_backend == Backend::Epoll) {
+		return pimpl->m_count;
+	}
+#endif
 	return pimpl->m_sockets.size();
 }
 
+//------------------------------------------------------------------------------
+//
+SocketSet::Backend SocketSet::get_backend() const
+{
+	return pimpl->m_backend;
+}
+
 
 //------------------------------------------------------------------------------
 // class implementation
@@ -761,6 +1300,12 @@ SockAddr::SockAddr(const std::string& a_str):
 //
 void SockAddr::from_string(const std::string& a_str)
 {
+	// not a host?
+	if (a_str.compare(0, UNIX_SCHEME.size(), UNIX_SCHEME) == 0) {
+		from_unix_string(a_str.substr(UNIX_SCHEME.size()));
+		return;
+	}
+
 	struct addrinfo hints = {};
 	hints.ai_family = AF_UNSPEC;    /* Allow IPv4 or IPv6 */
 	hints.ai_socktype = SOCK_DGRAM; /* Datagram socket */
@@ -826,6 +1371,23 @@ void SockAddr::from_string(const std::string& a_str)
 //
 std::string SockAddr::to_string() const
 {
+	// not a host?
+	if (get_family() == AddrFamily::Unix) {
+		const std::string path = get_path();
+		if (!path.empty()) {
+			return UNIX_SCHEME + path;
+		}
+#if !(REMO_SYSTEM & REMO_SYS_WINDOWS)
+		// abstract name, or empty for an unnamed socket, e.g. of a connecting peer
+		const size_t offset = offsetof(sockaddr_un, sun_path);
+		const char* name = ((const sockaddr_un*)m_addr)->sun_path;
+		if (m_addrlen > offset + 1) {
+			return UNIX_SCHEME + "@" + std::string(name + 1, m_addrlen - offset - 1);
+		}
+#endif
+		return UNIX_SCHEME;
+	}
+
 	char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
 
 	int err = ::getnameinfo(
@@ -862,6 +1424,7 @@ AddrFamily SockAddr::get_family() const
 		case AF_UNSPEC: return AddrFamily::Unspec;
 		case AF_INET  : return AddrFamily::IPv4;
 		case AF_INET6 : return AddrFamily::IPv6;
+		case AF_UNIX  : return AddrFamily::Unix;
 		default       : return AddrFamily::Invalid;
 	}
 }
@@ -881,6 +1444,52 @@ uint16_t SockAddr::get_port() const
 }
 
 
+//------------------------------------------------------------------------------	
+//
+std::string SockAddr::get_path() const
+{
+#if !(REMO_SYSTEM & REMO_SYS_WINDOWS)
+	// abstract names start with a null byte instead
+	const size_t offset = offsetof(sockaddr_un, sun_path);
+	const char* path = ((const sockaddr_un*)m_addr)->sun_path;
+	if (get_family() == AddrFamily::Unix && m_addrlen > offset && path[0] != '\0') {
+		return std::string(path, strnlen(path, m_addrlen - offset));
+	}
+#endif
+	return std::string();
+}
+
+//------------------------------------------------------------------------------	
+//
+void SockAddr::from_unix_string(const std::string& a_str)
+{
+#if REMO_SYSTEM & REMO_SYS_WINDOWS
+	REMO_THROW(ErrorCode::ERR_SOCKET_UNSUPPORTED_FAMILY, 
+		"Unix socket addresses are not supported: '%s'", a_str.c_str());
+#else
+	sockaddr_un* addr = (sockaddr_un*)m_addr;
+	REMO_THROW_IF(a_str.empty() || a_str == "@",
+		ErrorCode::ERR_SOCKET_INVALID_ADDRESS,
+		"Unix socket address without a path or name");
+	REMO_THROW_IF(a_str.size() >= sizeof(addr->sun_path),
+		ErrorCode::ERR_SOCKET_INVALID_ADDRESS,
+		"Unix socket address too long: Expected at most %zu characters, got %zu",
+		sizeof(addr->sun_path) - 1, a_str.size());
+
+	memset(m_addr, 0, sizeof(m_addr));
+	addr->sun_family = AF_UNIX;
+	memcpy(addr->sun_path, a_str.data(), a_str.size());
+	if (a_str[0] == '@') {
+		// abstract name: leading null byte, the length tells where it ends
+		addr->sun_path[0] = '\0';
+		m_addrlen = (socklen_t)(offsetof(sockaddr_un, sun_path) + a_str.size());
+	} else {
+		// path: null-terminated
+		m_addrlen = (socklen_t)(offsetof(sockaddr_un, sun_path) + a_str.size() + 1);
+	}
+#endif
+}
+
 //------------------------------------------------------------------------------
 // helper functions
 //------------------------------------------------------------------------------
@@ -928,6 +1537,14 @@ static std::string get_error_message(int err)
 	return msg;
 }
 
+//------------------------------------------------------------------------------
+//
+static int get_timeout_ms(int64_t a_timeout_us)
+{
+	// rounded up, so as not to wake too early
+	return a_timeout_us < 0 ? WAIT_FOREVER : (int)((a_timeout_us + 999) / 1000);
+}
+
 //------------------------------------------------------------------------------
 //
 static const char* get_sdflag_str(Socket::ShutdownFlag sdf)
@@ -940,6 +1557,55 @@ static const char* get_sdflag_str(Socket::ShutdownFlag sdf)
 	}
 }
 
+//------------------------------------------------------------------------------
+//
+static void remove_socket_file(const std::string& a_path)
+{
+	if (::remove(a_path.c_str()) == 0) {
+		REMO_INFO("removed socket file '%s'", a_path.c_str());
+	} else if (errno != ENOENT) {
+		int err = errno;
+		REMO_WARN("removing socket file '%s' failed with error %d: %s",
+			a_path.c_str(), err, strerror(err));
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+static void remove_stale_socket_file(const std::string& a_path, 
+	const sockaddr* a_addr, socklen_t a_addrlen)
+{
+#if !(REMO_SYSTEM & REMO_SYS_WINDOWS)
+	struct stat st;
+	if (::lstat(a_path.c_str(), &st) != 0) {
+		// nothing there
+		return;
+	}
+
+	// a socket file is stale if connections to it are refused, as nobody listens
+	// anymore. without waiting, as a busy listener counts as one still alive
+	bool stale = false;
+	if (S_ISSOCK(st.st_mode)) {
+		int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd >= 0) {
+			::fcntl(fd, F_SETFL, O_NONBLOCK);
+			stale = ::connect(fd, a_addr, a_addrlen) != 0 && errno == ECONNREFUSED;
+			::close(fd);
+		}
+	}
+	REMO_THROW_IF(!stale, ErrorCode::ERR_SOCKET_BIND_FAILED, 
+		"Binding socket to '%s' failed: address in use", 
+		a_path.c_str());
+
+	remove_socket_file(a_path);
+#else
+	// binding fails if the file exists
+	(void)a_path;
+	(void)a_addr;
+	(void)a_addrlen;
+#endif
+}
+
 //------------------------------------------------------------------------------
 	} // end namespace sys
 } // end namespace remo
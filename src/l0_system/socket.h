@@ -27,12 +27,13 @@ enum class AddrFamily {
 	Unspec,
 	IPv4,
 	IPv6,
+	Unix,
 	Invalid
 };
 
 enum class SockProto {
 	UDP,
-	TCP
+	TCP               // or a stream socket of the Unix family
 };
 
 //------------------------------------------------------------------------------
@@ -73,6 +74,15 @@ public:
 		PeerShutdown      // peer has performed an orderly shutdown
 	};
 
+	//! one of several buffers to be sent at once
+	struct IOVec {
+		const void* data;
+		size_t size;
+	};
+
+	//! maximum number of buffers sent by a single call, further ones are left to the caller
+	static const size_t MAX_IOVECS = 64;
+
 public:
 	Socket();
 	Socket(SockProto a_proto, AddrFamily a_family = AddrFamily::Unspec);
@@ -83,8 +93,11 @@ public:
 	void bind(const SockAddr& a_addr);
 	void listen(int a_backlog = -1);
 	Socket accept();
+	//! take ownership of a connection accepted by other means, e.g. asynchronously
+	static Socket adopt(int a_sockfd);
 
 	IOResult send(const void* a_buffer, size_t a_bufsize, size_t* o_bytes_sent = nullptr);
+	IOResult send(const IOVec* a_buffers, size_t a_count, size_t* o_bytes_sent);
 	IOResult recv(void* a_buffer, size_t a_bufsize, size_t* o_bytes_received = nullptr);
 
 	void shutdown(ShutdownFlag how = ShutdownFlag::ShutRdWr);
@@ -96,8 +109,24 @@ public:
 	void set_blocking(bool a_blocking);
 	//! allow/disallow reusing the same address
 	void set_reuse_addr(bool a_reuse_addr);
+	//! enable/disable sending small segments without delay (disable Nagle's algorithm)
+	void set_nodelay(bool a_nodelay);
+	//! allow/disallow several sockets to listen on the same port, with the
+	//! system balancing incoming connections among them
+	void set_reuse_port(bool a_reuse_port);
+	//! true if the system supports set_reuse_port
+	static bool has_reuse_port();
+	//! remove the file a Unix socket was bound to, which outlives the socket.
+	//! does nothing for other addresses, and if there is no such file
+	static void remove_file(const SockAddr& a_addr);
+	//! remove the file left behind at the given Unix socket address by a socket
+	//! no longer listening, so that it can be bound again. throws if another
+	//! socket still listens there, or the file is not a socket. does nothing for
+	//! other addresses, and if there is no such file
+	static void remove_stale_file(const SockAddr& a_addr);
 
 	void on_receive_ready(const ready_handler& a_handler);
+	void on_send_ready(const ready_handler& a_handler);
 	void on_disconnected(const ready_handler& a_handler);
 
 	SockAddr get_socket_addr() const;
@@ -125,6 +154,7 @@ protected:
 
 	//! event handlers
 	virtual void receive_ready();
+	virtual void send_ready();
 	virtual void disconnected();
 
 private:
@@ -134,9 +164,41 @@ private:
 	friend SocketSet;
 	//! ready event callbacks
 	ready_handler m_receive_ready;
+	ready_handler m_send_ready;
 	ready_handler m_disconnected_handler;
 	//! socket name used for logging
 	std::string m_log_name;
+	//! readiness a socket set reports for this socket, see SocketSet::notify_*
+	bool m_notify_receive;
+	bool m_notify_send;
+};
+
+//------------------------------------------------------------------------------
+// class definition
+//------------------------------------------------------------------------------
+//
+/**
+ * Descriptor that other threads signal to wake up the thread polling it.
+ *
+ * It is added to a SocketSet like any socket and becomes ready to receive when
+ * signalled, until reset. Signals in between are merged into one. This is an
+ * eventfd under Linux, and a pair of connected UDP sockets elsewhere.
+ */
+class EventSocket: public Socket
+{
+public:
+	EventSocket();
+
+	//! make ready to receive. may be called by any thread
+	void signal();
+	//! make not ready to receive anymore, consuming all signals so far
+	void reset();
+
+private:
+#if (REMO_SYSTEM & REMO_SYS_LINUX) != REMO_SYS_LINUX
+	//! end the signals are sent from
+	Socket m_sender;
+#endif
 };
 
 //------------------------------------------------------------------------------
@@ -146,16 +208,34 @@ private:
 class SocketSet
 {
 public:
-	SocketSet();
+	//! system facility used to wait for ready sockets
+	enum class Backend {
+		Default,          // epoll where available, poll otherwise
+		Poll,             // poll(), portable, O(n) per wakeup
+		Epoll             // epoll, Linux only, O(1) add/remove and O(ready) per wakeup
+	};
+
+public:
+	SocketSet(Backend a_backend = Backend::Default);
 	~SocketSet();
 
 	void add(Socket* a_socket);
 	void remove(Socket* a_socket);
+	//! also report when the given socket is ready to send, until disabled again
+	void notify_send_ready(Socket* a_socket, bool a_enable);
+	//! stop/resume reporting when the given socket is ready to receive, e.g. while
+	//! there is nothing to receive into
+	void notify_receive_ready(Socket* a_socket, bool a_enable);
 
 	size_t poll(int a_timeout_ms = WAIT_FOREVER);
+	//! like poll, with a timeout in microseconds, e.g. for short delays
+	size_t poll_us(int64_t a_timeout_us);
 
 	size_t count() const;
 
+	//! backend actually in use, never Default
+	Backend get_backend() const;
+
 private:
 	struct impl;
 	impl* pimpl;
@@ -171,16 +251,24 @@ public:
 	SockAddr();
 	SockAddr(const std::string& a_str);
 
+	//! "host", "host:port", "[host]:port", or a Unix socket address of the form
+	//! "unix:///path/to/file", or "unix://@name" in the abstract namespace (Linux only)
 	void from_string(const std::string& a_str);
 	std::string to_string() const;
 
 	AddrFamily get_family() const;
 	uint16_t get_port() const;
+	//! file of a Unix socket address, empty for other addresses and abstract names
+	std::string get_path() const;
 
 public:
 	// some well-known addresses
 	static const SockAddr localhost;
 
+private:
+	//! parses the part of a Unix socket address following the scheme
+	void from_unix_string(const std::string& a_str);
+
 private:
 	friend Socket;
 	// opaque type corresponding to native sockaddr_storage
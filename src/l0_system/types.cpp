@@ -24,7 +24,7 @@ static Logger logger("TypedValue");
 //
 void TypedValue::check_type(TypeId a_expected) const
 {
-	REMO_THROW_IF(a_expected != m_type, 
+	REMO_THROW_IF(!is_convertible_type(m_type, a_expected), 
 		ErrorCode::ERR_BAD_VALUE_ACCESS, 
 		"bad typed value access: expected '%s', got '%s'",
 		get_type_name(a_expected), get_type_name(m_type));
@@ -37,7 +37,23 @@ void TypedValue::check_type(TypeId a_expected) const
 //
 bool is_ptr_type(TypeId id)
 {
-	return (id & modifier_ptr) == modifier_ptr;
+	return (id & modifier_mask) == modifier_ptr;
+}
+
+//------------------------------------------------------------------------------
+//
+bool is_cptr_type(TypeId id)
+{
+	return (id & modifier_mask) == modifier_cptr;
+}
+
+//------------------------------------------------------------------------------
+//
+bool is_convertible_type(TypeId a_from, TypeId a_to)
+{
+	// exact match, or pointer to const pointer of same type
+	return a_from == a_to
+		|| (is_ptr_type(a_from) && a_to == ((a_from & ~modifier_mask) | modifier_cptr));
 }
 
 //------------------------------------------------------------------------------
@@ -77,6 +93,21 @@ const char* get_type_name(TypeId id)
 		case type_double_ptr : return "double*";
 		case type_error_ptr  : return "error*";
 		case type_float_ptr  : return "float*";
+	// const pointer types
+		case type_uint8_cptr : return "const uint8_t*";
+		case type_uint16_cptr: return "const uint16_t*";
+		case type_uint32_cptr: return "const uint32_t*";
+		case type_uint64_cptr: return "const uint64_t*";
+		case type_int8_cptr  : return "const int8_t*";
+		case type_int16_cptr : return "const int16_t*";
+		case type_int32_cptr : return "const int32_t*";
+		case type_int64_cptr : return "const int64_t*";
+		case type_bool_cptr  : return "const bool*";
+		case type_double_cptr: return "const double*";
+		case type_float_cptr : return "const float*";
+		case type_any_cptr   : return "const any*";
+	// others
+		case type_arraysize  : return "arraysize_t";
 	// unknown
 		default              : return "(unknown)";
 	}
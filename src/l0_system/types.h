@@ -11,19 +11,36 @@
 
 #include "../l0_system/error.h"
 #include "../l0_system/system.h" // TODO to have it everywhere?
+#include "../utils/small_vector.h"
 
 #include <stdint.h>
 #include <stddef.h> // size_t
+#include <cstring> // memcpy
 
 #include <vector>
+#include <string>
+#include <type_traits>
 
+//! std::string_view is supported when compiling as C++17 or later
+#if __cplusplus >= 201703L
+#define REMO_HAS_STRING_VIEW 1
+#include <string_view>
+#endif
 
 //------------------------------------------------------------------------------
 namespace remo {
 //------------------------------------------------------------------------------	
 
 enum TypeModifier {
-	modifier_ptr = 0xA0
+	modifier_delta     = 0x90, // delta-encoded const array, lower nibble holds the item type
+	modifier_ptr       = 0xA0, // mutable pointer, i.e. in/out parameter
+	modifier_arraysize = 0xB0, // array size, lower nibble holds the wire size
+	modifier_cptr      = 0xC0, // const pointer, i.e. in parameter only
+	// compact floating point encodings, lower nibble holds the wire size
+	modifier_double_reversed = 0xD0, // double, bytes reversed
+	modifier_float_reversed  = 0xE0, // float, bytes reversed
+	modifier_double_as_float = 0xF0, // double exactly representable as float, bytes reversed
+	modifier_mask      = 0xF0
 };
 
 enum TypeId: uint8_t {
@@ -61,6 +78,22 @@ enum TypeId: uint8_t {
 	type_error_ptr      = type_error   | modifier_ptr,	
 	type_float_ptr      = type_float   | modifier_ptr,
 
+// const pointer types
+	type_uint8_cptr     = type_uint8   | modifier_cptr,
+	type_uint16_cptr    = type_uint16  | modifier_cptr,
+	type_uint32_cptr    = type_uint32  | modifier_cptr,
+	type_uint64_cptr    = type_uint64  | modifier_cptr,
+	type_int8_cptr      = type_int8    | modifier_cptr,
+	type_int16_cptr     = type_int16   | modifier_cptr,
+	type_int32_cptr     = type_int32   | modifier_cptr,
+	type_int64_cptr     = type_int64   | modifier_cptr,
+	type_bool_cptr      = type_bool    | modifier_cptr,
+	type_double_cptr    = type_double  | modifier_cptr,
+	type_float_cptr     = type_float   | modifier_cptr,
+	type_any_cptr       = type_any     | modifier_cptr,
+
+// array size preceding a pointer type
+	type_arraysize      = modifier_arraysize,
 };
 
 typedef std::vector<TypeId> TypeList;
@@ -68,6 +101,8 @@ typedef std::vector<TypeId> TypeList;
 const char* get_type_name(TypeId id);
 size_t get_type_size(TypeId id);
 bool is_ptr_type(TypeId id);
+bool is_cptr_type(TypeId id);
+bool is_convertible_type(TypeId a_from, TypeId a_to);
 
 template <typename T>
 struct dependent_false { static constexpr bool value = false; };
@@ -204,11 +239,85 @@ struct TypeInfo<float*> {
 	static TypeId id() { return type_float_ptr; }
 };
 
+// const pointer types
+
+template<>
+struct TypeInfo<const uint8_t*> {
+	static TypeId id() { return type_uint8_cptr; }
+};
+
+template<>
+struct TypeInfo<const uint16_t*> {
+	static TypeId id() { return type_uint16_cptr; }
+};
+
+template<>
+struct TypeInfo<const uint32_t*> {
+	static TypeId id() { return type_uint32_cptr; }
+};
+
+template<>
+struct TypeInfo<const uint64_t*> {
+	static TypeId id() { return type_uint64_cptr; }
+};
+
+template<>
+struct TypeInfo<const int8_t*> {
+	static TypeId id() { return type_int8_cptr; }
+};
+
+template<>
+struct TypeInfo<const int16_t*> {
+	static TypeId id() { return type_int16_cptr; }
+};
+
+template<>
+struct TypeInfo<const int32_t*> {
+	static TypeId id() { return type_int32_cptr; }
+};
+
+template<>
+struct TypeInfo<const int64_t*> {
+	static TypeId id() { return type_int64_cptr; }
+};
+
+template<>
+struct TypeInfo<const bool*> {
+	static TypeId id() { return type_bool_cptr; }
+};
+
+template<>
+struct TypeInfo<const double*> {
+	static TypeId id() { return type_double_cptr; }
+};
+
+template<>
+struct TypeInfo<const float*> {
+	static TypeId id() { return type_float_cptr; }
+};
+
+template<>
+struct TypeInfo<arraysize_t> {
+	static TypeId id() { return type_arraysize; }
+};
+
 template<>
 struct TypeInfo<const char*> {
 	static TypeId id() { return type_cstr; }
 };
 
+template<>
+struct TypeInfo<std::string> {
+	static TypeId id() { return type_cstr; }
+};
+
+#if REMO_HAS_STRING_VIEW
+template<>
+struct TypeInfo<std::string_view> {
+	static TypeId id() { return type_cstr; }
+};
+#endif
+
 
 
 // TODO better place
@@ -222,6 +331,44 @@ struct TypeInfo<const char*> {
 // NOTE: the "0," avoids the "ISO C++ forbids zero-size array" pendantic warning
 #define REMO_FOREACH_ARG(args, what) { int dummy[] = { 0,(what(args),0)... }; (void)dummy; }
 
+//------------------------------------------------------------------------------
+// struct definition
+//------------------------------------------------------------------------------
+//
+//! compile-time sequence of indices, like std::index_sequence in C++14
+template<size_t... Is>
+struct index_sequence {};
+
+//! generates index_sequence<0, 1, ..., N-1>
+template<size_t N, size_t... Is>
+struct make_index_sequence: make_index_sequence<N-1, N-1, Is...> {};
+
+template<size_t... Is>
+struct make_index_sequence<0, Is...>: index_sequence<Is...> {};
+
+//------------------------------------------------------------------------------
+// struct definition
+//------------------------------------------------------------------------------
+//
+//! description of a user-defined struct. specialized by REMO_STRUCT and REMO_FIXED_STRUCT
+template<typename T>
+struct StructInfo {
+	static const bool is_struct = false;
+};
+
+//! true if T is a registered struct
+template<typename T>
+struct is_struct: std::integral_constant<bool, 
+	StructInfo<typename std::remove_cv<T>::type>::is_struct> {};
+
+//! decoded struct received through a pointer. converts to the pointer
+//! expected by the function, and is written back if the pointer is mutable
+template<typename T>
+struct struct_ref {
+	typename std::remove_const<T>::type value;
+	operator T*() { return &value; }
+};
+
 //------------------------------------------------------------------------------
 // struct definition
 //------------------------------------------------------------------------------
@@ -238,13 +385,30 @@ struct TypedValue
 		m_type = TypeInfo<T>::id();
 		static_assert(sizeof(T) <= sizeof(m_value), 
 			"type too large for TypedValue");
-		reinterpret_cast<T&>(m_value) = value;
+		std::memcpy(&m_value, static_cast<const void*>(&value), sizeof(T));
 	}
 
 	template<typename T>
 	T get() const {
 		check_type(TypeInfo<T>::id());
-		return reinterpret_cast<const T&>(m_value);
+		T value;
+		std::memcpy(static_cast<void*>(&value), &m_value, sizeof(T));
+		return value;
+	}
+
+	//! struct value, referring to its encoding in a packet. see REMO_STRUCT
+	static TypedValue any(const uint8_t* a_encoded) {
+		TypedValue value(TypeId::type_any);
+		std::memcpy(&value.m_value, &a_encoded, sizeof(a_encoded));
+		return value;
+	}
+
+	//! encoding of a struct value, or nullptr if none
+	const uint8_t* get_any() const {
+		check_type(TypeId::type_any);
+		const uint8_t* encoded;
+		std::memcpy(&encoded, &m_value, sizeof(encoded));
+		return encoded;
 	}
 
 	TypeId type() const {
@@ -266,7 +430,27 @@ private:
 	uint64_t m_value;
 };
 
-typedef std::vector<TypedValue> ArgList;
+//! number of arguments that an ArgList holds without heap allocation
+#ifndef REMO_ARGLIST_INLINE_SIZE
+#define REMO_ARGLIST_INLINE_SIZE       8
+#endif
+
+typedef utils::SmallVector<TypedValue, REMO_ARGLIST_INLINE_SIZE> ArgList;
+
+//! strings are held as pointer to their NUL-terminated characters
+template<>
+inline std::string TypedValue::get<std::string>() const
+{
+	return std::string(get<const char*>());
+}
+
+#if REMO_HAS_STRING_VIEW
+template<>
+inline std::string_view TypedValue::get<std::string_view>() const
+{
+	return std::string_view(get<const char*>());
+}
+#endif
 
 
 //------------------------------------------------------------------------------
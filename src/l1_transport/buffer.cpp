@@ -21,6 +21,8 @@
 // C++
 #include <sstream>
 #include <iomanip>
+#include <algorithm> // min
+#include <cstring> // memcpy
 //
 //
 //------------------------------------------------------------------------------
@@ -53,6 +55,9 @@ void Buffer::init(uint8_t* a_data, size_t a_capacity, size_t a_size)
 {
 	m_data = a_data;
 	m_capacity = a_capacity;
+	m_next = nullptr;
+	m_tail = this;
+	m_chained_size = 0;
 	set_size(a_size);
 }
 
@@ -93,6 +98,100 @@ void* Buffer::access_write(size_t a_offset, size_t a_size)
 	return m_data + a_offset;
 }
 
+//------------------------------------------------------------------------------	
+//
+uint8_t* Buffer::access_tail(size_t a_offset) const
+{
+	return a_offset >= m_chained_size ? m_tail->m_data + (a_offset - m_chained_size) : nullptr;
+}
+
+//------------------------------------------------------------------------------	
+//
+void Buffer::copy_out(size_t a_offset, void* a_dest, size_t a_size) const
+{
+	REMO_PRECOND({
+		REMO_ASSERT(a_offset + a_size <= get_total_size(), 
+			"range to copy must not exceed buffer size");
+	});
+
+	uint8_t* dest = static_cast<uint8_t*>(a_dest);
+	for (const Buffer* segment = this; a_size > 0; segment = segment->m_next) {
+		// skip segments before the range
+		if (a_offset >= segment->m_size) {
+			a_offset -= segment->m_size;
+			continue;
+		}
+		const size_t size = std::min(a_size, segment->m_size - a_offset);
+		std::memcpy(dest, segment->m_data + a_offset, size);
+		dest += size;
+		a_size -= size;
+		a_offset = 0;
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+void Buffer::copy_to(size_t a_offset, RBuffer& a_dest) const
+{
+	REMO_PRECOND({
+		REMO_ASSERT(a_offset <= get_total_size(), 
+			"offset to copy from must not exceed buffer size");
+	});
+
+	for (const Buffer* segment = this; segment; segment = segment->m_next) {
+		// skip segments before the offset
+		if (a_offset >= segment->m_size) {
+			a_offset -= segment->m_size;
+			continue;
+		}
+		a_dest.append(segment->m_data + a_offset, segment->m_size - a_offset);
+		a_offset = 0;
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+void Buffer::truncate(size_t a_size)
+{
+	REMO_PRECOND({
+		REMO_ASSERT(a_size <= get_total_size(), 
+			"buffer cannot be truncated to a larger size");
+	});
+
+	// find segment where the buffer ends now
+	Buffer* segment = this;
+	m_chained_size = 0;
+	while (a_size > segment->m_size) {
+		a_size -= segment->m_size;
+		m_chained_size += segment->m_size;
+		segment = segment->m_next;
+	}
+	segment->set_size(a_size);
+	m_tail = segment;
+
+	// empty the remaining ones
+	for (segment = segment->m_next; segment; segment = segment->m_next) {
+		segment->set_size(0);
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+void Buffer::drop_front(size_t a_size)
+{
+	REMO_PRECOND({
+		REMO_ASSERT(a_size <= m_size, 
+			"size to drop must not exceed segment size");
+	});
+
+	m_data += a_size;
+	m_capacity -= a_size;
+	m_size -= a_size;
+	if (m_tail != this) {
+		m_chained_size -= a_size;
+	}
+}
+
 //------------------------------------------------------------------------------	
 //
 std::string Buffer::to_hex() const
@@ -109,32 +208,55 @@ std::string Buffer::to_hex() const
 
 //------------------------------------------------------------------------------	
 //
-void* RBuffer::grow(size_t a_size)
+void* RBuffer::grow_segment(size_t a_size)
 {
-	// check if full
-	REMO_THROW_IF(m_size + a_size > m_capacity, 
+	// continue in a further segment, leaving the rest of this one unused.
+	// values are kept contiguous, large ones need to be append()ed
+	Buffer* tail = extend();
+	REMO_THROW_IF(a_size > tail->m_capacity, 
 		ErrorCode::ERR_PACKET_FULL, 
-		"Packet payload is full (%zu bytes)", 
-		m_capacity);
-	
-	size_t offset = m_size;
-	set_size(m_size + a_size);
-	return access_write(offset, a_size);
+		"Packet segment is full (%zu bytes)", 
+		tail->m_capacity);
+	return try_grow(a_size);
 }
 
 //------------------------------------------------------------------------------	
 //
-void* LBuffer::grow(size_t a_size)
+void RBuffer::append(const void* a_data, size_t a_size)
 {
-	// check if full
-	REMO_THROW_IF(m_size + a_size > m_capacity, 
-		ErrorCode::ERR_PACKET_FULL, 
-		"Packet header is full (%zu bytes)", 
-		m_capacity);
+	// fill the last segment, then continue in further ones
+	const uint8_t* data = static_cast<const uint8_t*>(a_data);
+	while (a_size > 0) {
+		Buffer* tail = m_tail;
+		const size_t size = std::min(a_size, tail->m_capacity - tail->m_size);
+		if (size == 0) {
+			extend();
+			continue;
+		}
+		std::memcpy(tail->m_data + tail->m_size, data, size);
+		tail->m_size += size;
+		data += size;
+		a_size -= size;
+	}
+}
 
-	set_size(m_size + a_size);
-	m_data -= a_size;
-	return access_write(0, a_size);
+//------------------------------------------------------------------------------	
+//
+Buffer* RBuffer::extend()
+{
+	// reuse a segment left by truncate(), or get a new one
+	Buffer* next = m_tail->m_next;
+	if (!next) {
+		next = new_segment();
+		REMO_THROW_IF(!next, 
+			ErrorCode::ERR_PACKET_FULL, 
+			"Packet payload is full (%zu bytes)", 
+			get_total_size());
+		m_tail->m_next = next;
+	}
+	m_chained_size += m_tail->m_size;
+	m_tail = next;
+	return next;
 }
 
 //------------------------------------------------------------------------------
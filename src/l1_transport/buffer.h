@@ -14,9 +14,11 @@
 //------------------------------------------------------------------------------
 //
 // project
+#include "l0_system/error.h"
 //
 // C++ 
 #include <stddef.h>
+#include <stdint.h>
 #include <string>
 //
 //
@@ -29,6 +31,14 @@ namespace remo {
 // class definition
 //------------------------------------------------------------------------------
 //
+/**
+ * Contiguous range of bytes, possibly continued in further segments
+ *
+ * The direction in which a buffer grows is given by its type, i.e. RBuffer
+ * or LBuffer, rather than by virtual functions. Writers know the type at
+ * compile time, so that growing a buffer is inlined, and only running out
+ * of room takes a function call.
+ */
 class Buffer {
 // ctor/dtor
 public:
@@ -38,7 +48,6 @@ public:
 // public member functions
 public:
 	void init(uint8_t* a_data, size_t a_capacity, size_t a_size = 0);
-	virtual void* grow(size_t a_size) = 0;	
 
 	const void* access_read(size_t a_offset, size_t a_size) const;
 	void* access_write(size_t a_offset, size_t a_size);
@@ -47,15 +56,40 @@ public:
 	size_t get_size() const { return m_size; }
 	size_t get_capacity() const { return m_capacity; }
 
+	//! set size of this segment
 	void set_size(size_t a_size);
 
+	//! segment following this one, if the contents continue in another buffer
+	Buffer* get_next() const { return m_next; }
+	//! last segment, this one if there are no others
+	Buffer* get_tail() const { return m_tail; }
+	//! size of all segments
+	size_t get_total_size() const { return m_chained_size + m_tail->m_size; }
+	//! pointer to the given offset within all segments, if it is in the last one
+	uint8_t* access_tail(size_t a_offset) const;
+	//! copy the given range of all segments
+	void copy_out(size_t a_offset, void* a_dest, size_t a_size) const;
+	//! append all segments from the given offset on to another buffer
+	void copy_to(size_t a_offset, class RBuffer& a_dest) const;
+	//! shrink all segments to the given total size. segments beyond are kept for reuse
+	void truncate(size_t a_size);
+	//! remove bytes from the front of this segment, e.g. a header already processed
+	void drop_front(size_t a_size);
+
 	std::string to_hex() const;	
 
 // protected members
 protected:
+	friend class RBuffer;
 	uint8_t* m_data;
 	size_t m_size;
 	size_t m_capacity;
+	//! next segment, if any
+	Buffer* m_next;
+	//! last segment, where the buffer grows
+	Buffer* m_tail;
+	//! size of all segments except the last one
+	size_t m_chained_size;
 };
 
 
@@ -63,11 +97,53 @@ protected:
 // subclass definition
 //------------------------------------------------------------------------------
 //
-//! right-growing buffer
+//! right-growing buffer, which may continue in further segments
 class RBuffer: public Buffer {
-// protected member functions
+// public member functions
 public:
-	virtual void* grow(size_t a_size) override;
+	//! append the given number of bytes and return a pointer to them. they are
+	//! kept contiguous, continuing in a further segment if needed
+	void* grow(size_t a_size)
+	{
+		void* ptr = try_grow(a_size);
+		return ptr ? ptr : grow_segment(a_size);
+	}
+
+	//! like grow(), but returns nullptr instead of continuing in another segment
+	void* try_grow(size_t a_size)
+	{
+		// room left in the last segment?
+		Buffer* tail = m_tail;
+		if (a_size > tail->m_capacity - tail->m_size) {
+			// no
+			return nullptr;
+		}
+		uint8_t* ptr = tail->m_data + tail->m_size;
+		tail->m_size += a_size;
+		return ptr;
+	}
+
+	//! give back bytes grown but not written, at the end of the last segment
+	void shrink(size_t a_size)
+	{
+		m_tail->m_size -= a_size;
+	}
+
+	//! append bytes that need not be contiguous, such as large arrays
+	void append(const void* a_data, size_t a_size);
+
+	//! continue in a further segment, and return it
+	Buffer* extend();
+
+// protected member functions
+protected:
+	//! provide a further segment to continue in, or nullptr if the buffer
+	//! cannot grow beyond its capacity. to be overridden by subclasses
+	virtual RBuffer* new_segment() { return nullptr; }
+
+// private member functions
+private:
+	void* grow_segment(size_t a_size);
 };
 
 
@@ -77,9 +153,29 @@ public:
 //
 //! left-growing buffer
 class LBuffer: public Buffer {
-// protected member functions
+// public member functions
 public:
-	virtual void* grow(size_t a_size) override;
+	//! prepend the given number of bytes and return a pointer to them
+	void* grow(size_t a_size)
+	{
+		// check if full
+		if (a_size > m_capacity - m_size) {
+			REMO_THROW_NOLOG(ErrorCode::ERR_PACKET_FULL, 
+				"Packet header is full (%zu bytes)", 
+				m_capacity);
+		}
+
+		m_size += a_size;
+		m_data -= a_size;
+		return m_data;
+	}
+
+	//! give back bytes prepended last, e.g. a header to be written again
+	void shrink(size_t a_size)
+	{
+		m_size -= a_size;
+		m_data += a_size;
+	}
 };
 
 
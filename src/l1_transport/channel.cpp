@@ -15,6 +15,7 @@
 //
 // project
 #include "transport.h"
+#include "l0_system/endianness.h"
 #include "utils/logger.h"
 #include "utils/contracts.h"
 //
@@ -76,8 +77,23 @@ void Channel::on_state_changed(const Channel::state_handler& a_handler)
 //
 void Channel::send(packet_ptr& a_packet)
 {
+	REMO_THROW_IF(!try_send(a_packet),
+		ErrorCode::ERR_SEND_QUEUE_FULL,
+		"Send queue of channel %s is full", get_log_name().c_str());
+}
+
+//------------------------------------------------------------------------------	
+//
+bool Channel::try_send(packet_ptr& a_packet)
+{
+	const size_t header_size = a_packet->get_header().get_size();
 	prepare_to_send(a_packet);
-	do_send(a_packet);
+	if (!do_send(a_packet)) {
+		// leave the packet as it was, to be sent again later
+		a_packet->get_header().shrink(a_packet->get_header().get_size() - header_size);
+		return false;
+	}
+	return true;
 }
 
 //------------------------------------------------------------------------------	
@@ -127,8 +143,8 @@ size_t Channel::determine_packet_size(const packet_ptr& a_packet)
 
 	// packet header complete?
 	if (a_packet->get_size() >= sizeof(payload_size)) {
-		// yes -> read payload size
-		payload_size = *(uint32_t*)a_packet->get_data();
+		// yes -> read payload size, little-endian and possibly unaligned
+		payload_size = sys::get_le_ua(reinterpret_cast<const uint32_t*>(a_packet->get_data()));
 		// determine actual packet size
 		size_t actual_packet_size = static_cast<size_t>(payload_size) + sizeof(payload_size);
 		// packet complete?
@@ -70,9 +70,12 @@ public:
 
 // public member functions
 public:
-	//! send a packet over this channel
-	//! may block if the send buffer is full
+	//! send a packet over this channel. does not block, but queues the packet if it
+	//! cannot be sent right away. throws ERR_SEND_QUEUE_FULL if the queue is full
 	void send(packet_ptr& a_packet);
+	//! like send, but returns false if the send queue is full. the packet is then
+	//! left to the caller, e.g. to send it again once the peer caught up
+	bool try_send(packet_ptr& a_packet);
 	
 	//! register a callback function that is invoked when a packet was received by this channel
 	void on_receive(const receive_handler& a_handler);
@@ -102,9 +105,9 @@ protected:
 	//! prepares a packet to be sent over this channel
 	//! subclasses can override this to write headers, do masking etc.
 	virtual void prepare_to_send(packet_ptr& a_packet) { (void)a_packet; };
-	//! send a packet over this channel
+	//! send a packet over this channel, or queue it. false if the queue is full
 	//! to be implemented by subclasses
-	virtual void do_send(packet_ptr& a_packet) = 0;
+	virtual bool do_send(packet_ptr& a_packet) = 0;
 
 	//! prepares a packet to be received from this channel
 	//! subclasses can override this to consume headers, do unmasking etc.
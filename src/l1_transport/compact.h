@@ -0,0 +1,214 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+#include "l0_system/bits.h"
+#include "l0_system/endianness.h"
+#include "l0_system/types.h"
+//
+// C++
+#include <stdint.h>
+#include <stddef.h>
+#include <cstring> // memcpy
+#include <cfloat> // FLT_MAX
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace trans {
+//------------------------------------------------------------------------------
+
+/**
+ * Compact value encoding
+ *
+ * Scalar values are transmitted as their significant bytes only, i.e. the
+ * little-endian representation with all leading zero bytes stripped. The number
+ * of bytes (the "wire size") goes into the upper nibble of the type info byte.
+ *
+ * The functions below operate on the raw bit pattern of a value, so that the
+ * wire size can be computed without looping over the bytes, and the bytes can
+ * be copied with a fixed number of unaligned loads/stores.
+ *
+ * Floating point values rarely have leading zero bytes, but often trailing
+ * ones, e.g. 1.0, 0.25 or 1e6. They may therefore be sent with their bytes
+ * reversed, and doubles that are exactly representable as float may be sent
+ * as such. A modifier in the upper nibble of the type info byte indicates
+ * the encoding, with the wire size in the lower nibble. The shortest
+ * encoding is chosen, preferring the plain one.
+ */
+
+//------------------------------------------------------------------------------
+// types
+//------------------------------------------------------------------------------
+//
+//! unsigned integer type with the given size, used to access bit patterns
+template<size_t Size> struct compact_bits_type;
+template<> struct compact_bits_type<1> { typedef uint8_t type; };
+template<> struct compact_bits_type<2> { typedef uint16_t type; };
+template<> struct compact_bits_type<4> { typedef uint32_t type; };
+template<> struct compact_bits_type<8> { typedef uint64_t type; };
+
+
+//------------------------------------------------------------------------------
+// function implementations
+//------------------------------------------------------------------------------
+//
+//! get the bit pattern of a value, zero-extended to 64 bits
+template<typename T>
+inline uint64_t compact_bits(const T& a_value)
+{
+	typename compact_bits_type<sizeof(T)>::type bits;
+	std::memcpy(&bits, &a_value, sizeof(bits));
+	return bits;
+}
+
+//------------------------------------------------------------------------------
+//
+//! convert a bit pattern back to a value. excess upper bits are ignored
+template<typename T>
+inline T compact_value(uint64_t a_bits)
+{
+	typename compact_bits_type<sizeof(T)>::type bits =
+		static_cast<typename compact_bits_type<sizeof(T)>::type>(a_bits);
+	T value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+//------------------------------------------------------------------------------
+//
+//! number of significant bytes in a bit pattern, between 0 and 8
+inline size_t compact_size(uint64_t a_bits)
+{
+	return a_bits ? (71 - sys::count_leading_zeros(a_bits)) >> 3 : 0;
+}
+
+//------------------------------------------------------------------------------
+//
+//! store the given number of low-order bytes of a bit pattern in little-endian order.
+//! sizes that are not a power of two are written as two overlapping stores.
+inline void compact_store(uint8_t* a_dst, uint64_t a_bits, size_t a_size)
+{
+	if (a_size >= 4) {
+		sys::set_le_ua(reinterpret_cast<uint32_t*>(a_dst),
+			static_cast<uint32_t>(a_bits));
+		sys::set_le_ua(reinterpret_cast<uint32_t*>(a_dst + a_size - 4),
+			static_cast<uint32_t>(a_bits >> ((a_size - 4) * 8)));
+	} else if (a_size >= 2) {
+		sys::set_le_ua(reinterpret_cast<uint16_t*>(a_dst),
+			static_cast<uint16_t>(a_bits));
+		sys::set_le_ua(reinterpret_cast<uint16_t*>(a_dst + a_size - 2),
+			static_cast<uint16_t>(a_bits >> ((a_size - 2) * 8)));
+	} else if (a_size == 1) {
+		*a_dst = static_cast<uint8_t>(a_bits);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+//! load the given number of little-endian bytes into the low-order bytes of a bit pattern.
+//! counterpart of compact_store()
+inline uint64_t compact_load(const uint8_t* a_src, size_t a_size)
+{
+	if (a_size >= 4) {
+		uint64_t lo = sys::get_le_ua(reinterpret_cast<const uint32_t*>(a_src));
+		uint64_t hi = sys::get_le_ua(reinterpret_cast<const uint32_t*>(a_src + a_size - 4));
+		return lo | (hi << ((a_size - 4) * 8));
+	} else if (a_size >= 2) {
+		uint64_t lo = sys::get_le_ua(reinterpret_cast<const uint16_t*>(a_src));
+		uint64_t hi = sys::get_le_ua(reinterpret_cast<const uint16_t*>(a_src + a_size - 2));
+		return lo | (hi << ((a_size - 2) * 8));
+	} else if (a_size == 1) {
+		return *a_src;
+	} else {
+		return 0;
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+//! reverse the bytes of a float or double bit pattern, so that trailing
+//! zero bytes become leading ones. the operation is its own inverse
+inline uint64_t compact_reverse(uint64_t a_bits, size_t a_value_size)
+{
+	return a_value_size == sizeof(uint64_t) ? REMO_BSWAP64(a_bits)
+		: REMO_BSWAP32(static_cast<uint32_t>(a_bits));
+}
+
+//------------------------------------------------------------------------------
+//
+//! choose the shortest encoding of a double. returns the bit pattern to be
+//! stored, along with the type info byte and the wire size
+inline uint64_t compact_encode(double a_value, uint8_t& o_header, size_t& o_wire_size)
+{
+	// plain
+	const uint64_t bits = compact_bits(a_value);
+	uint64_t result = bits;
+	o_wire_size = compact_size(bits);
+	o_header = static_cast<uint8_t>((o_wire_size << 4) | type_double);
+
+	// reversed
+	const uint64_t reversed = compact_reverse(bits, sizeof(double));
+	const size_t reversed_size = compact_size(reversed);
+	if (reversed_size < o_wire_size) {
+		result = reversed;
+		o_wire_size = reversed_size;
+		o_header = static_cast<uint8_t>(modifier_double_reversed | reversed_size);
+	}
+
+	// demoted to float. the range check excludes NaN and avoids undefined
+	// behavior on conversion
+	if (o_wire_size > 2 && a_value >= -FLT_MAX && a_value <= FLT_MAX) {
+		const float demoted = static_cast<float>(a_value);
+		if (compact_bits(static_cast<double>(demoted)) == bits) {
+			const uint64_t demoted_reversed = compact_reverse(compact_bits(demoted), sizeof(float));
+			const size_t demoted_size = compact_size(demoted_reversed);
+			if (demoted_size < o_wire_size) {
+				result = demoted_reversed;
+				o_wire_size = demoted_size;
+				o_header = static_cast<uint8_t>(modifier_double_as_float | demoted_size);
+			}
+		}
+	}
+
+	return result;
+}
+
+//------------------------------------------------------------------------------
+//
+//! choose the shortest encoding of a float. counterpart of the above
+inline uint64_t compact_encode(float a_value, uint8_t& o_header, size_t& o_wire_size)
+{
+	// plain
+	const uint64_t bits = compact_bits(a_value);
+	o_wire_size = compact_size(bits);
+	o_header = static_cast<uint8_t>((o_wire_size << 4) | type_float);
+
+	// reversed
+	const uint64_t reversed = compact_reverse(bits, sizeof(float));
+	const size_t reversed_size = compact_size(reversed);
+	if (reversed_size < o_wire_size) {
+		o_wire_size = reversed_size;
+		o_header = static_cast<uint8_t>(modifier_float_reversed | reversed_size);
+		return reversed;
+	}
+	return bits;
+}
+
+
+//------------------------------------------------------------------------------
+	} // end namespace trans
+} // end namespace remo
+//------------------------------------------------------------------------------
@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+#include "compact.h"
+#include "l0_system/types.h"
+//
+// C++
+#include <stdint.h>
+#include <stddef.h>
+#include <cstring> // memset
+#include <type_traits>
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace trans {
+//------------------------------------------------------------------------------
+
+/**
+ * Delta array encoding
+ *
+ * Integer arrays that change slowly, e.g. counters or timestamps, may be sent
+ * as the differences between subsequent items. The first item is relative to
+ * zero. Each difference is zigzag-encoded, so that small negative ones stay
+ * small, and stored with its significant bytes only, like scalar values.
+ * The byte counts go into the nibbles of control bytes in front of the data,
+ * two items per control byte, lower nibble first, similar to stream VByte:
+ *
+ *   [control bytes: (n+1)/2] [data bytes: sum of the nibbles]
+ *
+ * Differences are computed modulo the item width, so that the encoding works
+ * for signed and unsigned items alike. Decoding needs no branches per item
+ * apart from the loop, as the byte counts are read from the control bytes
+ * and the bytes themselves with a fixed number of unaligned loads.
+ */
+
+//------------------------------------------------------------------------------
+// function implementations
+//------------------------------------------------------------------------------
+//
+//! true if arrays of the given item type may be delta-encoded
+inline bool delta_supported(TypeId a_item_type)
+{
+	switch (a_item_type) {
+	case type_uint16: case type_uint32: case type_uint64:
+	case type_int16:  case type_int32:  case type_int64:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+//! zigzag-encoded difference between two items
+template<typename U>
+inline U delta_zigzag(U a_prev, U a_curr)
+{
+	const U diff = static_cast<U>(a_curr - a_prev);
+	const U sign = static_cast<U>(0 - (diff >> (sizeof(U) * 8 - 1)));
+	return static_cast<U>(static_cast<U>(diff << 1) ^ sign);
+}
+
+//------------------------------------------------------------------------------
+//
+//! item following the given one by a zigzag-encoded difference
+template<typename U>
+inline U delta_unzigzag(U a_prev, U a_zigzag)
+{
+	const U diff = static_cast<U>((a_zigzag >> 1) ^ static_cast<U>(0 - (a_zigzag & 1)));
+	return static_cast<U>(a_prev + diff);
+}
+
+//------------------------------------------------------------------------------
+//
+//! number of bytes needed to delta-encode the given items
+template<typename U>
+inline size_t delta_encoded_size(const U* a_items, size_t a_count)
+{
+	size_t size = a_count / 2 + (a_count & 1);
+	U prev = 0;
+	for (size_t i = 0; i < a_count; i++) {
+		size += compact_size(delta_zigzag(prev, a_items[i]));
+		prev = a_items[i];
+	}
+	return size;
+}
+
+//------------------------------------------------------------------------------
+//
+//! delta-encode the given items. the destination must hold delta_encoded_size() bytes
+template<typename U>
+inline void delta_encode(uint8_t* a_dst, const U* a_items, size_t a_count)
+{
+	const size_t control_size = a_count / 2 + (a_count & 1);
+	uint8_t* control = a_dst;
+	uint8_t* data = a_dst + control_size;
+	std::memset(control, 0, control_size);
+
+	U prev = 0;
+	for (size_t i = 0; i < a_count; i++) {
+		const U zigzag = delta_zigzag(prev, a_items[i]);
+		const size_t size = compact_size(zigzag);
+		control[i / 2] |= static_cast<uint8_t>(size << ((i & 1) * 4));
+		compact_store(data, zigzag, size);
+		data += size;
+		prev = a_items[i];
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+//! decode items. the control bytes must have been checked by delta_data_size(),
+//! whose result is passed as data size
+template<typename U>
+inline void delta_decode(U* a_items, const uint8_t* a_src, size_t a_count, size_t a_data_size)
+{
+	const size_t control_size = a_count / 2 + (a_count & 1);
+	const uint8_t* control = a_src;
+	const uint8_t* data = a_src + control_size;
+	const uint8_t* end = data + a_data_size;
+
+	U prev = 0;
+	size_t i = 0;
+	// as long as 8 bytes are left, load them at once and mask out the excess ones
+	for (; i < a_count && end - data >= 8; i++) {
+		const size_t size = (control[i / 2] >> ((i & 1) * 4)) & 0xF;
+		const uint64_t mask = size ? ~uint64_t(0) >> (64 - 8 * size) : 0;
+		const uint64_t bits = sys::get_le_ua(reinterpret_cast<const uint64_t*>(data)) & mask;
+		prev = delta_unzigzag(prev, static_cast<U>(bits));
+		data += size;
+		a_items[i] = prev;
+	}
+	// remaining items
+	for (; i < a_count; i++) {
+		const size_t size = (control[i / 2] >> ((i & 1) * 4)) & 0xF;
+		prev = delta_unzigzag(prev, static_cast<U>(compact_load(data, size)));
+		data += size;
+		a_items[i] = prev;
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+//! sum up the data bytes given by the control bytes. returns false if any
+//! byte count exceeds the item size, i.e. if the encoding is malformed
+inline bool delta_data_size(const uint8_t* a_control, size_t a_count, size_t a_item_size, size_t& o_size)
+{
+	size_t size = 0;
+	bool valid = true;
+	for (size_t i = 0; i < a_count; i++) {
+		const size_t item = (a_control[i / 2] >> ((i & 1) * 4)) & 0xF;
+		valid &= item <= a_item_size;
+		size += item;
+	}
+	o_size = size;
+	return valid;
+}
+
+//------------------------------------------------------------------------------
+//
+//! variants for items given by their size, which must be 2, 4 or 8 bytes
+inline size_t delta_encoded_size(const void* a_items, size_t a_count, size_t a_item_size)
+{
+	switch (a_item_size) {
+	case 2:  return delta_encoded_size(static_cast<const uint16_t*>(a_items), a_count);
+	case 4:  return delta_encoded_size(static_cast<const uint32_t*>(a_items), a_count);
+	default: return delta_encoded_size(static_cast<const uint64_t*>(a_items), a_count);
+	}
+}
+
+inline void delta_encode(uint8_t* a_dst, const void* a_items, size_t a_count, size_t a_item_size)
+{
+	switch (a_item_size) {
+	case 2:  return delta_encode(a_dst, static_cast<const uint16_t*>(a_items), a_count);
+	case 4:  return delta_encode(a_dst, static_cast<const uint32_t*>(a_items), a_count);
+	default: return delta_encode(a_dst, static_cast<const uint64_t*>(a_items), a_count);
+	}
+}
+
+inline void delta_decode(void* a_items, const uint8_t* a_src, size_t a_count, size_t a_item_size,
+	size_t a_data_size)
+{
+	switch (a_item_size) {
+	case 2:  return delta_decode(static_cast<uint16_t*>(a_items), a_src, a_count, a_data_size);
+	case 4:  return delta_decode(static_cast<uint32_t*>(a_items), a_src, a_count, a_data_size);
+	default: return delta_decode(static_cast<uint64_t*>(a_items), a_src, a_count, a_data_size);
+	}
+}
+
+//------------------------------------------------------------------------------
+	} // end namespace trans
+} // end namespace remo
+//------------------------------------------------------------------------------
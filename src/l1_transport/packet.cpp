@@ -11,10 +11,12 @@
 #include "reader.h"
 #include "utils/logger.h"
 #include "utils/contracts.h"
+#include "utils/elastic_pool.h"
 
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm> // min
 
 //------------------------------------------------------------------------------
 namespace remo {
@@ -24,31 +26,83 @@ namespace remo {
 //! logger instance
 static Logger logger("Packet");
 
+//------------------------------------------------------------------------------	
+//
+//! buffer size of packets that serve as further payload segments
+static const size_t SEGMENT_SIZE = REMO_PACKET_SIZE_MEDIUM;
+
+//------------------------------------------------------------------------------	
+//
+//! pool of packets that serve as further payload segments, shared by all packets.
+//! it is never destroyed, as segments may still be recycled during static destruction
+static ElasticPool<Packet>& get_segment_pool()
+{
+    static ElasticPool<Packet>* pool = [] {
+        // the size of messages is limited instead of the number of segments
+        PoolLimits limits;
+        limits.high_watermark = SIZE_MAX;
+        limits.wait_timeout_ms = 0;
+        return new ElasticPool<Packet>(limits, [] {
+            return new Packet(SEGMENT_SIZE);
+        });
+    }();
+    return *pool;
+}
 
 //------------------------------------------------------------------------------	
 // class Packet
 //------------------------------------------------------------------------------	
 //
-Packet::Packet():
-    m_buffer(),
+Packet::Packet(size_t a_buffer_size):
+    Packet(a_buffer_size ? std::shared_ptr<uint8_t>(new uint8_t[a_buffer_size], 
+        std::default_delete<uint8_t[]>()) : nullptr, a_buffer_size)
+{
+}
+
+//------------------------------------------------------------------------------
+
+Packet::Packet(const std::shared_ptr<uint8_t>& a_buffer, size_t a_buffer_size):
+    m_buffer(a_buffer),
+    m_buffer_size(a_buffer_size),
     m_header(),
-    m_payload()
+    m_payload(*this),
+    m_next_segment(nullptr),
+    m_last_segment(nullptr),
+    m_segment_count(0),
+    m_holders(1),
+    m_sliced(nullptr)
 {
-    set_header_capacity(REMO_MAX_PACKET_HEADER_SIZE);
+    set_header_capacity(std::min<size_t>(REMO_MAX_PACKET_HEADER_SIZE, m_buffer_size));
 }
 
 //------------------------------------------------------------------------------
 
 Packet::~Packet()
 {
+    release_segments();
 }
 
 //------------------------------------------------------------------------------
 
 void Packet::recycle()
 {
+    // still referred to by slices? 
+    if (m_holders.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+        // yes -> the last of them recycles us
+        return;
+    }
+    m_holders.store(1, std::memory_order_relaxed);
+
+    // release the packet we are a slice of, if any
+    if (m_sliced) {
+        Packet* sliced = m_sliced;
+        m_sliced = nullptr;
+        sliced->recycle();
+    }
+
     // reset state
-    set_header_capacity(REMO_MAX_PACKET_HEADER_SIZE);
+    release_segments();
+    set_header_capacity(std::min<size_t>(REMO_MAX_PACKET_HEADER_SIZE, m_buffer_size));
     // call base
     Recyclable::recycle();
 }
@@ -61,7 +115,7 @@ void Packet::set_header_capacity(size_t a_capacity)
         REMO_ASSERT(a_capacity <= get_buffer_size(),
             "header capacity must not exceed buffer size");
     });
-    uint8_t* border = &m_buffer[a_capacity];
+    uint8_t* border = m_buffer.get() + a_capacity;
     m_header.init(border, a_capacity);
     m_payload.init(border, get_buffer_size() - a_capacity);
 }
@@ -82,8 +136,87 @@ void Packet::drop_header(size_t a_size)
             "header size to drop must not exceed payload size");
     });
 
-    m_payload.init(m_payload.get_data() + a_size, m_payload.get_capacity(),
-        m_payload.get_size() - a_size);
+    m_payload.drop_front(a_size);
+}
+
+//------------------------------------------------------------------------------
+
+void Packet::slice(Packet& a_packet, size_t a_size)
+{
+    REMO_PRECOND({
+        REMO_ASSERT(m_buffer_size == 0 && !m_sliced,
+            "only packets without a buffer can be slices");
+        REMO_ASSERT(a_size <= a_packet.m_payload.get_size(),
+            "slice must be within the first payload segment");
+    });
+
+    // refer to the bytes, and keep the packet holding them
+    a_packet.m_holders.fetch_add(1, std::memory_order_relaxed);
+    m_sliced = &a_packet;
+    uint8_t* data = a_packet.m_payload.get_data();
+    m_header.init(data, 0);
+    m_payload.init(data, a_size, a_size);
+}
+
+//------------------------------------------------------------------------------
+
+void Packet::drop_front(size_t a_size)
+{
+    REMO_PRECOND({
+        REMO_ASSERT(a_size <= m_payload.get_size(),
+            "size to drop must not exceed the first payload segment");
+    });
+
+    // the header now precedes the remaining payload. it may grow into the bytes
+    // dropped, unless they belong to another packet
+    m_payload.drop_front(a_size);
+    uint8_t* border = m_payload.get_data();
+    m_header.init(border, m_buffer_size > 0 ? static_cast<size_t>(border - m_buffer.get()) : 0);
+}
+
+//------------------------------------------------------------------------------
+
+RBuffer* Packet::add_segment()
+{
+    // limit total size, also against bogus sizes received
+    if (get_buffer_size() + (m_segment_count + 1) * SEGMENT_SIZE > REMO_MAX_MESSAGE_SIZE) {
+        return nullptr;
+    }
+
+    // get a packet to hold the segment, without any header
+    Packet* segment = get_segment_pool().try_take();
+    if (!segment) {
+        return nullptr;
+    }
+    segment->set_header_capacity(0);
+
+    // append it to our list
+    if (m_last_segment) {
+        m_last_segment->m_next_segment = segment;
+    } else {
+        m_next_segment = segment;
+    }
+    m_last_segment = segment;
+    m_segment_count++;
+
+    return &segment->m_payload;
+}
+
+//------------------------------------------------------------------------------
+
+void Packet::release_segments()
+{
+    // give segments back to their pool
+    Packet* segment = m_next_segment;
+    while (segment) {
+        Packet* next = segment->m_next_segment;
+        segment->m_next_segment = nullptr;
+        segment->recycle();
+        segment = next;
+    }
+    m_next_segment = nullptr;
+    m_last_segment = nullptr;
+    m_segment_count = 0;
 }
 
 //------------------------------------------------------------------------------
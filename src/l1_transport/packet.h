@@ -10,33 +10,54 @@
 #pragma once
 
 #include "buffer.h"
-#include "l0_system/system.h" // REMO_MSVC_WARN_SUPPRESS
 #include "l0_system/error.h"
 #include "utils/recycling.h"
 
 #include <iostream>
 #include <memory>
-#include <cstddef> // max_align_t
+#include <atomic>
 
 //------------------------------------------------------------------------------
 // defines
 //------------------------------------------------------------------------------
 //
-//! maximum allowed packet size (header and payload)
-#ifndef REMO_MAX_PACKET_SIZE
-#define REMO_MAX_PACKET_SIZE           1024
-#endif 
+//! buffer sizes (header and payload) of the packet size classes. packets are
+//! pooled per class, so that small messages do not pin the memory of large ones
+#ifndef REMO_PACKET_SIZE_SMALL
+#define REMO_PACKET_SIZE_SMALL         256
+#endif
+
+#ifndef REMO_PACKET_SIZE_MEDIUM
+#define REMO_PACKET_SIZE_MEDIUM        (4 * 1024)
+#endif
+
+#ifndef REMO_PACKET_SIZE_LARGE
+#define REMO_PACKET_SIZE_LARGE         (64 * 1024)
+#endif
+
+static_assert(REMO_PACKET_SIZE_SMALL < REMO_PACKET_SIZE_MEDIUM && REMO_PACKET_SIZE_MEDIUM < REMO_PACKET_SIZE_LARGE,
+    "packet size classes must be ascending");
+
+//! maximum allowed packet size (header and payload), i.e. that of the largest class
+#define REMO_MAX_PACKET_SIZE           REMO_PACKET_SIZE_LARGE
 
 //! maximum allowed packet header size
 #ifndef REMO_MAX_PACKET_HEADER_SIZE
 #define REMO_MAX_PACKET_HEADER_SIZE    128
 #endif 
 
+static_assert(REMO_MAX_PACKET_HEADER_SIZE < REMO_PACKET_SIZE_SMALL,
+    "max header size must be smaller than the smallest packet size");
+
 //! maximum allowed packet payload size
-static_assert(REMO_MAX_PACKET_HEADER_SIZE < REMO_MAX_PACKET_SIZE,
-    "max header size must be smaller than total packet size");
 #define REMO_MAX_PACKET_PAYLOAD_SIZE   (REMO_MAX_PACKET_SIZE - REMO_MAX_PACKET_HEADER_SIZE) 
 
+//! maximum allowed message size. payloads exceeding a packet continue in
+//! further packets used as segments, up to this size in total
+#ifndef REMO_MAX_MESSAGE_SIZE
+#define REMO_MAX_MESSAGE_SIZE          (1024 * 1024)
+#endif
+
 //------------------------------------------------------------------------------
 namespace remo {
     namespace trans {
@@ -54,34 +75,68 @@ enum PacketType: uint8_t
 class Packet: public Recyclable<Packet>
 {
 public:
-    Packet();
+    //! create a packet with a buffer of the given size, for header and payload.
+    //! packets without a buffer serve as slices of others
+    explicit Packet(size_t a_buffer_size = REMO_MAX_PACKET_SIZE);
+    //! create a packet using the given buffer, e.g. within a slab kept alive by it
+    Packet(const std::shared_ptr<uint8_t>& a_buffer, size_t a_buffer_size);
     virtual ~Packet();
 
     void set_header_capacity(size_t a_capacity);
     size_t get_header_capacity() const;
 
-    Buffer& get_header() { return m_header; }
-    const Buffer& get_header() const { return m_header; }
+    LBuffer& get_header() { return m_header; }
+    const LBuffer& get_header() const { return m_header; }
     
-    Buffer& get_payload() { return m_payload; }
+    RBuffer& get_payload() { return m_payload; }
     const Buffer& get_payload() const { return m_payload; }
 
     uint8_t* get_data() { return m_header.get_data(); }
-    size_t get_size() const { return m_header.get_size() + m_payload.get_size(); }        
-    size_t get_buffer_size() const { return sizeof(m_buffer); }
+    size_t get_size() const { return m_header.get_size() + m_payload.get_total_size(); }        
+    size_t get_buffer_size() const { return m_buffer_size; }
 
     void drop_header(size_t a_size);
 
+    //! let the payload of this packet, which must not have a buffer of its own, refer
+    //! to the first bytes of the given packet's payload, e.g. a frame received along
+    //! with others. the given packet is kept until this one is recycled as well
+    void slice(Packet& a_packet, size_t a_size);
+    //! remove bytes from the front of the payload, e.g. a frame handed on as slice
+    void drop_front(size_t a_size);
+
     std::string to_string() const;
 
 protected:
     void recycle() override;
 
 private:
-	REMO_MSVC_WARN_SUPPRESS(4324) // structure was padded -> sure
-    alignas(std::max_align_t) uint8_t m_buffer [REMO_MAX_PACKET_SIZE];
+    //! payload that continues in further packets when full
+    class Payload: public RBuffer {
+    public:
+        Payload(Packet& a_packet): m_packet(a_packet) {}
+    protected:
+        virtual RBuffer* new_segment() override { return m_packet.add_segment(); }
+    private:
+        Packet& m_packet;
+    };
+
+    RBuffer* add_segment();
+    void release_segments();
+
+private:
+    //! allocated separately, as its size depends on the size class
+    std::shared_ptr<uint8_t> m_buffer;
+    size_t m_buffer_size;
     LBuffer m_header;
-    RBuffer m_payload;
+    Payload m_payload;
+    //! packets holding further payload segments, if any
+    Packet* m_next_segment;
+    Packet* m_last_segment;
+    size_t m_segment_count;
+    //! owner and slices referring to this packet. recycled when the last one is done
+    std::atomic<size_t> m_holders;
+    //! packet this one is a slice of, if any
+    Packet* m_sliced;
 };
 
 
@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#include "packet_pool.h"
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+//
+// C++ 
+//
+// system
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace trans {
+//------------------------------------------------------------------------------	
+
+//------------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------------	
+//
+//! packets in a slab are aligned to cache lines, as long as their sizes are
+static const size_t CACHE_LINE_SIZE = 64;
+static_assert(REMO_PACKET_SIZE_SMALL % CACHE_LINE_SIZE == 0
+	&& REMO_PACKET_SIZE_MEDIUM % CACHE_LINE_SIZE == 0
+	&& REMO_PACKET_SIZE_LARGE % CACHE_LINE_SIZE == 0,
+	"packet sizes must be multiples of the cache line size");
+
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------	
+//
+//! limits with the given watermarks
+static PoolLimits pool_limits(size_t a_low_watermark, size_t a_high_watermark)
+{
+	PoolLimits limits;
+	limits.low_watermark = a_low_watermark;
+	limits.high_watermark = a_high_watermark;
+	return limits;
+}
+
+
+//------------------------------------------------------------------------------
+// class implementation
+//------------------------------------------------------------------------------	
+//
+PacketPool::Limits::Limits():
+	// fewer of the larger packets, they are needed less often
+	small(pool_limits(16, 1024)),
+	medium(pool_limits(4, 256)),
+	large(pool_limits(0, 64)),
+	slices(pool_limits(16, 1024)),
+	slab(false),
+	huge_pages(true)
+{
+}
+
+//------------------------------------------------------------------------------	
+//
+PacketPool::PacketPool(const Limits& a_limits):
+	m_slab(create_slab(a_limits)),
+	m_pools{
+		{ get_pool_limits(a_limits, PacketSize::small), get_factory(a_limits, PacketSize::small) },
+		{ get_pool_limits(a_limits, PacketSize::medium), get_factory(a_limits, PacketSize::medium) },
+		{ get_pool_limits(a_limits, PacketSize::large), get_factory(a_limits, PacketSize::large) },
+	},
+	m_slices(a_limits.slices, [] { return new Packet(0); })
+{
+}
+
+//------------------------------------------------------------------------------	
+//
+std::shared_ptr<sys::Slab> PacketPool::create_slab(const Limits& a_limits)
+{
+	if (!a_limits.slab) {
+		return nullptr;
+	}
+	const size_t size = 
+		a_limits.small.high_watermark * REMO_PACKET_SIZE_SMALL +
+		a_limits.medium.high_watermark * REMO_PACKET_SIZE_MEDIUM +
+		a_limits.large.high_watermark * REMO_PACKET_SIZE_LARGE;
+	return std::make_shared<sys::Slab>(size, a_limits.huge_pages);
+}
+
+//------------------------------------------------------------------------------	
+//
+PoolLimits PacketPool::get_pool_limits(const Limits& a_limits, PacketSize a_size_class)
+{
+	PoolLimits limits = 
+		a_size_class == PacketSize::small ? a_limits.small :
+		a_size_class == PacketSize::medium ? a_limits.medium : a_limits.large;
+	if (a_limits.slab) {
+		// all packets are allocated in advance, and kept
+		limits.low_watermark = limits.high_watermark;
+	}
+	return limits;
+}
+
+//------------------------------------------------------------------------------	
+//
+ElasticPool<Packet>::Factory PacketPool::get_factory(const Limits& a_limits, PacketSize a_size_class) const
+{
+	const size_t buffer_size = get_buffer_size(a_size_class);
+	if (!m_slab) {
+		// allocated one by one
+		return [buffer_size] { return new Packet(buffer_size); };
+	}
+
+	// the slab holds the buffers of each class one after the other, in the order of the classes
+	size_t offset = 0;
+	for (PacketSize size_class = PacketSize::small; size_class != a_size_class; 
+		size_class = static_cast<PacketSize>(static_cast<size_t>(size_class) + 1)) {
+		offset += get_pool_limits(a_limits, size_class).high_watermark * get_buffer_size(size_class);
+	}
+	const size_t count = get_pool_limits(a_limits, a_size_class).high_watermark;
+
+	// the buffers share the ownership of the slab
+	std::shared_ptr<sys::Slab> slab = m_slab;
+	size_t index = 0;
+	return [slab, offset, count, buffer_size, index]() mutable {
+		if (index >= count) {
+			// cannot happen as long as all packets are kept
+			return new Packet(buffer_size);
+		}
+		uint8_t* buffer = slab->get_data() + offset + index++ * buffer_size;
+		return new Packet(std::shared_ptr<uint8_t>(slab, buffer), buffer_size);
+	};
+}
+
+//------------------------------------------------------------------------------	
+//
+Packet* PacketPool::take(size_t a_payload_size)
+{
+	return pool(get_size_class(a_payload_size)).take();
+}
+
+//------------------------------------------------------------------------------	
+//
+PacketSize PacketPool::get_size_class(size_t a_payload_size)
+{
+	// the header is not known yet, so reserve the maximum
+	const size_t size = a_payload_size + REMO_MAX_PACKET_HEADER_SIZE;
+	if (size <= REMO_PACKET_SIZE_SMALL) {
+		return PacketSize::small;
+	}
+	if (size <= REMO_PACKET_SIZE_MEDIUM) {
+		return PacketSize::medium;
+	}
+	return PacketSize::large;
+}
+
+//------------------------------------------------------------------------------	
+//
+size_t PacketPool::get_buffer_size(PacketSize a_size_class)
+{
+	switch (a_size_class) {
+		case PacketSize::small:  return REMO_PACKET_SIZE_SMALL;
+		case PacketSize::medium: return REMO_PACKET_SIZE_MEDIUM;
+		default:                 return REMO_PACKET_SIZE_LARGE;
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+size_t PacketPool::get_size() const
+{
+	size_t size = 0;
+	for (const ElasticPool<Packet>& pool: m_pools) {
+		size += pool.get_stats().size;
+	}
+	return size;
+}
+
+//------------------------------------------------------------------------------
+	} // end namespace trans
+} // end namespace remo
+//------------------------------------------------------------------------------
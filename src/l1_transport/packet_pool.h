@@ -0,0 +1,123 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+#include "packet.h"
+#include "l0_system/slab.h"
+#include "utils/elastic_pool.h"
+//
+// C++ 
+#include <memory>
+#include <stddef.h>
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace trans {
+//------------------------------------------------------------------------------
+
+//! packet size classes
+enum class PacketSize: uint8_t
+{
+	small,  // REMO_PACKET_SIZE_SMALL
+	medium, // REMO_PACKET_SIZE_MEDIUM
+	large,  // REMO_PACKET_SIZE_LARGE
+};
+
+//! number of packet size classes
+static const size_t PACKET_SIZE_CLASSES = 3;
+
+//------------------------------------------------------------------------------
+// class declaration
+//------------------------------------------------------------------------------
+//
+/**
+ * Packet pools per size class
+ *
+ * Packets are taken from the smallest class whose payload capacity holds the
+ * expected payload size. Payloads exceeding it continue in further segments,
+ * so the expected size is just a hint.
+ *
+ * Optionally, the buffers of all packets are allocated in advance from one
+ * slab, i.e. the high watermark of each class. Memory usage is then fixed.
+ */
+class PacketPool
+{
+// types
+public:
+	//! limits of the pool of each size class
+	struct Limits {
+		Limits();
+		PoolLimits small;
+		PoolLimits medium;
+		PoolLimits large;
+		//! packets without a buffer, referring to slices of others
+		PoolLimits slices;
+		//! allocate all packet buffers up front from one contiguous slab
+		bool slab;
+		//! try to back the slab with huge pages
+		bool huge_pages;
+	};
+
+// ctor/dtor
+public:
+	PacketPool(const Limits& a_limits = Limits());
+
+// public member functions
+public:
+	//! take a packet sized for the given payload. waits if all packets of its
+	//! class are in use, and returns nullptr if that timed out
+	Packet* take(size_t a_payload_size = 0);
+	//! take a packet of the given size class without waiting. nullptr if all are in use
+	Packet* try_take(PacketSize a_size_class) { return pool(a_size_class).try_take(); }
+
+	//! take a packet without a buffer, to be used as a slice of another one.
+	//! does not wait, and returns nullptr if all are in use
+	Packet* take_slice() { return m_slices.try_take(); }
+
+	//! size class that holds the given payload size, the largest one if none does
+	static PacketSize get_size_class(size_t a_payload_size);
+	//! buffer size (header and payload) of packets of the given size class
+	static size_t get_buffer_size(PacketSize a_size_class);
+
+	//! counters and limits of the pool of the given size class
+	PoolStats get_stats(PacketSize a_size_class) const { return pool(a_size_class).get_stats(); }
+	const PoolLimits& get_limits(PacketSize a_size_class) const { return pool(a_size_class).get_limits(); }
+	//! total number of packets with a buffer allocated, taken or not
+	size_t get_size() const;
+	//! slab holding the packet buffers, if any
+	const sys::Slab* get_slab() const { return m_slab.get(); }
+
+// private member functions
+private:
+	static std::shared_ptr<sys::Slab> create_slab(const Limits& a_limits);
+	static PoolLimits get_pool_limits(const Limits& a_limits, PacketSize a_size_class);
+	ElasticPool<Packet>::Factory get_factory(const Limits& a_limits, PacketSize a_size_class) const;
+
+	ElasticPool<Packet>& pool(PacketSize a_size_class) { return m_pools[static_cast<size_t>(a_size_class)]; }
+	const ElasticPool<Packet>& pool(PacketSize a_size_class) const { return m_pools[static_cast<size_t>(a_size_class)]; }
+
+// private members
+private:
+	//! shared with the packet buffers, so that it goes after the last of them
+	std::shared_ptr<sys::Slab> m_slab;
+	ElasticPool<Packet> m_pools[PACKET_SIZE_CLASSES];
+	ElasticPool<Packet> m_slices;
+};
+
+//------------------------------------------------------------------------------
+	} // end namespace trans
+} // end namespace remo
+//------------------------------------------------------------------------------
@@ -12,6 +12,8 @@
 #include "utils/logger.h"
 
 #include <stdio.h>
+#include <cstring> // memcpy
+#include <algorithm> // min
 #include <sstream>
 #include <iomanip>
 
@@ -23,26 +25,140 @@ namespace remo {
 //! logger instance
 static Logger logger("Reader");
 
-
 //------------------------------------------------------------------------------
 // class Reader
 //------------------------------------------------------------------------------
 
 Reader::Reader(const Buffer& a_buffer):
-	m_buffer(a_buffer), m_offset(0)
+	m_buffer(a_buffer), m_offset(0), m_size(a_buffer.get_total_size()),
+	m_segment(nullptr), m_segment_data(nullptr), m_segment_start(0), m_segment_end(0),
+	m_storage()
+{
+	enter_segment(&a_buffer, 0);
+}
+
+//------------------------------------------------------------------------------
+
+void Reader::enter_segment(const Buffer* a_segment, size_t a_start)
+{
+	m_segment = a_segment;
+	m_segment_data = a_segment->get_data();
+	m_segment_start = a_start;
+	m_segment_end = a_start + a_segment->get_size();
+}
+
+//------------------------------------------------------------------------------
+
+void Reader::check_access(size_t a_size) const
+{
+	if (a_size > m_size - m_offset) {
+		bad_access(a_size);
+	}
+}
+
+//------------------------------------------------------------------------------
+
+const uint8_t* Reader::consume_segments(size_t a_size)
+{
+	check_access(a_size);
+
+	// move on to the segment containing the offset
+	while (m_offset == m_segment_end && m_segment->get_next()) {
+		enter_segment(m_segment->get_next(), m_segment_end);
+	}
+	if (a_size <= m_segment_end - m_offset) {
+		const uint8_t* ptr = m_segment_data + (m_offset - m_segment_start);
+		m_offset += a_size;
+		return ptr;
+	}
+
+	// bytes span several segments -> gather them
+	uint8_t* ptr = static_cast<uint8_t*>(allocate(a_size));
+	uint8_t* dest = ptr;
+	size_t remaining = a_size;
+	for (;;) {
+		const size_t size = std::min(remaining, m_segment_end - m_offset);
+		std::memcpy(dest, m_segment_data + (m_offset - m_segment_start), size);
+		dest += size;
+		m_offset += size;
+		remaining -= size;
+		if (remaining == 0) {
+			break;
+		}
+		enter_segment(m_segment->get_next(), m_segment_end);
+	}
+	return ptr;
+}
+
+//------------------------------------------------------------------------------
+
+void Reader::skip_segments(size_t a_size)
+{
+	check_access(a_size);
+
+	m_offset += a_size;
+	while (m_offset > m_segment_end) {
+		enter_segment(m_segment->get_next(), m_segment_end);
+	}
+}
+
+//------------------------------------------------------------------------------
+
+void Reader::seek(size_t a_offset)
+{
+	// segments are only linked forward
+	if (a_offset < m_segment_start) {
+		enter_segment(&m_buffer, 0);
+	}
+	m_offset = m_segment_start;
+	skip(a_offset - m_segment_start);
+}
+
+//------------------------------------------------------------------------------
+
+size_t Reader::find(uint8_t a_byte) const
+{
+	size_t distance = 0;
+	size_t offset = m_offset - m_segment_start;
+	for (const Buffer* segment = m_segment; segment; segment = segment->get_next()) {
+		const uint8_t* data = segment->get_data() + offset;
+		const size_t size = segment->get_size() - offset;
+		const void* found = std::memchr(data, a_byte, size);
+		if (found) {
+			return distance + static_cast<size_t>(static_cast<const uint8_t*>(found) - data);
+		}
+		distance += size;
+		offset = 0;
+	}
+	return distance;
+}
+
+//------------------------------------------------------------------------------
+
+void* Reader::allocate(size_t a_size)
 {
+	m_storage.emplace_back(a_size / sizeof(uint64_t) + 1);
+	return m_storage.back().data();
+}
+
+//------------------------------------------------------------------------------
+
+void Reader::bad_access(size_t a_size) const
+{
+	REMO_THROW(ErrorCode::ERR_BAD_PACKET_ACCESS, 
+		"Bad packet buffer read access: offset=%zu, size=%zu, bufsize=%zu", 
+		m_offset, a_size, m_size);
 }
 
 //------------------------------------------------------------------------------
 
 void Reader::skip_array(size_t a_arraylength, size_t a_item_size)
 {
-	size_t total_size = a_arraylength * a_item_size;
-	REMO_THROW_IF(m_offset + total_size > m_buffer.get_size(), 
+	REMO_THROW_IF(a_arraylength > (m_size - m_offset) / a_item_size, 
 		ErrorCode::ERR_INVALID_ARRAY_LENGTH, 
 		"invalid array length: %zu", 
 		a_arraylength);
-	m_offset += total_size;
+	skip(a_arraylength * a_item_size);
 }
 
 
@@ -51,6 +167,14 @@ void Reader::skip_array(size_t a_arraylength, size_t a_item_size)
 //------------------------------------------------------------------------------
 
 void BinaryReader::read_call()
+{
+	read_call_header();
+	read_args();
+}
+
+//------------------------------------------------------------------------------
+
+void BinaryReader::read_call_header()
 {
 	// locals
 	uint8_t modifier = 0;
@@ -61,17 +185,24 @@ void BinaryReader::read_call()
 		ErrorCode::ERR_BAD_PACKET, 
 		"not a 'call' packet");
 
-	// expect function name
+	// expect function id or name
+	size_t start_offset = m_offset;
 	TypeId type = read_type(modifier);
-	REMO_THROW_IF(type != TypeId::type_cstr, 
-		ErrorCode::ERR_FUNC_NAME_MISSING, 
-		"Function name missing");
+	if (type == TypeId::type_uint32) {
+		// function id
+		m_function_id = read_value<uint32_t>(modifier);
+		m_has_function_id = true;
+	} else {
+		// function name
+		seek(start_offset);
+		read_function_name();
+	}
+}
 
-	// read function name
-	size_t start_offset = m_offset;
-	const char* a_name = read_cstr();
-	m_function.assign(a_name, m_offset - start_offset - 1); // no trailing NUL
+//------------------------------------------------------------------------------
 
+void BinaryReader::read_args()
+{
 	// read arguments
 	while (has_more()) {
 		m_args.push_back(read_typed_value());
@@ -80,6 +211,67 @@ void BinaryReader::read_call()
 
 //------------------------------------------------------------------------------
 
+void BinaryReader::read_query()
+{
+	// expect 'query' packet
+	uint8_t packet_type = read<uint8_t>();
+	REMO_THROW_IF(packet_type != PacketType::packet_query, 
+		ErrorCode::ERR_BAD_PACKET, 
+		"not a 'query' packet");
+
+	// read name of function whose id is requested
+	read_function_name();
+}
+
+//------------------------------------------------------------------------------
+
+bool BinaryReader::read_info(uint32_t& o_function_id)
+{
+	// locals
+	uint8_t modifier = 0;
+
+	// expect 'info' packet
+	uint8_t packet_type = read<uint8_t>();
+	REMO_THROW_IF(packet_type != PacketType::packet_info, 
+		ErrorCode::ERR_BAD_PACKET, 
+		"not an 'info' packet");
+
+	// read function name
+	read_function_name();
+
+	// read function id, or null if no such function
+	TypeId type = read_type(modifier);
+	if (type == TypeId::type_null) {
+		return false;
+	}
+	REMO_THROW_IF(type != TypeId::type_uint32, 
+		ErrorCode::ERR_BAD_PACKET, 
+		"invalid function id type: %s", get_type_name(type));
+	o_function_id = read_value<uint32_t>(modifier);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+
+void BinaryReader::read_function_name()
+{
+	// locals
+	uint8_t modifier = 0;
+
+	// expect function name
+	TypeId type = read_type(modifier);
+	REMO_THROW_IF(type != TypeId::type_cstr, 
+		ErrorCode::ERR_FUNC_NAME_MISSING, 
+		"Function name missing");
+
+	// read function name
+	size_t length = 0;
+	const char* name = read_cstr(modifier, length);
+	m_function.assign(name, length);
+}
+
+//------------------------------------------------------------------------------
+
 TypedValue BinaryReader::read_typed_value()
 {
 	// read header byte
@@ -107,43 +299,75 @@ TypedValue BinaryReader::read_typed_value()
 		return TypedValue(read_value<int64_t>(modifier));
 	case type_void:
 		return TypedValue(TypeId::type_void);
-//			case type_any:
+	case type_any: {
+		// struct, refer to its encoding. it can only be decoded by someone knowing its type
+		const size_t start = m_offset - 1;
+		const size_t length = read_struct_length(modifier);
+		const size_t end = m_offset + length;
+		seek(start);
+		return TypedValue::any(consume(end - start));
+	}
 	case type_bool:
 		return TypedValue(modifier != 0);
 	case type_cstr:
-		return TypedValue(read_cstr());
+		return TypedValue(read_cstr(modifier));
 	case type_double:
 		return TypedValue(read_value<double>(modifier));
 //			case type_error:
 	case type_float:
 		return TypedValue(read_value<float>(modifier));
+	case type_arraysize:
+		return TypedValue(read_arraysize(modifier));
 	// pointer types
 	case type_uint8_ptr:
-		return TypedValue(read_ptr<uint8_t>(modifier));
+		return TypedValue(read_ptr<uint8_t>());
 	case type_uint16_ptr:
-		return TypedValue(read_ptr<uint16_t>(modifier));
+		return TypedValue(read_ptr<uint16_t>());
 	case type_uint32_ptr:
-		return TypedValue(read_ptr<uint32_t>(modifier));
+		return TypedValue(read_ptr<uint32_t>());
 	case type_uint64_ptr:
-		return TypedValue(read_ptr<uint64_t>(modifier));
+		return TypedValue(read_ptr<uint64_t>());
 	case type_int8_ptr:
-		return TypedValue(read_ptr<int8_t>(modifier));
+		return TypedValue(read_ptr<int8_t>());
 	case type_int16_ptr:
-		return TypedValue(read_ptr<int16_t>(modifier));
+		return TypedValue(read_ptr<int16_t>());
 	case type_int32_ptr:
-		return TypedValue(read_ptr<int32_t>(modifier));
+		return TypedValue(read_ptr<int32_t>());
 	case type_int64_ptr:
-		return TypedValue(read_ptr<int64_t>(modifier));
+		return TypedValue(read_ptr<int64_t>());
 //			case type_void:
 //			case type_any:
 	case type_bool_ptr:
-		return TypedValue(read_ptr<bool>(modifier));
+		return TypedValue(read_ptr<bool>());
 	//case type_cstr_ptr:
 	case type_double_ptr:
-		return TypedValue(read_ptr<double>(modifier));
+		return TypedValue(read_ptr<double>());
 //			case type_error:
 	case type_float_ptr:
-		return TypedValue(read_ptr<float>(modifier));
+		return TypedValue(read_ptr<float>());
+	// const pointer types
+	case type_uint8_cptr:
+		return TypedValue(read_ptr<const uint8_t>(modifier));
+	case type_uint16_cptr:
+		return TypedValue(read_ptr<const uint16_t>(modifier));
+	case type_uint32_cptr:
+		return TypedValue(read_ptr<const uint32_t>(modifier));
+	case type_uint64_cptr:
+		return TypedValue(read_ptr<const uint64_t>(modifier));
+	case type_int8_cptr:
+		return TypedValue(read_ptr<const int8_t>(modifier));
+	case type_int16_cptr:
+		return TypedValue(read_ptr<const int16_t>(modifier));
+	case type_int32_cptr:
+		return TypedValue(read_ptr<const int32_t>(modifier));
+	case type_int64_cptr:
+		return TypedValue(read_ptr<const int64_t>(modifier));
+	case type_bool_cptr:
+		return TypedValue(read_ptr<const bool>(modifier));
+	case type_double_cptr:
+		return TypedValue(read_ptr<const double>(modifier));
+	case type_float_cptr:
+		return TypedValue(read_ptr<const float>(modifier));
 	default:
 		REMO_THROW(ErrorCode::ERR_PARAM_TYPE_INVALID, 
 			"invalid parameter type: %s (0x%02X)", get_type_name(type), type);
@@ -154,7 +378,7 @@ TypedValue BinaryReader::read_typed_value()
 
 std::string BinaryReader::to_string()
 {
-	if (m_buffer.get_size() > 0) {
+	if (m_size > 0) {
 		// check packet type
 		switch (read<uint8_t>()) {
 		case PacketType::packet_call:
@@ -163,10 +387,16 @@ std::string BinaryReader::to_string()
 		case PacketType::packet_result:
 			// result
 			return "result: " + format_result();
+		case PacketType::packet_query:
+			// query
+			return "query: " + format_query();
+		case PacketType::packet_info:
+			// info
+			return "info: " + format_info();
 		default:
 			// unknown packet type
 			std::stringstream ss;
-			ss << "unknown packet of size " << m_buffer.get_size() << ": ";
+			ss << "unknown packet of size " << m_size << ": ";
 			ss << '[' << m_buffer.to_hex() << ']';
 			return ss.str();
 		}
@@ -183,9 +413,12 @@ std::string BinaryReader::format_call()
 	std::stringstream ss;
 	uint8_t modifier = 0;
 
-	// print function name
-	if (read_type(modifier) == TypeId::type_cstr) {
-		ss << read_cstr();
+	// print function name or id
+	TypeId type = read_type(modifier);
+	if (type == TypeId::type_cstr) {
+		ss << read_cstr(modifier);
+	} else if (type == TypeId::type_uint32) {
+		ss << '#' << read_value<uint32_t>(modifier);
 	} else {
 		ss << "???";
 	}
@@ -228,6 +461,30 @@ std::string BinaryReader::format_result()
 
 //------------------------------------------------------------------------------
 
+std::string BinaryReader::format_query()
+{
+	// print function name
+	return format_value();
+}
+
+//------------------------------------------------------------------------------
+
+std::string BinaryReader::format_info()
+{
+	// locals
+	std::stringstream ss;
+
+	// print function name and id
+	ss << format_value();
+	if (has_more()) {
+		ss << " = " << format_value();
+	}
+
+	return ss.str();
+}
+
+//------------------------------------------------------------------------------
+
 std::string BinaryReader::format_value()
 {
 	// locals
@@ -237,84 +494,85 @@ std::string BinaryReader::format_value()
 	// read header byte
 	TypeId type = read_type(modifier);
 
+	// pointers to structs are followed by the struct itself
+	if (type == type_any_ptr || type == type_any_cptr) {
+		return '&' + format_value();
+	}
+
+	// arrays are printed element-wise
+	if (is_ptr_type(type) || is_cptr_type(type)) {
+		return format_array(type, modifier);
+	}
+
 	// print value
 	switch (type) {
 	case type_null:
 		ss << '(' << get_type_name(type) << ')';
 		break;
 	case type_uint8:
-	case type_uint8_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<uint8_t>(modifier);
 		break;
 	case type_uint16:
-	case type_uint16_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<uint16_t>(modifier);
 		break;
 	case type_uint32:
-	case type_uint32_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<uint32_t>(modifier);
 		break;
 	case type_uint64:
-	case type_uint64_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<uint64_t>(modifier);
 		break;
 	case type_int8:
-	case type_int8_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<int8_t>(modifier);
 		break;
 	case type_int16:
-	case type_int16_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<int16_t>(modifier);
 		break;
 	case type_int32:
-	case type_int32_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<int32_t>(modifier);
 		break;
 	case type_int64:
-	case type_int64_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<int64_t>(modifier);
 		break;
 	case type_void:
-	case type_void_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		break;
-	case type_any:
-	case type_any_ptr:
-		ss << '(' << get_type_name(type) << ')';
+	case type_any: {
+		// struct, its contents depend on its type
+		const size_t length = read_struct_length(modifier);
+		consume(length);
+		ss << '(' << get_type_name(type) << ")[" << length << " bytes]";
 		break;
+	}
+
 	case type_bool:
 		ss << (modifier != 0 ? "true" : "false");
 		break;
-	case type_bool_ptr:
-		ss << '(' << get_type_name(type) << ')';
-		ss << (read_value<int64_t>(modifier) ? "true" : "false");
-		break;
 	case type_cstr:
-	case type_cstr_ptr:
-		ss << "\"" << read_cstr() << "\""; // TODO escaping (for C++14 we could use std::quote...)
+		ss << "\"" << read_cstr(modifier) << "\""; // TODO escaping (for C++14 we could use std::quote...)
 		break;
 	case type_double:
-	case type_double_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<double>(modifier);
 		break;
 	case type_error:
-	case type_error_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		break;
 	case type_float:
-	case type_float_ptr:
 		ss << '(' << get_type_name(type) << ')';
 		ss << read_value<float>(modifier);
 		break;
+	case type_arraysize:
+		ss << '(' << get_type_name(type) << ')';
+		ss << read_arraysize(modifier).value;
+		break;
 	default:
 		ss << "(0x" << std::hex << std::setw(2) << std::setfill('0') << type << ')';
 		break;
@@ -323,6 +581,260 @@ std::string BinaryReader::format_value()
 	return ss.str();
 }
 
+//------------------------------------------------------------------------------
+//
+//! print a single array item stored in little-endian order
+template<typename T>
+static void format_item(std::stringstream& a_ss, const uint8_t* a_data)
+{
+	// unary plus to print 8 bit integers as numbers
+	a_ss << +compact_value<T>(compact_load(a_data, sizeof(T)));
+}
+
+//------------------------------------------------------------------------------
+//
+std::string BinaryReader::format_array(TypeId a_type, uint8_t a_modifier)
+{
+	//! maximum number of items to print
+	const size_t MAX_ITEMS = 8;
+
+	// locals
+	std::stringstream ss;
+	TypeId item_type = static_cast<TypeId>(a_type & ~modifier_mask);
+	size_t item_size = get_type_size(item_type);
+	size_t count = m_has_arraysize ? m_arraysize.value : 1;
+	m_has_arraysize = false;
+
+	// unsupported item type?
+	if (item_size == 0) {
+		// yes -> cannot tell the size
+		ss << '(' << get_type_name(a_type) << ')';
+		return ss.str();
+	}
+
+	// access items without converting them
+	const uint8_t* data = nullptr;
+	if (a_modifier == modifier_delta) {
+		// decoded items are in native byte order
+		data = static_cast<const uint8_t*>(read_delta_array(count, item_size));
+		sys::convert_le_array(const_cast<uint8_t*>(data), count, item_size);
+	} else {
+		data = access_array(count, item_size);
+	}
+
+	// print items
+	ss << '(' << get_type_name(a_type) << ")[";
+	for (size_t i = 0; i < count && i < MAX_ITEMS; i++) {
+		if (i > 0) {
+			ss << ", ";
+		}
+		const uint8_t* p = data + i * item_size;
+		switch (item_type) {
+		case type_uint8:  format_item<uint8_t>(ss, p);  break;
+		case type_uint16: format_item<uint16_t>(ss, p); break;
+		case type_uint32: format_item<uint32_t>(ss, p); break;
+		case type_uint64: format_item<uint64_t>(ss, p); break;
+		case type_int8:   format_item<int8_t>(ss, p);   break;
+		case type_int16:  format_item<int16_t>(ss, p);  break;
+		case type_int32:  format_item<int32_t>(ss, p);  break;
+		case type_int64:  format_item<int64_t>(ss, p);  break;
+		case type_bool:   ss << (*p ? "true" : "false"); break;
+		case type_double: format_item<double>(ss, p);   break;
+		case type_float:  format_item<float>(ss, p);    break;
+		default:          ss << '?';                    break;
+		}
+	}
+	if (count > MAX_ITEMS) {
+		ss << ", ... (" << count << " items)";
+	}
+	ss << ']';
+
+	return ss.str();
+}
+
+//------------------------------------------------------------------------------
+//
+arraysize_t BinaryReader::read_arraysize(size_t a_wire_size)
+{
+	REMO_THROW_IF(m_has_arraysize, 
+		ErrorCode::ERR_POINTER_NEEDS_SIZE, 
+		"arraysize_t parameter must be followed by pointer type");
+
+	// remember for subsequent pointer
+	m_arraysize = arraysize_t(static_cast<size_t>(read_value<uint64_t>(a_wire_size)));
+	m_has_arraysize = true;
+	return m_arraysize;
+}
+
+//------------------------------------------------------------------------------
+//
+size_t BinaryReader::read_struct_length(size_t a_wire_size)
+{
+	const uint64_t length = read_value<uint64_t>(a_wire_size);
+	REMO_THROW_IF(length > m_size - m_offset, 
+		ErrorCode::ERR_BAD_PACKET, 
+		"invalid struct length: %llu", (unsigned long long)length);
+	return static_cast<size_t>(length);
+}
+
+//------------------------------------------------------------------------------
+//
+void BinaryReader::check_struct_size(size_t a_actual, size_t a_expected) const
+{
+	REMO_THROW_IF(a_actual != a_expected, 
+		ErrorCode::ERR_BAD_PACKET, 
+		"struct size mismatch: expected %zu bytes, got %zu", 
+		a_expected, a_actual);
+}
+
+//------------------------------------------------------------------------------
+//
+const char* BinaryReader::read_cstr(uint8_t a_wire_size, size_t& o_length)
+{
+	if (a_wire_size > 0) {
+		// length given -> skip characters at once
+		const uint64_t length = read_value<uint64_t>(a_wire_size);
+		REMO_THROW_IF(length >= m_size - m_offset, 
+			ErrorCode::ERR_BAD_PACKET, 
+			"invalid string length: %llu", (unsigned long long)length);
+		o_length = static_cast<size_t>(length);
+	} else {
+		// NUL-terminated only -> search terminator
+		o_length = find(0);
+		REMO_THROW_IF(o_length == m_size - m_offset, 
+			ErrorCode::ERR_BAD_PACKET, 
+			"string not terminated");
+	}
+	const char* str = reinterpret_cast<const char*>(consume(o_length + 1));
+	REMO_THROW_IF(str[o_length] != 0, 
+		ErrorCode::ERR_BAD_PACKET, 
+		"string not terminated");
+	return str;
+}
+
+//------------------------------------------------------------------------------
+//
+size_t BinaryReader::check_array_length(size_t a_count, size_t a_item_size) const
+{
+	// items are aligned to their size, relative to the start of the buffer
+	const size_t padding = (0 - m_offset) & (a_item_size - 1);
+	const size_t available = m_size - m_offset;
+
+	// check length without risking an overflow
+	REMO_THROW_IF(padding > available || a_count > (available - padding) / a_item_size, 
+		ErrorCode::ERR_INVALID_ARRAY_LENGTH, 
+		"invalid array length: %zu", 
+		a_count);
+
+	return padding;
+}
+
+//------------------------------------------------------------------------------
+//
+const uint8_t* BinaryReader::access_array(size_t a_count, size_t a_item_size)
+{
+	skip(check_array_length(a_count, a_item_size));
+	const size_t size = a_count * a_item_size;
+	const uint8_t* data = consume(size);
+
+	// items are provided in place, which requires them to be aligned in memory
+	if ((reinterpret_cast<uintptr_t>(data) & (a_item_size - 1)) != 0) {
+		// not the case, e.g. for segments of a packet written locally -> copy them
+		void* items = allocate(size);
+		std::memcpy(items, data, size);
+		return static_cast<const uint8_t*>(items);
+	}
+	return data;
+}
+
+//------------------------------------------------------------------------------
+//
+void* BinaryReader::read_array(size_t a_item_size, uint8_t a_modifier)
+{
+	// assume size of 1 if not specified
+	const size_t count = m_has_arraysize ? m_arraysize.value : 1;
+	m_has_arraysize = false;
+
+	// delta-encoded?
+	if (a_modifier == modifier_delta) {
+		// yes -> decode
+		return read_delta_array(count, a_item_size);
+	}
+
+	// provide items in place. this requires them to be in native byte order
+	// TODO eliminate const cast?
+	uint8_t* data = const_cast<uint8_t*>(access_array(count, a_item_size));
+	sys::convert_le_array(data, count, a_item_size);
+	return data;
+}
+
+//------------------------------------------------------------------------------
+//
+const uint8_t* BinaryReader::access_delta_array(size_t a_count, size_t a_item_size, size_t& o_data_size)
+{
+	// control bytes, then data bytes, as checked by the buffer
+	const size_t control_size = a_count / 2 + (a_count & 1);
+	const uint8_t* encoded = consume(control_size);
+	const bool valid_item_size = a_item_size == 2 || a_item_size == 4 || a_item_size == 8;
+	REMO_THROW_IF(!valid_item_size || !delta_data_size(encoded, a_count, a_item_size, o_data_size), 
+		ErrorCode::ERR_BAD_PACKET, 
+		"invalid delta-encoded array");
+	const uint8_t* data = consume(o_data_size);
+
+	// control and data bytes in different segments?
+	if (data != encoded + control_size) {
+		// yes -> join them
+		uint8_t* joined = static_cast<uint8_t*>(allocate(control_size + o_data_size));
+		std::memcpy(joined, encoded, control_size);
+		std::memcpy(joined + control_size, data, o_data_size);
+		return joined;
+	}
+	return encoded;
+}
+
+//------------------------------------------------------------------------------
+//
+void* BinaryReader::read_delta_array(size_t a_count, size_t a_item_size)
+{
+	size_t data_size = 0;
+	const uint8_t* encoded = access_delta_array(a_count, a_item_size, data_size);
+
+	// decode into storage of our own, as the items take more space than their encoding.
+	// the count is limited by the packet size, so this does not overflow
+	void* items = allocate(a_count * a_item_size);
+	delta_decode(items, encoded, a_count, a_item_size, data_size);
+	return items;
+}
+
+//------------------------------------------------------------------------------
+//
+void BinaryReader::read_outarray(TypeId a_expected_type, void* a_dest, size_t a_count, size_t a_item_size)
+{
+	// array size precedes the array if specified
+	uint8_t modifier = 0;
+	TypeId actual_type = read_type(modifier);
+	if (actual_type == type_arraysize) {
+		read_arraysize(modifier);
+		actual_type = read_type(modifier);
+	}
+
+	// check if out parameter type matches
+	check_param_type(actual_type, a_expected_type);
+
+	// check if array size matches
+	const size_t count = m_has_arraysize ? m_arraysize.value : 1;
+	REMO_THROW_IF(count != a_count, 
+		ErrorCode::ERR_INVALID_ARRAY_LENGTH, 
+		"out parameter array length mismatch: expected %zu, got %zu", 
+		a_count, count);
+
+	// copy items in bulk
+	const void* data = read_array(a_item_size, modifier);
+	if (count > 0) {
+		std::memcpy(a_dest, data, count * a_item_size);
+	}
+}
+
 //------------------------------------------------------------------------------
 //
 void BinaryReader::check_param_type(TypeId a_actual_type, TypeId a_expected_type) const
@@ -342,6 +854,15 @@ void BinaryReader::check_result_packet(PacketType a_packet_type) const
 		"not a 'result' packet");
 }
 
+//------------------------------------------------------------------------------
+//
+void BinaryReader::bad_wire_size(size_t a_wire_size, size_t a_value_size) const
+{
+	REMO_THROW(ErrorCode::ERR_BAD_PACKET, 
+		"invalid wire size: %zu bytes for a value of %zu bytes", 
+		a_wire_size, a_value_size);
+}
+
 
 //------------------------------------------------------------------------------
 	} // end namespace trans
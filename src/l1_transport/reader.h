@@ -11,11 +11,17 @@
 
 #include "packet.h"
 #include "buffer.h"
+#include "compact.h"
+#include "delta.h"
 #include "l0_system/types.h"
 #include "l0_system/endianness.h"
 
 #include <iostream>
 #include <stdio.h>
+#include <cstring> // memcpy
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 //------------------------------------------------------------------------------
 namespace remo {
@@ -28,6 +34,10 @@ namespace remo {
 //
 class Reader
 {
+public:
+	//! values copied by the reader, as they could not be provided in place
+	typedef std::vector<std::vector<uint64_t>> Storage;
+
 public:
 	Reader(const Buffer& a_buffer);
 
@@ -35,20 +45,78 @@ public:
 	template<typename T>
 	T read()
 	{
-		const void* ptr = m_buffer.access_read(m_offset, sizeof(T));
-		m_offset += sizeof(T);
+		const void* ptr = consume(sizeof(T));
 		return sys::get_le(static_cast<const T*>(ptr));
 	}
 
 	bool has_more() const {
-		return m_offset < m_buffer.get_size();
+		return m_offset < m_size;
 	}
 
 	void skip_array(size_t a_arraylength, size_t a_item_size);
 
+	//! exchange the copied values with the given ones, e.g. to keep them
+	//! beyond the lifetime of the reader
+	void swap_storage(Storage& a_storage) { m_storage.swap(a_storage); }
+
+protected:
+	//! get a pointer to the given number of bytes and advance past them.
+	//! bytes spanning several segments are copied, so that they are contiguous
+	const uint8_t* consume(size_t a_size)
+	{
+		// within the current segment?
+		if (a_size <= m_segment_end - m_offset) {
+			// yes -> refer to them in place
+			const uint8_t* ptr = m_segment_data + (m_offset - m_segment_start);
+			m_offset += a_size;
+			return ptr;
+		}
+		return consume_segments(a_size);
+	}
+
+	//! advance past the given number of bytes without accessing them
+	void skip(size_t a_size)
+	{
+		if (a_size <= m_segment_end - m_offset) {
+			m_offset += a_size;
+		} else {
+			skip_segments(a_size);
+		}
+	}
+
+	//! move to the given offset, which must not exceed the size
+	void seek(size_t a_offset);
+
+	//! distance to the next occurrence of the given byte, or the remaining 
+	//! size if there is none
+	size_t find(uint8_t a_byte) const;
+
+	//! storage owned by the reader, aligned for any item type
+	void* allocate(size_t a_size);
+
+	void bad_access(size_t a_size) const;
+
+private:
+	const uint8_t* consume_segments(size_t a_size);
+	void skip_segments(size_t a_size);
+	void check_access(size_t a_size) const;
+	void enter_segment(const Buffer* a_segment, size_t a_start);
+
 protected:
 	const Buffer& m_buffer;
+	//! current offset, counted over all segments
 	size_t m_offset;
+	//! total size of all segments
+	size_t m_size;
+
+private:
+	//! segment containing the current offset, and its range
+	const Buffer* m_segment;
+	const uint8_t* m_segment_data;
+	size_t m_segment_start;
+	size_t m_segment_end;
+	//! storage for values that cannot be provided in place
+	Storage m_storage;
 };
 
 //------------------------------------------------------------------------------
@@ -62,9 +130,13 @@ public:
 		m_args() {}
 
 	void read_call();
+	void read_call_header();
+	void read_args();
+	void read_query();
+	bool read_info(uint32_t& o_function_id);
 
 	template<typename... Args>
-	TypedValue read_result(Args... args)
+	TypedValue read_result(Args&... args)
 	{
 		// expect 'result' packet
 		check_result_packet(PacketType(read<uint8_t>()));
@@ -78,42 +150,87 @@ public:
 
 	// read "out" parameter
 	template<typename T>
-	void read_outparam(T* arg)
+	void read_outparam(T* const& arg)
+	{
+		read_outparam(arg, is_struct<T>());
+	}
+
+	template<typename T>
+	void read_outparam(T* a_ptr, std::false_type /* struct */)
 	{
-		TypeId expected_type = TypeInfo<T*>::id();
+		// array size given by a preceding arraysize_t parameter, if any
+		const size_t count = m_has_outparam_arraysize ? m_outparam_arraysize.value : 1;
+		m_has_outparam_arraysize = false;
+
+		read_outarray(TypeInfo<T*>::id(), a_ptr, count, sizeof(T));
+	}
 
-		// check if out parameter type matches
+	// read "out" struct, following its pointer type
+	template<typename T>
+	void read_outparam(T* a_ptr, std::true_type /* struct */)
+	{
 		uint8_t modifier = 0;
-		TypeId actual_type = read_type(modifier);
-		check_param_type(actual_type, expected_type);
+		check_param_type(read_type(modifier), TypeInfo<T*>::id());
+		check_param_type(read_type(modifier), TypeId::type_any);
+		*a_ptr = read_struct<T>(modifier);
+	}
 
-		copy_to_ptr(arg, 1); // TODO handle array length
+	// read "out" array of known size
+	template<typename T, size_t N>
+	void read_outparam(T(&arg)[N])
+	{
+		read_outarray(TypeInfo<T*>::id(), arg, N, sizeof(T));
+	}
+
+	// array size of a subsequent "out" parameter
+	void read_outparam(const arraysize_t& arg)
+	{
+		m_outparam_arraysize = arg;
+		m_has_outparam_arraysize = true;
 	}
 
 	// template used to filter out non-pointer types in "out" parameters
 	template<typename T>
-	void read_outparam(T)
+	void read_outparam(const T&)
 	{
 	}
 
 	// template used to filter out const-pointer types in "out" parameters
 	template<typename T>
-	void read_outparam(const T*)
+	void read_outparam(const T* const&)
+	{
+		m_has_outparam_arraysize = false;
+	}
+
+	// template used to filter out const arrays in "out" parameters
+	template<typename T, size_t N>
+	void read_outparam(const T(&)[N])
 	{
 	}
 
 	// read type id
 	TypeId read_type(uint8_t& o_modifier)
 	{
-		// TODO use modifier constant
 		uint8_t h = read<uint8_t>();
 		o_modifier = (h >> 4) & 0xF;
-		if (o_modifier < 0xA) {
+		if (o_modifier < (modifier_delta >> 4)) {
 			// wire size
 			h &= 0xF;
+		} else if ((h & modifier_mask) == modifier_delta) {
+			// delta-encoded const array, the modifier tells read_array() to decode it
+			o_modifier = modifier_delta;
+			h = (h & 0xF) | modifier_cptr;
+		} else if ((h & modifier_mask) == modifier_arraysize) {
+			// array size with wire size
+			o_modifier = h & 0xF;
+			h = type_arraysize;
+		} else if ((h & modifier_mask) >= modifier_double_reversed) {
+			// compact floating point value. encoding and wire size are left to read_value()
+			o_modifier = h;
+			h = (h & modifier_mask) == modifier_float_reversed ? type_float : type_double;
 		} else {
 			// pointer type
-			o_modifier = (uint8_t) get_type_size(static_cast<TypeId>(h & 0xF));
+			o_modifier = 0;
 		}
 		return static_cast<TypeId>(h);
 	}
@@ -125,68 +242,219 @@ public:
 	template<typename T>
 	T read_value(size_t a_wire_size)
 	{
-		T value{};
-		uint8_t* p = reinterpret_cast<unsigned char*>(&value);
-		
-		// read actual bytes
-		LITTLE_ENDIAN_FOR(i, a_wire_size) {
-			p[i] = read<uint8_t>();
+		// more bytes than the value can hold?
+		if (a_wire_size > sizeof(T)) {
+			// yes -> malformed packet
+			bad_wire_size(a_wire_size, sizeof(T));
 		}
 
-		return value;
+		// read actual bytes
+		return compact_value<T>(compact_load(consume(a_wire_size), a_wire_size));
 	}
 
-	// read pointer type
+	// read pointer type. the array is converted to native byte order in place,
+	// or decoded if the modifier says so
 	template<typename T>
-	T* read_ptr(size_t a_arraylength)
+	T* read_ptr(uint8_t a_modifier = 0)
 	{
-		a_arraylength = 1; // TODO modify caller for correct value
-		// TODO eliminate const cast? 
-		T* ptr = (T*)m_buffer.access_read(m_offset, sizeof(T));
-		// TODO convert endianness
-		skip_array(a_arraylength, sizeof(T));
-		return ptr;
+		return static_cast<T*>(read_array(sizeof(T), a_modifier));
 	}
 
-	// read pointer type
+	// read array size
+	arraysize_t read_arraysize(size_t a_wire_size);
+
+	// read struct registered by REMO_STRUCT or REMO_FIXED_STRUCT
 	template<typename T>
-	void copy_to_ptr(T a_dest, size_t a_arraylength)
+	T read_struct(uint8_t a_wire_size)
 	{
-		uint8_t* p = reinterpret_cast<unsigned char*>(a_dest);
-		// read actual bytes
-		for (size_t i = 0; i < a_arraylength; i++) {
-			LITTLE_ENDIAN_FOR(j, sizeof(*a_dest)) {
-				p[j] = read<uint8_t>();
-			} // end for
-		} // end for
-	}	
+		const size_t length = read_struct_length(a_wire_size);
+		T value = T();
+		read_struct(value, length, std::integral_constant<bool, StructInfo<T>::is_fixed>());
+		return value;
+	}
+
+	// read value of a type known at compile time. the type id must have been
+	// read and checked by the caller
+	template<typename T>
+	T read_static(uint8_t a_modifier)
+	{
+		return read_static(type_tag<T>(), a_modifier);
+	}
 
-	// read string
-	const char* read_cstr()
+	// read string. the wire size is the one of the length, zero if the
+	// string is NUL-terminated only. o_length excludes the terminator
+	const char* read_cstr(uint8_t a_wire_size, size_t& o_length);
+	const char* read_cstr(uint8_t a_wire_size)
 	{
-		const char* str = (const char*)m_buffer.access_read(m_offset, 1);
-		// forward until NUL byte
-		while (read<uint8_t>()) {};
-		return str;
+		size_t length = 0;
+		return read_cstr(a_wire_size, length);
 	}
 
 	std::string to_string();
 	std::string format_value();
 	std::string format_call();
 	std::string format_result();
+	std::string format_query();
+	std::string format_info();
 
 	const std::string& get_function() { return m_function; }
+	bool has_function_id() const { return m_has_function_id; }
+	uint32_t get_function_id() const { return m_function_id; }
 	const ArgList& get_args() const { return m_args; }
 
 protected:
+	// trivially copyable struct, copied as a whole
+	template<typename T>
+	void read_struct(T& o_value, size_t a_length, std::true_type /* fixed */)
+	{
+		check_struct_size(sizeof(T), a_length);
+		std::memcpy(&o_value, consume(sizeof(T)), sizeof(T));
+	}
+
+	// struct read field by field
+	template<typename T>
+	void read_struct(T& o_value, size_t a_length, std::false_type /* fixed */)
+	{
+		typedef decltype(StructInfo<T>::fields()) Fields;
+		const size_t start = m_offset;
+		read_fields(o_value, StructInfo<T>::fields(), 
+			make_index_sequence<std::tuple_size<Fields>::value>());
+		check_struct_size(m_offset - start, a_length);
+	}
+
+	template<typename T, typename Fields, size_t... Is>
+	void read_fields(T& o_value, const Fields& a_fields, index_sequence<Is...>)
+	{
+		// NOTE: braced initialization guarantees left-to-right evaluation order
+		int dummy[] = { 0,(read_field(o_value.*std::get<Is>(a_fields)),0)... };
+		(void)dummy;
+	}
+
+	template<typename F>
+	void read_field(F& o_field)
+	{
+		uint8_t modifier = 0;
+		check_param_type(read_type(modifier), TypeInfo<F>::id());
+		o_field = read_static<F>(modifier);
+	}
+
+	size_t read_struct_length(size_t a_wire_size);
+	void check_struct_size(size_t a_actual, size_t a_expected) const;
+
 	void check_param_type(TypeId a_actual_type, TypeId a_expected_type) const;
 	void check_result_packet(PacketType a_packet_type) const;
+	void read_function_name();
+	void bad_wire_size(size_t a_wire_size, size_t a_value_size) const;
+
+	size_t check_array_length(size_t a_count, size_t a_item_size) const;
+	const uint8_t* access_array(size_t a_count, size_t a_item_size);
+	void* read_array(size_t a_item_size, uint8_t a_modifier = 0);
+	const uint8_t* access_delta_array(size_t a_count, size_t a_item_size, size_t& o_data_size);
+	void* read_delta_array(size_t a_count, size_t a_item_size);
+	void read_outarray(TypeId a_expected_type, void* a_dest, size_t a_count, size_t a_item_size);
+	std::string format_array(TypeId a_type, uint8_t a_modifier);
+
+private:
+	//! helper type to select read_static() overloads
+	template<typename T> struct type_tag {};
+
+	template<typename T>
+	T read_static(type_tag<T>, uint8_t a_modifier) { return read_static_value<T>(a_modifier, is_struct<T>()); }
+	template<typename T>
+	T read_static_value(uint8_t a_modifier, std::false_type /* struct */) { return read_value<T>(a_modifier); }
+	template<typename T>
+	T read_static_value(uint8_t a_modifier, std::true_type /* struct */) { return read_struct<T>(a_modifier); }
+	template<typename T>
+	struct_ref<T> read_static(type_tag<struct_ref<T>>, uint8_t)
+	{
+		// the struct follows its pointer type
+		uint8_t modifier = 0;
+		check_param_type(read_type(modifier), TypeId::type_any);
+		return struct_ref<T>{ read_struct<typename std::remove_const<T>::type>(modifier) };
+	}
+	template<typename T>
+	T* read_static(type_tag<T*>, uint8_t a_modifier) { return read_ptr<T>(a_modifier); }
+	bool read_static(type_tag<bool>, uint8_t a_modifier) { return a_modifier != 0; }
+	const char* read_static(type_tag<const char*>, uint8_t a_modifier) { return read_cstr(a_modifier); }
+	std::string read_static(type_tag<std::string>, uint8_t a_modifier)
+	{
+		size_t length = 0;
+		const char* str = read_cstr(a_modifier, length);
+		return std::string(str, length);
+	}
+#if REMO_HAS_STRING_VIEW
+	std::string_view read_static(type_tag<std::string_view>, uint8_t a_modifier)
+	{
+		size_t length = 0;
+		const char* str = read_cstr(a_modifier, length);
+		return std::string_view(str, length);
+	}
+#endif
+	arraysize_t read_static(type_tag<arraysize_t>, uint8_t a_modifier) { return read_arraysize(a_modifier); }
 
 private:
 	std::string m_function;
+	//! function id, if transmitted instead of the name
+	bool m_has_function_id = false;
+	uint32_t m_function_id = 0;
 	ArgList m_args;
+	//! array size received for the next pointer
+	bool m_has_arraysize = false;
+	arraysize_t m_arraysize = {};
+	//! array size passed by the caller for the next "out" parameter
+	bool m_has_outparam_arraysize = false;
+	arraysize_t m_outparam_arraysize = {};
 };
 
+//------------------------------------------------------------------------------
+// template specializations
+//------------------------------------------------------------------------------
+//
+//! read double value. the modifier is either the wire size, or the wire
+//! size combined with a compact floating point encoding
+template<>
+inline double BinaryReader::read_value<double>(size_t a_modifier)
+{
+	const size_t wire_size = a_modifier & 0xF;
+	switch (a_modifier & modifier_mask) {
+	case modifier_double_reversed:
+		if (wire_size <= sizeof(double)) {
+			return compact_value<double>(compact_reverse(
+				compact_load(consume(wire_size), wire_size), sizeof(double)));
+		}
+		break;
+	case modifier_double_as_float:
+		if (wire_size <= sizeof(float)) {
+			return compact_value<float>(compact_reverse(
+				compact_load(consume(wire_size), wire_size), sizeof(float)));
+		}
+		break;
+	}
+	// plain encoding, otherwise malformed
+	if (a_modifier > sizeof(double)) {
+		bad_wire_size(a_modifier, sizeof(double));
+	}
+	return compact_value<double>(compact_load(consume(a_modifier), a_modifier));
+}
+
+//------------------------------------------------------------------------------
+//
+//! read float value. counterpart of the above
+template<>
+inline float BinaryReader::read_value<float>(size_t a_modifier)
+{
+	const size_t wire_size = a_modifier & 0xF;
+	if ((a_modifier & modifier_mask) == modifier_float_reversed && wire_size <= sizeof(float)) {
+		return compact_value<float>(compact_reverse(
+			compact_load(consume(wire_size), wire_size), sizeof(float)));
+	}
+	// plain encoding, otherwise malformed
+	if (a_modifier > sizeof(float)) {
+		bad_wire_size(a_modifier, sizeof(float));
+	}
+	return compact_value<float>(compact_load(consume(a_modifier), a_modifier));
+}
+
 //------------------------------------------------------------------------------
 	} // end namespace trans
 } // end namespace remo
@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+#include "reader.h"
+#include "writer.h"
+#include "l0_system/types.h"
+//
+// C++
+#include <tuple>
+#include <type_traits>
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace trans {
+//------------------------------------------------------------------------------
+
+/**
+ * User-defined structs
+ *
+ * Structs are transmitted as type_any, with the wire size of their length in
+ * the upper nibble of the type info byte, followed by the length and the
+ * contents. The length allows receivers that do not know the struct to skip it.
+ * Pointers to structs are transmitted as their pointer type, followed by
+ * the struct. Mutable pointers are written back like arrays.
+ *
+ * Structs are registered in the global namespace by either
+ *
+ *   REMO_STRUCT(Point, &Point::x, &Point::y);
+ *
+ * which transmits the listed fields one by one, each in its compact encoding, or
+ *
+ *   REMO_FIXED_STRUCT(Sample);
+ *
+ * which copies a trivially copyable struct as a whole. Both sides then need
+ * to agree on its memory layout, including byte order and padding.
+ *
+ * Only the length is checked by the receiver, the type must be known.
+ */
+
+//------------------------------------------------------------------------------
+// function implementations
+//------------------------------------------------------------------------------
+//
+//! decode struct from its encoding, as referred to by a typed value of type_any
+template<typename T>
+T decode_struct(const uint8_t* a_encoded)
+{
+	// the encoding has been checked to be within the packet when it was read
+	const size_t wire_size = a_encoded[0] >> 4;
+	const size_t size = 1 + wire_size + static_cast<size_t>(compact_load(a_encoded + 1, wire_size));
+	RBuffer buffer;
+	buffer.init(const_cast<uint8_t*>(a_encoded), size, size);
+
+	BinaryReader reader(buffer);
+	uint8_t modifier = 0;
+	reader.read_type(modifier);
+	return reader.read_struct<T>(modifier);
+}
+
+//------------------------------------------------------------------------------
+	} // end namespace trans
+} // end namespace remo
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// macros
+//------------------------------------------------------------------------------
+//
+//! type information common to all structs
+#define REMO_STRUCT_TYPE_INFO(Type) \
+	template<> struct TypeInfo<Type> { static TypeId id() { return type_any; } }; \
+	template<> struct TypeInfo<Type*> { static TypeId id() { return type_any_ptr; } }; \
+	template<> struct TypeInfo<const Type*> { static TypeId id() { return type_any_cptr; } }; \
+	template<> inline Type TypedValue::get<Type>() const { \
+		return trans::decode_struct<Type>(get_any()); \
+	}
+
+//! register a struct whose fields, given as member pointers, are transmitted one by one
+#define REMO_STRUCT(Type, ...) \
+	namespace remo { \
+		template<> struct StructInfo<Type> { \
+			static const bool is_struct = true; \
+			static const bool is_fixed = false; \
+			static decltype(std::make_tuple(__VA_ARGS__)) fields() { \
+				return std::make_tuple(__VA_ARGS__); \
+			} \
+		}; \
+		REMO_STRUCT_TYPE_INFO(Type) \
+	} \
+	static_assert(true, "")
+
+//! register a trivially copyable struct that is transmitted as a whole
+#define REMO_FIXED_STRUCT(Type) \
+	namespace remo { \
+		static_assert(std::is_trivially_copyable<Type>::value, \
+			#Type " must be trivially copyable"); \
+		template<> struct StructInfo<Type> { \
+			static const bool is_struct = true; \
+			static const bool is_fixed = true; \
+			static std::tuple<> fields() { return std::tuple<>(); } \
+		}; \
+		REMO_STRUCT_TYPE_INFO(Type) \
+	} \
+	static_assert(true, "")
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------
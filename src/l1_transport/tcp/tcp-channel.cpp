@@ -15,12 +15,14 @@
 //
 // project
 #include "tcp-transport.h"
-#include "l1_transport/writer.h"
+#include "l0_system/endianness.h"
 #include "utils/logger.h"
 #include "utils/contracts.h"
+#include "utils/small_vector.h"
 //
 // C++ 
-#include <cstring> // memcpy
+#include <algorithm>
+#include <cstddef> // max_align_t
 //
 // system
 //
@@ -34,6 +36,29 @@ namespace remo {
 static Logger logger("TcpChannel");
 
 
+//------------------------------------------------------------------------------	
+// constants
+//------------------------------------------------------------------------------	
+//
+//! offset in the packet buffer at which data is received. chosen such that the
+//! payload following the framing header is aligned, allowing in-place array access
+const size_t RX_OFFSET = alignof(std::max_align_t) - sizeof(uint32_t);
+
+//! alignment a payload needs for in-place access to arrays of any item type
+const size_t RX_ALIGNMENT = sizeof(uint64_t);
+
+
+//------------------------------------------------------------------------------	
+// helpers
+//------------------------------------------------------------------------------	
+//
+//! true if the payload of the frame starting at the given address is aligned
+static bool is_rx_aligned(const uint8_t* a_frame)
+{
+	return ((reinterpret_cast<uintptr_t>(a_frame) + sizeof(uint32_t)) & (RX_ALIGNMENT - 1)) == 0;
+}
+
+
 //------------------------------------------------------------------------------
 // class implementation
 //------------------------------------------------------------------------------	
@@ -45,11 +70,30 @@ using namespace sys;
 TcpChannel::TcpChannel(TcpTransport* a_transport, Socket&& a_socket, bool a_incoming):
 	Channel(a_transport, a_socket.get_log_name()),
 	m_socket(std::move(a_socket)),
-	m_rx_packet()
+	m_thread(nullptr),
+	m_rx_packet(),
+	m_tx_mutex(),
+	m_tx_queue(),
+	m_tx_offset(0),
+	m_tx_bytes(0),
+	m_tx_max_packets(a_transport->settings.send_queue_packets),
+	m_tx_max_bytes(a_transport->settings.send_queue_bytes),
+	m_tx_waiting(false),
+	m_tx_coalesce(std::chrono::microseconds(a_transport->settings.send_coalesce_us)),
+	m_tx_coalesce_bytes(a_transport->settings.send_coalesce_bytes),
+	m_tx_gathering(false),
+	m_tx_deadline(),
+	m_tx_scheduled(false)
 {
 	// set callbacks
 	m_socket.on_receive_ready(std::bind(&TcpChannel::receive_chunk, this));
+	m_socket.on_send_ready(std::bind(&TcpChannel::send_queued, this));
 	m_socket.on_disconnected(std::bind(&TcpChannel::closed, this));
+	// Unix sockets send without delay anyway
+	if (a_transport->settings.tcp_nodelay &&
+		m_socket.get_socket_addr().get_family() != AddrFamily::Unix) {
+		m_socket.set_nodelay(true);
+	}
 	// TODO handle this on TX ready?
 	if (a_incoming) {
 		// enable non-blocking mode
@@ -75,11 +119,11 @@ void TcpChannel::prepare_to_send(packet_ptr& a_packet)
 	 * NOTE: subclasses that do their own framing (e.g. WebSockets)
 	 * are not expected to call this.
 	 */
-	Writer writer(a_packet->get_header());
+	LBuffer& header = a_packet->get_header();
 
 	// write payload size
-	uint32_t payload_size = static_cast<uint32_t>(a_packet->get_payload().get_size());
-	writer.write<uint32_t>(payload_size);
+	uint32_t payload_size = static_cast<uint32_t>(a_packet->get_payload().get_total_size());
+	sys::set_le(static_cast<uint32_t*>(header.grow(sizeof(payload_size))), payload_size);
 }
 
 //------------------------------------------------------------------------------	
@@ -92,42 +136,224 @@ void TcpChannel::prepare_to_receive(packet_ptr& a_packet)
 
 //------------------------------------------------------------------------------	
 //
-void TcpChannel::do_send(packet_ptr& a_packet)
+bool TcpChannel::do_send(packet_ptr& a_packet)
 {
-	const uint8_t* data = a_packet->get_data();
-	size_t size = a_packet->get_size();
+	const size_t size = a_packet->get_header().get_size() + a_packet->get_payload().get_total_size();
+
+	std::lock_guard<std::mutex> lock(m_tx_mutex);
+	if (!m_tx_queue.empty()) {
+		/**
+		 * packets are waiting already, and our thread sends them as soon as the socket
+		 * is ready. the packet must go after them, as long as there is room. a single
+		 * packet is always taken, whatever its size, so that the limits cannot prevent
+		 * sending at all.
+		 */
+		if (m_tx_queue.size() >= m_tx_max_packets || m_tx_bytes + size > m_tx_max_bytes) {
+			// verbose only, as this is expected under backpressure, and up to the caller
+			REMO_VERB("send queue full (%zu packets, %zu bytes)", 
+				m_tx_queue.size(), m_tx_bytes);
+			return false;
+		}
+		m_tx_queue.push_back(std::move(a_packet));
+		m_tx_bytes += size;
+		if (m_tx_coalesce.count() > 0 && !m_tx_gathering) {
+			/**
+			 * with packets already queued, more are likely to follow, so gather them
+			 * to be sent at once. our thread sends them when the time is up, even if
+			 * the socket is ready before.
+			 */
+			m_tx_gathering = true;
+			m_tx_deadline = std::chrono::steady_clock::now() + m_tx_coalesce;
+			if (!m_tx_scheduled) {
+				m_tx_scheduled = true;
+				m_thread->send_later(this);
+			}
+		}
+		// gathered enough to be worth a system call, or as much as it can take?
+		if (m_tx_gathering && !m_tx_waiting && is_tx_batch_full()) {
+			flush_tx_queue();
+		}
+		return true;
+	}
+
+	m_tx_queue.push_back(std::move(a_packet));
+	m_tx_bytes = size;
+
+	// nothing in the way, try to send it right away. coalescing never delays
+	// a packet on its own
+	flush_tx_queue();
+	return true;
+}
+
+//------------------------------------------------------------------------------	
+//
+bool TcpChannel::is_tx_batch_full() const
+{
+	return m_tx_bytes >= m_tx_coalesce_bytes || m_tx_queue.size() >= Socket::MAX_IOVECS;
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpChannel::flush_tx_queue()
+{
+	m_tx_gathering = false;
+
+	try {
+		if (send_tx_queue()) {
+			return;
+		}
+	} catch (...) {
+		// e.g. connection reset. the packets are lost either way
+		m_tx_queue.clear();
+		m_tx_offset = m_tx_bytes = 0;
+		throw;
+	}
+
+	// the rest is sent when the socket is ready, instead of blocking the caller
+	REMO_VERB("socket not ready for sending (e.g. tx buffer full), %zu bytes queued", m_tx_bytes);
+	if (!m_tx_waiting) {
+		m_tx_waiting = true;
+		m_thread->notify_send_ready(this, true);
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+bool TcpChannel::send_gathered(std::chrono::steady_clock::time_point a_now, 
+	std::chrono::steady_clock::time_point& o_deadline)
+{
+	std::lock_guard<std::mutex> lock(m_tx_mutex);
+	if (m_tx_gathering && a_now < m_tx_deadline) {
+		o_deadline = m_tx_deadline;
+		return false;
+	}
+
+	// sent by the sender meanwhile, if not gathering anymore
+	m_tx_scheduled = false;
+	if (m_tx_gathering) {
+		try {
+			flush_tx_queue();
+		} catch (const std::exception& e) {
+			// no one to report to, receiving will notice if the connection is gone
+			REMO_WARN("dropping gathered packets: %s", e.what());
+		}
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpChannel::send_queued()
+{
+	std::lock_guard<std::mutex> lock(m_tx_mutex);
+	if (m_tx_gathering && std::chrono::steady_clock::now() < m_tx_deadline &&
+		!is_tx_batch_full()) {
+		// still gathering, they are sent when the time is up
+		if (m_tx_waiting) {
+			m_tx_waiting = false;
+			m_thread->notify_send_ready(this, false);
+		}
+		return;
+	}
+
+	m_tx_gathering = false;
+	bool done = true;
+	try {
+		done = send_tx_queue();
+	} catch (const std::exception& e) {
+		// no one to report to, receiving will notice if the connection is gone
+		REMO_WARN("dropping %zu queued packets: %s", m_tx_queue.size(), e.what());
+		m_tx_queue.clear();
+		m_tx_offset = m_tx_bytes = 0;
+	}
+	if (done && m_tx_waiting) {
+		m_tx_waiting = false;
+		m_thread->notify_send_ready(this, false);
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+bool TcpChannel::is_send_pending()
+{
+	std::lock_guard<std::mutex> lock(m_tx_mutex);
+	return m_tx_waiting;
+}
+
+//------------------------------------------------------------------------------	
+//
+bool TcpChannel::send_tx_queue()
+{
+	while (!m_tx_queue.empty()) {
+		/**
+		 * send header and payload of as many queued packets as possible at once,
+		 * followed by further payload segments if any, to avoid a system call per
+		 * packet or segment. the first one may have been sent in part already.
+		 */
+		utils::SmallVector<Socket::IOVec, Socket::MAX_IOVECS> buffers;
+		size_t skip = m_tx_offset;
+		size_t total = 0;
+		for (const packet_ptr& packet : m_tx_queue) {
+			const Buffer& payload = packet->get_payload();
+			Socket::IOVec first = { packet->get_data(), 
+				packet->get_header().get_size() + payload.get_size() };
+			for (const Buffer* segment = &payload; segment; segment = segment->get_next()) {
+				Socket::IOVec buffer = segment == &payload ? first : 
+					Socket::IOVec{ segment->get_data(), segment->get_size() };
+				if (skip >= buffer.size) {
+					// sent already, or empty
+					skip -= buffer.size;
+					continue;
+				}
+				buffer.data = static_cast<const uint8_t*>(buffer.data) + skip;
+				buffer.size -= skip;
+				skip = 0;
+				if (buffers.size() == Socket::MAX_IOVECS) {
+					break;
+				}
+				buffers.push_back(buffer);
+				total += buffer.size;
+			}
+			if (buffers.size() == Socket::MAX_IOVECS) {
+				break;
+			}
+		}
 
-	/**
-	 * we may not be able to send the whole packet, e.g. because the send buffer is full.
-	 * we therefore loop until all bytes are sent, waiting on the socket to become send
-	 * ready to avoid burning CPU cycles.
-	 * 
-	 * Note that we cannot just give up and return after sending an incomplete packet,
-	 * as this may mess up the receiver side.
-	 */ 
-	while (size > 0) {
-		
 		// send data over socket
 		size_t bytes_sent = 0;
-		Socket::IOResult result = m_socket.send(data, size, &bytes_sent);
+		Socket::IOResult result = m_socket.send(buffers.data(), buffers.size(), &bytes_sent);
 		
 		// consistency checks
 		REMO_ASSERT(result != Socket::IOResult::PeerShutdown,
 			"should not happen for send");
-		REMO_ASSERT(bytes_sent <= size,
-			"sent more bytes than in buffer");
-		
-		// wait if necessary
-		if (result == Socket::IOResult::WouldBlock) {
-			REMO_WARN("socket not ready for sending (e.g. tx buffer full), waiting for it to become ready...");
-			m_socket.wait_send_ready();
-			REMO_WARN("socket ready for sending");
+		REMO_ASSERT(bytes_sent <= total,
+			"sent more bytes than in buffers");
+
+		consume_tx_queue(bytes_sent);
+		if (result == Socket::IOResult::WouldBlock || bytes_sent < total) {
+			// socket buffer is full
+			return m_tx_queue.empty();
 		}
-		
-		// determine remaining buffer to send
-		data += bytes_sent;
-		size -= bytes_sent;
 	}
+	return true;
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpChannel::consume_tx_queue(size_t a_size)
+{
+	m_tx_bytes -= a_size;
+	a_size += m_tx_offset;
+	while (!m_tx_queue.empty()) {
+		const packet_ptr& packet = m_tx_queue.front();
+		const size_t size = packet->get_header().get_size() + packet->get_payload().get_total_size();
+		if (a_size < size) {
+			break;
+		}
+		a_size -= size;
+		m_tx_queue.pop_front();
+	}
+	m_tx_offset = a_size;
 }
 
 //------------------------------------------------------------------------------	
@@ -137,20 +363,24 @@ void TcpChannel::receive_chunk()
 	REMO_PRECOND({
 		REMO_ASSERT(!is_closed(), 
 			"channel must not receive data while closed");
-		REMO_ASSERT(!m_rx_packet || m_rx_packet->get_size() <= m_rx_packet->get_buffer_size(),
-			"packet size must not exceed buffer size");
-	});
-	REMO_POSTCOND({
-		REMO_ASSERT(!m_rx_packet || m_rx_packet->get_size() <= m_rx_packet->get_buffer_size(),
-			"packet size must not exceed buffer size");
 	});
 
 	// allocate packet to be received if needed
-	prepare_rx_packet();
+	if (!prepare_rx_packet()) {
+		// data is left in the socket until packets are recycled
+		m_thread->receive_starved(this);
+		return;
+	}
 
-	// determine remaining buffer to receive
-	uint8_t* data = m_rx_packet->get_data() + m_rx_packet->get_size();
-	size_t size = m_rx_packet->get_buffer_size() - m_rx_packet->get_size();
+	// determine remaining buffer to receive. large packets continue in further
+	// segments, such that they need not be received into a single buffer
+	RBuffer& payload = m_rx_packet->get_payload();
+	Buffer* segment = payload.get_tail();
+	if (segment->get_size() == segment->get_capacity()) {
+		segment = payload.extend();
+	}
+	uint8_t* data = segment->get_data() + segment->get_size();
+	size_t size = segment->get_capacity() - segment->get_size();
 	
 	// receive data from socket
 	size_t bytes_received = 0;
@@ -162,15 +392,7 @@ void TcpChannel::receive_chunk()
 
 	// handle peer shutdown
 	if (result == Socket::IOResult::PeerShutdown) {
-		// did we receive an incomplete packet?
-		if (m_rx_packet->get_size() > 0) {
-			// yes -> discard it
-			REMO_WARN("peer disconnected after sending incomplete packet (%d bytes), discarding it",
-				m_rx_packet->get_size());
-			m_rx_packet.reset();	
-		}
-		// we're closed now
-		closed();
+		receive_shutdown();
 		return;
 	}
 
@@ -181,49 +403,193 @@ void TcpChannel::receive_chunk()
 	}
 
 	// update packet size
-	m_rx_packet->get_payload().grow(bytes_received);
+	payload.grow(bytes_received);
+	fit_rx_packet();
 
-	// packet complete?
-	const size_t actual_size = determine_packet_size(m_rx_packet);
-	if (actual_size == PACKET_INCOMPLETE) {
-		// not yet
-		return;
+	if (!deliver_rx_packets()) {
+		// the rest is delivered once packets are recycled
+		m_thread->receive_starved(this);
 	}
+}
 
-	// consistency checks
-	REMO_ASSERT(actual_size <= m_rx_packet->get_size(),
-		"actual packet size must not exceed received size");
+//------------------------------------------------------------------------------	
+//
+void TcpChannel::received_chunk(packet_ptr& a_packet, size_t a_size)
+{
+	REMO_PRECOND({
+		REMO_ASSERT(!is_closed(), 
+			"channel must not receive data while closed");
+		REMO_ASSERT(a_size <= a_packet->get_payload().get_capacity(),
+			"received more bytes than buffer can hold");
+	});
+
+	if (!m_rx_packet) {
+		// nothing pending -> the packet the data was received into becomes the rx packet
+		m_rx_packet = std::move(a_packet);
+		m_rx_packet->get_payload().grow(a_size);
+		fit_rx_packet();
+	} else {
+		// otherwise append the data to it, but complete the framing header
+		// first, so that a larger size class can still be chosen
+		const uint8_t* data = a_packet->get_payload().get_data();
+		const uint32_t header_size = sizeof(uint32_t);
+		RBuffer& payload = m_rx_packet->get_payload();
+		if (!payload.get_next() && payload.get_size() < header_size) {
+			const size_t size = std::min(a_size, header_size - payload.get_size());
+			payload.append(data, size);
+			data += size;
+			a_size -= size;
+			fit_rx_packet();
+		}
+		m_rx_packet->get_payload().append(data, a_size);
+		fit_rx_packet();
+	}
+
+	if (!deliver_rx_packets()) {
+		// the rest is delivered once packets are recycled
+		m_thread->receive_starved(this);
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpChannel::receive_shutdown()
+{
+	// did we receive an incomplete packet?
+	if (m_rx_packet && m_rx_packet->get_size() > 0) {
+		// yes -> discard it
+		REMO_WARN("peer disconnected after sending incomplete packet (%d bytes), discarding it",
+			m_rx_packet->get_size());
+	}
+	m_rx_packet.reset();
+	// we're closed now
+	closed();
+}
+
+//------------------------------------------------------------------------------	
+//
+bool TcpChannel::deliver_rx_packets()
+{
+	// deliver all complete packets received, without waiting for the socket again
+	while (m_rx_packet) {
+		// packet complete?
+		const size_t actual_size = determine_packet_size(m_rx_packet);
+		if (actual_size == PACKET_INCOMPLETE) {
+			// not yet
+			return true;
+		}
+
+		// consistency checks
+		REMO_ASSERT(actual_size <= m_rx_packet->get_size(),
+			"actual packet size must not exceed received size");
 
-	// we have a complete packet!
-	packet_ptr complete_packet = std::move(m_rx_packet);
-	REMO_ASSERT(!m_rx_packet,
-		"rx packet should be moved");
+		// we have a complete packet!
+		packet_ptr complete_packet = split_rx_packet(actual_size);
+		if (!complete_packet) {
+			// out of packets to continue in
+			return false;
+		}
+		receive(complete_packet);
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------	
+//
+packet_ptr TcpChannel::split_rx_packet(size_t a_size)
+{
+	/**
+	 * packets following others of the same read rarely start aligned, so that
+	 * the reader would have to copy their arrays. such a packet is copied to a
+	 * fresh packet instead, which only costs its own bytes rather than those of
+	 * all packets after it. without a fresh packet, it is handed on as it is.
+	 */
+	packet_ptr copy;
+	if (!is_rx_aligned(m_rx_packet->get_payload().get_data())) {
+		copy = copy_rx_packet(a_size);
+	}
 
 	// are there any excess bytes?
-	size_t excess_bytes = complete_packet->get_size() - actual_size;
-	if (excess_bytes > 0) {
-		// yes -> they belong to the next packet we will receive, copy them over
-
-		// allocate next packet to be received
-		prepare_rx_packet();
-		REMO_ASSERT(excess_bytes <= m_rx_packet->get_buffer_size(),
-			"excess packet bytes must not exceed packet buffer size");
-		
-		// show warning, because this is not zero-copy anymore :(
-		REMO_WARN("received consecutive packets on socket read, need to copy %d bytes",
-			excess_bytes);
-		
-		// copy excess bytes to next packet
-		m_rx_packet->get_payload().set_size(excess_bytes);			
-		std::memcpy(m_rx_packet->get_data(), 
-			complete_packet->get_data() + actual_size, excess_bytes);
-		
-		// truncate excess bytes from complete packet
-		complete_packet->get_payload().set_size(actual_size);
+	if (m_rx_packet->get_size() == a_size) {
+		// no -> the whole packet is complete
+		if (copy) {
+			m_rx_packet.reset();
+			return copy;
+		}
+		return std::move(m_rx_packet);
+	}
+
+	/**
+	 * yes -> they belong to the next packets. hand on the complete one as a slice
+	 * of the rx packet, which keeps receiving after it. the bytes stay where they
+	 * were received, and the rx packet is recycled when all slices are.
+	 * any packet to continue in is taken first, as the bytes would be lost otherwise.
+	 */
+	RBuffer& payload = m_rx_packet->get_payload();
+	if (a_size <= payload.get_size()) {
+		packet_ptr slice = copy ? packet_ptr() : m_thread->take_slice();
+		if (copy || slice) {
+			// framing headers need to be contiguous, so continue in another packet
+			// if there is no room for one
+			packet_ptr next;
+			if (payload.get_capacity() - a_size < sizeof(uint32_t)) {
+				next = take_rx_packet();
+				if (!next) {
+					return nullptr;
+				}
+			}
+			if (slice) {
+				slice->slice(*m_rx_packet, a_size);
+			}
+			m_rx_packet->drop_front(a_size);
+			if (next) {
+				move_rx_bytes(next, 0);
+			}
+			fit_rx_packet();
+			return copy ? std::move(copy) : std::move(slice);
+		}
+	}
+
+	// otherwise, copy the excess bytes to the next packet
+	packet_ptr next = take_rx_packet();
+	if (!next) {
+		return nullptr;
+	}
+	REMO_WARN("received consecutive packets on socket read, need to copy %zu bytes",
+		m_rx_packet->get_size() - a_size);
+	packet_ptr complete_packet = move_rx_bytes(next, a_size);
+	if (copy) {
+		// the previous rx packet is no longer needed
+		return copy;
+	}
+	complete_packet->get_payload().truncate(a_size);
+	return complete_packet;
+}
+
+//------------------------------------------------------------------------------	
+//
+packet_ptr TcpChannel::copy_rx_packet(size_t a_size)
+{
+	// only if it fits into a single packet, as it would not be contiguous otherwise
+	if (a_size + RX_OFFSET > PacketPool::get_buffer_size(PacketSize::large)) {
+		return nullptr;
+	}
+	packet_ptr packet = take_rx_packet(a_size);
+	if (packet) {
+		m_rx_packet->get_payload().copy_out(0, packet->get_payload().grow(a_size), a_size);
 	}
+	return packet;
+}
 
-	// done
-	receive(complete_packet);
+//------------------------------------------------------------------------------	
+//
+packet_ptr TcpChannel::move_rx_bytes(packet_ptr& a_next, size_t a_offset)
+{
+	packet_ptr packet = std::move(m_rx_packet);
+	m_rx_packet = std::move(a_next);
+	packet->get_payload().copy_to(a_offset, m_rx_packet->get_payload());
+	fit_rx_packet();
+	return packet;
 }
 
 //------------------------------------------------------------------------------	
@@ -242,6 +608,13 @@ void TcpChannel::connect(const SockAddr& a_addr)
 //
 void TcpChannel::close()
 {
+	// packets not sent yet cannot be sent anymore
+	{
+		std::lock_guard<std::mutex> lock(m_tx_mutex);
+		m_tx_queue.clear();
+		m_tx_offset = m_tx_bytes = 0;
+		m_tx_gathering = false;
+	}
 	// enter 'closing' state
 	enter_state(State::closing);
 	// shutdown socket. This will cancel any pending poll() calls
@@ -250,15 +623,75 @@ void TcpChannel::close()
 
 //------------------------------------------------------------------------------	
 //
-void TcpChannel::prepare_rx_packet()
+bool TcpChannel::prepare_rx_packet()
 {
 	// allocate packet if needed
 	if (!m_rx_packet) {
-		// get a fresh packet from our transport
-		m_rx_packet = get_transport()->take_packet();
-		// use whole buffer for payload, we'll determine header later
-		m_rx_packet->set_header_capacity(0);
+		m_rx_packet = take_rx_packet();
+	}
+	return m_rx_packet != nullptr;
+}
+
+//------------------------------------------------------------------------------	
+//
+packet_ptr TcpChannel::take_rx_packet(size_t a_payload_size)
+{
+	// get a fresh packet from our thread. we must not wait for one, as this
+	// would stall all other channels of the thread as well
+	packet_ptr packet = m_thread->try_take_packet(PacketPool::get_size_class(a_payload_size));
+	if (packet) {
+		init_rx_packet(*packet);
+	}
+	return packet;
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpChannel::init_rx_packet(Packet& a_packet)
+{
+	// use whole buffer for payload, we'll determine header later
+	a_packet.set_header_capacity(RX_OFFSET);
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpChannel::fit_rx_packet()
+{
+	/**
+	 * packets are received into one of the smallest size class first, as their
+	 * size is not known before the framing header is received. once it is, larger
+	 * packets are moved to a packet of their class, which is cheap as the bytes
+	 * received so far fit into the small one. the same goes for a packet that
+	 * follows others in the rx packet, but does not fit into the rest of it.
+	 * payloads exceeding even the largest class, or for which no packet with
+	 * more room is available, continue in segments.
+	 */
+	RBuffer& payload = m_rx_packet->get_payload();
+	uint32_t payload_size = 0;
+	if (payload.get_next() || payload.get_size() < sizeof(payload_size)) {
+		// too late or too early
+		return;
+	}
+
+	// does it fit? (the header is little-endian and may sit unaligned)
+	payload_size = sys::get_le_ua(reinterpret_cast<const uint32_t*>(payload.get_data()));
+	const size_t packet_size = static_cast<size_t>(payload_size) + sizeof(payload_size);
+	if (packet_size <= payload.get_capacity()) {
+		// yes -> done
+		return;
+	}
+
+	// no -> move it to one with more room, if any
+	packet_ptr packet = m_thread->try_take_packet(PacketPool::get_size_class(packet_size));
+	if (!packet) {
+		return;
+	}
+	init_rx_packet(*packet);
+	if (packet->get_payload().get_capacity() <= payload.get_capacity()) {
+		return;
 	}
+	packet->get_payload().append(payload.get_data(), payload.get_size());
+	m_rx_packet = std::move(packet);
 }
 
 //------------------------------------------------------------------------------
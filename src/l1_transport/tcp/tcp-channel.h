@@ -18,7 +18,9 @@
 #include "l0_system/socket.h"
 //
 // C++ 
-//
+#include <chrono>
+#include <deque>
+#include <mutex>
 //
 //------------------------------------------------------------------------------
 namespace remo {
@@ -32,7 +34,7 @@ using namespace sys;
 //------------------------------------------------------------------------------
 //
 class TcpTransport;
-
+class TcpThread;
 
 //------------------------------------------------------------------------------
 // class declaration
@@ -51,13 +53,15 @@ public:
 	virtual void close() override;
 
 	Socket* get_socket() { return &m_socket; }
+	//! thread handling this channel, once added to one. e.g. to post work to
+	TcpThread* get_thread() { return m_thread; }
 
 // protected member functions
 protected:
 	//! prepares a packet to be sent over this channel
 	virtual void prepare_to_send(packet_ptr& a_packet) override;
-	//! send a packet over this channel
-	virtual void do_send(packet_ptr& a_packet) override;
+	//! send a packet over this channel, or queue it if the socket is not ready
+	virtual bool do_send(packet_ptr& a_packet) override;
 
 	//! prepares a packet to be received from this channel
 	virtual void prepare_to_receive(packet_ptr& a_packet) override;	
@@ -68,19 +72,95 @@ protected:
 	//! connects the socket to the specified endpoint address
 	void connect(const SockAddr& a_addr);
 
+// protected member functions called by TcpThread
+protected:
+	friend class TcpThread;
+	//! called when added to the given thread, which it stays with
+	void set_thread(TcpThread* a_thread) { m_thread = a_thread; }
+	//! called when the socket is ready to send queued packets
+	void send_queued();
+	//! hand on all complete packets received so far. false if out of packets to
+	//! continue in, the rest is delivered when called again
+	bool deliver_rx_packets();
+	//! ensure rx packet is allocated. false if out of packets
+	bool prepare_rx_packet();
+	//! true if packets are waiting for the socket to be ready to send
+	bool is_send_pending();
+	//! called to send packets gathered once they are due. false if they are not
+	//! due yet at the given time, and sets the time at which they are
+	bool send_gathered(std::chrono::steady_clock::time_point a_now, 
+		std::chrono::steady_clock::time_point& o_deadline);
+
+// protected member functions called by TcpUring
+protected:
+	friend class TcpUring;
+	//! called with data received into the given packet on our behalf
+	void received_chunk(packet_ptr& a_packet, size_t a_size);
+	//! called when the peer has shut down the connection
+	void receive_shutdown();
+	//! prepare a packet to receive data into
+	static void init_rx_packet(Packet& a_packet);
+
 // private member functions
 private:
 	//! called when socket has data ready to receive
 	void receive_chunk();
-	//! ensure rx packet is allocated
-	void prepare_rx_packet();
+	//! get a fresh packet to receive into, with room for the given payload size,
+	//! or nullptr if out of packets
+	packet_ptr take_rx_packet(size_t a_payload_size = 0);
+	//! move rx packet to a larger size class if needed, once its size is known
+	void fit_rx_packet();
+	//! take the complete packet of the given size from the rx packet, or nullptr
+	//! if out of packets to continue in
+	packet_ptr split_rx_packet(size_t a_size);
+	//! copy the complete packet of the given size at the front of the rx packet
+	//! to a fresh one, or nullptr if out of packets
+	packet_ptr copy_rx_packet(size_t a_size);
+	//! continue receiving in the given fresh packet, copying the bytes of the rx
+	//! packet from the given offset on. returns the previous rx packet
+	packet_ptr move_rx_bytes(packet_ptr& a_next, size_t a_offset);
+	//! true if the packets gathered are worth a system call, or as many as it takes.
+	//! the tx mutex must be held
+	bool is_tx_batch_full() const;
+	//! send queued packets, and the rest when the socket is ready. the tx mutex must be held
+	void flush_tx_queue();
+	//! send as many queued packets as the socket takes. true if all were sent.
+	//! the tx mutex must be held
+	bool send_tx_queue();
+	//! remove the given number of bytes sent from the queue
+	void consume_tx_queue(size_t a_size);
 
 // private members
 private:
 	//! socket used for communication
 	Socket m_socket;
+	//! thread handling this channel, which also provides the packets received into
+	TcpThread* m_thread;
 	//! current packet in progress of being received
 	packet_ptr m_rx_packet;
+	//! guards the send queue, as any thread may send
+	std::mutex m_tx_mutex;
+	//! packets waiting for the socket to be ready to send, the first one possibly in part
+	std::deque<packet_ptr> m_tx_queue;
+	//! bytes of the first queued packet sent already
+	size_t m_tx_offset;
+	//! bytes queued, excluding those sent already
+	size_t m_tx_bytes;
+	//! limits of the send queue
+	size_t m_tx_max_packets;
+	size_t m_tx_max_bytes;
+	//! our thread has been asked to report when the socket is ready to send
+	bool m_tx_waiting;
+	//! gather packets sent while others are queued for up to this long, 0 if disabled
+	std::chrono::steady_clock::duration m_tx_coalesce;
+	//! send packets gathered right away once they amount to this many bytes,
+	//! or to as many packets as a single system call takes
+	size_t m_tx_coalesce_bytes;
+	//! queued packets are being gathered, to be sent at the deadline at the latest
+	bool m_tx_gathering;
+	std::chrono::steady_clock::time_point m_tx_deadline;
+	//! our thread keeps track of the deadline
+	bool m_tx_scheduled;
 };
 
 //------------------------------------------------------------------------------
@@ -19,6 +19,7 @@
 #include "utils/async.h"
 //
 // C++ 
+#include <algorithm>
 //
 //
 //------------------------------------------------------------------------------
@@ -29,6 +30,9 @@ namespace remo {
 //! logger instance
 static Logger logger("TcpTransport");
 
+//! how soon to retry receiving when out of packets to receive into
+static const std::chrono::microseconds STARVED_RETRY(1000);
+
 
 //------------------------------------------------------------------------------
 // class implementation
@@ -37,17 +41,42 @@ static Logger logger("TcpTransport");
 TcpTransport::TcpTransport(const Settings& a_settings):
 	Transport(a_settings),
 	settings(a_settings),
-	m_thread(this)
+	m_threads(),
+	m_sharded(false),
+	m_next_thread(0)
 {
-	m_thread.startup();
+	// the first thread always accepts connections, on the address specified
+	const size_t count = std::max<size_t>(settings.reactors, 1);
+	m_threads.emplace_back(new TcpThread(this, &settings.listen_addr));
+
+	// and the others too if they can share its port, which Unix sockets cannot
+	m_sharded = count > 1 && Socket::has_reuse_port() &&
+		settings.listen_addr.get_family() != AddrFamily::Unix;
+	const SockAddr listen_addr = m_threads[0]->get_listen_addr();
+	while (m_threads.size() < count) {
+		m_threads.emplace_back(new TcpThread(this, m_sharded ? &listen_addr : nullptr));
+	}
+	REMO_INFO("handling channels with %zu threads%s", count, 
+		m_sharded ? ", each accepting connections" : "");
+
+	for (auto& thread : m_threads) {
+		thread->startup();
+	}
 }
 
 //------------------------------------------------------------------------------	
 //
 TcpTransport::~TcpTransport()
 {
-	m_thread.shutdown();
-	m_thread.join();
+	for (auto& thread : m_threads) {
+		thread->shutdown();
+	}
+	for (auto& thread : m_threads) {
+		thread->join();
+	}
+	// delete channels while the packet pools of our threads are still there,
+	// as they may hold packets of them
+	remove_channels();
 }
 
 //------------------------------------------------------------------------------	
@@ -62,13 +91,13 @@ Channel* TcpTransport::connect(const std::string& a_endpoint)
 		a_endpoint.c_str(), addr.to_string().c_str());
 
 	// create new channel
-	TcpChannel* channel = new TcpChannel(this, Socket(SockProto::TCP), false);
+	TcpChannel* channel = new TcpChannel(this, Socket(SockProto::TCP, addr.get_family()), false);
 	// connect channel
 	channel->connect(addr);
 	// add to bookkeeping
 	add_channel(channel);
 	// listen on it
-	m_thread.add_channel(channel);
+	get_next_thread()->add_channel(channel);
 	
 	return channel;
 }
@@ -78,52 +107,110 @@ Channel* TcpTransport::connect(const std::string& a_endpoint)
 void TcpTransport::closed(Channel* a_channel)
 {
 	// stop listening on this channel
-	m_thread.remove_channel((TcpChannel*)a_channel);
+	TcpChannel* channel = static_cast<TcpChannel*>(a_channel);
+	channel->get_thread()->remove_channel(channel);
+}
+
+//------------------------------------------------------------------------------	
+//
+TcpThread* TcpTransport::get_thread_for_accepted(TcpThread* a_acceptor)
+{
+	return m_sharded ? a_acceptor : get_next_thread();
+}
+
+//------------------------------------------------------------------------------	
+//
+TcpThread* TcpTransport::get_next_thread()
+{
+	return m_threads[m_next_thread++ % m_threads.size()].get();
 }
 
 //------------------------------------------------------------------------------
 // helper class implementation
 //------------------------------------------------------------------------------	
 //
-TcpThread::TcpThread(TcpTransport* a_transport):
+TcpThread::TcpThread(TcpTransport* a_transport, const SockAddr* a_listen_addr):
 	Worker(),
 	m_transport(a_transport),
-	m_sockets(),
+	m_packet_pool(&a_transport->m_packet_pool),
+	m_own_packet_pool(),
+	m_channels(),
+	m_sending(),
+	m_gathering(),
+	m_starved(),
+	m_starved_retry(),
+	m_sockets(a_transport->settings.socket_backend),
+	m_uring(),
 	m_serversock(),
-	m_ctrl_in(),
-	m_ctrl_out()
+	m_listening(a_listen_addr != nullptr),
+	m_commands(),
+	m_commands_event()
 {
+	// share the pool of our transport only if we're on our own
+	if (m_transport->settings.reactors > 1) {
+		m_own_packet_pool.reset(new PacketPool(m_transport->settings.packet_pool));
+		m_packet_pool = m_own_packet_pool.get();
+	}
+
 	// setup server socket
 	// do this here instead of asynchronously in thread startup,
 	// to avoid tests connecting to socket before it is listening
-	REMO_INFO("setting up server socket");
-	m_serversock = Socket(SockProto::TCP);
-	m_serversock.set_blocking(false);
-	m_serversock.on_receive_ready(std::bind(&TcpThread::handle_incoming_connection, this));
-	m_serversock.set_reuse_addr(true);
-	m_serversock.bind(m_transport->settings.listen_addr);
-	m_serversock.listen();
-
-	// setup inter-thread communication sockets
-	REMO_INFO("setting up inter-thread communication");
-	m_ctrl_in = Socket(SockProto::UDP);
-	m_ctrl_in.set_blocking(false);
-	m_ctrl_in.on_receive_ready(std::bind(&TcpThread::handle_cmd, this));
-	m_ctrl_in.bind(SockAddr::localhost);
-	m_ctrl_out = Socket(SockProto::UDP);
-	m_ctrl_out.bind(SockAddr::localhost);
-	m_ctrl_out.connect(m_ctrl_in.get_socket_addr());
-	m_ctrl_in.connect(m_ctrl_out.get_socket_addr());	
+	if (m_listening) {
+		REMO_INFO("setting up server socket");
+		m_serversock = Socket(SockProto::TCP, a_listen_addr->get_family());
+		m_serversock.set_blocking(false);
+		m_serversock.on_receive_ready(std::bind(&TcpThread::handle_incoming_connection, this));
+		if (a_listen_addr->get_family() == AddrFamily::Unix) {
+			// a file left behind by a previous run would make binding fail
+			Socket::remove_stale_file(*a_listen_addr);
+		} else {
+			m_serversock.set_reuse_addr(true);
+			if (m_transport->settings.reactors > 1 && Socket::has_reuse_port()) {
+				// let the other threads listen on the same port
+				m_serversock.set_reuse_port(true);
+			}
+		}
+		m_serversock.bind(*a_listen_addr);
+		m_serversock.listen();
+	}
+
+	// setup inter-thread communication
+	m_commands_event.on_receive_ready(std::bind(&TcpThread::handle_cmd, this));
+
+	// use io_uring if requested
+	const TcpTransport::Settings& settings = m_transport->settings;
+	if (settings.io_uring) {
+		if (TcpUring::is_supported()) {
+			REMO_INFO("using io_uring");
+			m_uring.reset(new TcpUring(this, settings.io_uring_rx_buffers));
+		} else {
+			REMO_WARN("io_uring not supported by the system, waiting for ready sockets instead");
+		}
+	}
 
 	// add special sockets to our set
-	m_sockets.add(&m_ctrl_in);
-	m_sockets.add(&m_serversock);
+	if (m_uring) {
+		m_uring->add_notifier(&m_commands_event, std::bind(&TcpThread::handle_cmd, this));
+		if (m_listening) {
+			m_uring->add_listener(&m_serversock, 
+				std::bind(&TcpThread::handle_accepted, this, std::placeholders::_1));
+		}
+	} else {
+		m_sockets.add(&m_commands_event);
+		if (m_listening) {
+			m_sockets.add(&m_serversock);
+		}
+	}
 }
 
 //------------------------------------------------------------------------------	
 //
 TcpThread::~TcpThread()
 {
+	// a Unix socket leaves its file behind
+	if (m_listening) {
+		Socket::remove_file(m_serversock.get_socket_addr());
+	}
 }
 
 //------------------------------------------------------------------------------	
@@ -136,8 +223,18 @@ void TcpThread::do_startup()
 //
 void TcpThread::action()
 {
-	REMO_VERB("polling %d sockets", m_sockets.count());
-	m_sockets.poll();
+	int64_t timeout_us = send_gathered();
+	const int64_t retry_us = retry_starved();
+	if (timeout_us == WAIT_FOREVER || (retry_us != WAIT_FOREVER && retry_us < timeout_us)) {
+		timeout_us = retry_us;
+	}
+	if (m_uring) {
+		REMO_VERB("waiting for completions of %zu sockets", m_uring->count());
+		m_uring->poll(timeout_us);
+	} else {
+		REMO_VERB("polling %d sockets", m_sockets.count());
+		m_sockets.poll_us(timeout_us);
+	}
 }
 
 //------------------------------------------------------------------------------	
@@ -145,14 +242,32 @@ void TcpThread::action()
 void TcpThread::do_shutdown()
 {
 	// TODO shutdown necessary/useful? Windows returns WSAENOTCONN for this
-	//m_ctrl_in.shutdown();
 	//m_serversock.shutdown();
-	m_sockets.remove(&m_ctrl_in);
-	m_sockets.remove(&m_serversock);
-	// close all channels
-	m_transport->close_channels();
+	if (m_uring) {
+		m_uring->remove(&m_commands_event);
+		if (m_listening) {
+			m_uring->remove(&m_serversock);
+		}
+	} else {
+		m_sockets.remove(&m_commands_event);
+		if (m_listening) {
+			m_sockets.remove(&m_serversock);
+		}
+	}
+	// close all our channels. copied, as closing may remove them right away
+	std::vector<TcpChannel*> channels(m_channels.begin(), m_channels.end());
+	for (TcpChannel* channel : channels) {
+		channel->close();
+	}
 	
 	// wait for sockets to properly disconnect
+	if (m_uring) {
+		// and for pending operations to be cancelled, as they refer to our packets
+		while (m_uring->count() > 0) {
+			REMO_VERB("waiting for completions of %zu sockets (shutdown)", m_uring->count());
+			m_uring->poll();
+		}
+	}
 	while (m_sockets.count() > 0) {
 		REMO_VERB("polling %d sockets (shutdown)", m_sockets.count());		
 		m_sockets.poll();
@@ -163,39 +278,104 @@ void TcpThread::do_shutdown()
 //
 void TcpThread::handle_incoming_connection()
 {
-	// create new channel for accepted socket
-	TcpChannel* channel = new TcpChannel(m_transport, m_serversock.accept(), true);
-	// keep track of it
-	do_add_channel(channel);
-	// notify upper layers
-	m_transport->accept(channel);
+	handle_accepted(m_serversock.accept());
 }
 
 //------------------------------------------------------------------------------	
 //
-void TcpThread::handle_cmd()
+void TcpThread::handle_accepted(Socket&& a_socket)
 {
-	// "dequeue"
-	TcpChannel* channel = nullptr;
-	m_ctrl_in.recv(&channel, sizeof(channel));
-	if (channel) {
+	// create new channel for accepted socket
+	TcpChannel* channel = new TcpChannel(m_transport, std::move(a_socket), true);
+	TcpThread* thread = m_transport->get_thread_for_accepted(this);
+	if (thread == this) {
+		// keep track of it
 		do_add_channel(channel);
+		// notify upper layers
+		m_transport->accept(channel);
 	} else {
+		// notify upper layers first, as the other thread may receive right away.
+		// they may send already, which the channel needs its thread for
+		channel->set_thread(thread);
+		m_transport->accept(channel);
+		thread->add_channel(channel);
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpThread::handle_cmd()
+{
+	// reset before taking the commands, so that those queued meanwhile signal again
+	m_commands_event.reset();
+
+	// handle all commands queued since the last time. a command that fails must
+	// not take the others with it, as they are not signalled again
+	const size_t count = m_commands.consume_all([this](Command& a_cmd) {
+		try {
+			do_cmd(a_cmd);
+		} catch (const std::exception& e) {
+			REMO_ERROR("unhandled exception in command: %s", e.what());
+		} catch (...) {
+			REMO_ERROR("unhandled unknown exception in command");
+		}
+	});
+	REMO_VERB("handled %zu commands", count);
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpThread::do_cmd(Command& a_cmd)
+{
+	switch (a_cmd.kind) {
+	case Command::Kind::add_channel:
+		do_add_channel(a_cmd.channel);
+		break;
+	case Command::Kind::send_ready:
+		do_notify_send_ready(a_cmd.channel, true);
+		break;
+	case Command::Kind::send_later:
+		do_send_later(a_cmd.channel);
+		break;
+	case Command::Kind::call:
+		a_cmd.work();
+		break;
+	case Command::Kind::shutdown:
 		// shutdown sentinel received
 		REMO_INFO("shutdown signal received");
 		// set termination flag
 		terminate();
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpThread::enqueue(Command&& a_cmd)
+{
+	// only the first one needs to wake us up, we take all of them at once
+	if (m_commands.push(std::move(a_cmd))) {
+		m_commands_event.signal();
 	}
 }
 
+//------------------------------------------------------------------------------	
+//
+void TcpThread::post(std::function<void()> a_work)
+{
+	enqueue({ Command::Kind::call, nullptr, std::move(a_work) });
+}
+
 //------------------------------------------------------------------------------	
 //
 void TcpThread::add_channel(TcpChannel* a_channel)
 {
 	REMO_ASSERT(!is_self(), "must not be called from own thread");
 
-	// "enqueue"
-	m_ctrl_out.send(&a_channel, sizeof(a_channel));
+	// the channel may send before we got it
+	a_channel->set_thread(this);
+
+	enqueue({ Command::Kind::add_channel, a_channel, nullptr });
 }
 
 //------------------------------------------------------------------------------	
@@ -204,8 +384,24 @@ void TcpThread::do_add_channel(TcpChannel* a_channel)
 {
 	REMO_ASSERT(is_self(), "must be called from own thread");
 
+	// the channel stays with us
+	a_channel->set_thread(this);
+	m_channels.insert(a_channel);
+
 	// add channel socket to our set
-	m_sockets.add(a_channel->get_socket());
+	if (m_uring) {
+		m_uring->add_channel(a_channel);
+	} else {
+		m_sockets.add(a_channel->get_socket());
+	}
+
+	// packets queued before we got it? then its request may have come first
+	if (a_channel->is_send_pending()) {
+		do_notify_send_ready(a_channel, true);
+	}
+	if (m_transport->settings.send_coalesce_us > 0) {
+		do_send_later(a_channel);
+	}
 }
 
 //------------------------------------------------------------------------------	
@@ -214,8 +410,174 @@ void TcpThread::remove_channel(TcpChannel* a_channel)
 {
 	REMO_ASSERT(is_self(), "must be called from own thread");
 
+	do_notify_send_ready(a_channel, false);
+	m_gathering.erase(std::remove(m_gathering.begin(), m_gathering.end(), a_channel), m_gathering.end());
+	m_starved.erase(std::remove(m_starved.begin(), m_starved.end(), a_channel), m_starved.end());
+	m_channels.erase(a_channel);
+
 	// remove channel socket to our set
-	m_sockets.remove(a_channel->get_socket());
+	if (m_uring) {
+		m_uring->remove(a_channel);
+	} else {
+		m_sockets.remove(a_channel->get_socket());
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpThread::notify_send_ready(TcpChannel* a_channel, bool a_enable)
+{
+	if (is_self()) {
+		do_notify_send_ready(a_channel, a_enable);
+		return;
+	}
+	REMO_ASSERT(a_enable, "must be disabled from own thread");
+
+	enqueue({ Command::Kind::send_ready, a_channel, nullptr });
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpThread::do_notify_send_ready(TcpChannel* a_channel, bool a_enable)
+{
+	REMO_ASSERT(is_self(), "must be called from own thread");
+
+	if (a_enable) {
+		// ignore channels not added yet, or removed meanwhile
+		if (m_channels.find(a_channel) == m_channels.end() ||
+			!m_sending.insert(a_channel).second) {
+			return;
+		}
+	} else if (m_sending.erase(a_channel) == 0) {
+		return;
+	}
+
+	if (m_uring) {
+		Socket* socket = a_channel->get_socket();
+		if (a_enable) {
+			m_uring->add_sender(socket, std::bind(&TcpChannel::send_queued, a_channel));
+		} else {
+			m_uring->remove(socket);
+		}
+	} else {
+		m_sockets.notify_send_ready(a_channel->get_socket(), a_enable);
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpThread::send_later(TcpChannel* a_channel)
+{
+	if (is_self()) {
+		do_send_later(a_channel);
+		return;
+	}
+
+	enqueue({ Command::Kind::send_later, a_channel, nullptr });
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpThread::do_send_later(TcpChannel* a_channel)
+{
+	REMO_ASSERT(is_self(), "must be called from own thread");
+
+	// ignore channels not added yet, or removed meanwhile
+	if (m_channels.find(a_channel) == m_channels.end() ||
+		std::find(m_gathering.begin(), m_gathering.end(), a_channel) != m_gathering.end()) {
+		return;
+	}
+	m_gathering.push_back(a_channel);
+}
+
+//------------------------------------------------------------------------------	
+//
+int64_t TcpThread::send_gathered()
+{
+	if (m_gathering.empty()) {
+		return WAIT_FOREVER;
+	}
+
+	// send whatever is due, and determine when the rest is
+	const auto now = std::chrono::steady_clock::now();
+	auto next = std::chrono::steady_clock::time_point::max();
+	for (size_t i = 0; i < m_gathering.size(); ) {
+		auto deadline = next;
+		if (m_gathering[i]->send_gathered(now, deadline)) {
+			m_gathering[i] = m_gathering.back();
+			m_gathering.pop_back();
+		} else {
+			next = std::min(next, deadline);
+			++i;
+		}
+	}
+	if (m_gathering.empty()) {
+		return WAIT_FOREVER;
+	}
+
+	// rounded up, so as not to wake too early
+	const auto wait = next - now;
+	const int64_t wait_us = std::chrono::duration_cast<std::chrono::microseconds>(wait).count();
+	return wait > std::chrono::microseconds(wait_us) ? wait_us + 1 : wait_us;
+}
+
+//------------------------------------------------------------------------------	
+//
+void TcpThread::receive_starved(TcpChannel* a_channel)
+{
+	REMO_ASSERT(is_self(), "must be called from own thread");
+
+	if (std::find(m_starved.begin(), m_starved.end(), a_channel) != m_starved.end()) {
+		return;
+	}
+	REMO_WARN("out of packets to receive into for %s, %zu in use",
+		a_channel->get_socket()->get_log_name().c_str(), m_packet_pool->get_size());
+	if (m_starved.empty()) {
+		m_starved_retry = std::chrono::steady_clock::now() + STARVED_RETRY;
+	}
+	m_starved.push_back(a_channel);
+
+	// the socket would keep being reported ready otherwise. io_uring receives
+	// into buffers of its own, and retries on its own when out of them
+	if (!m_uring) {
+		m_sockets.notify_receive_ready(a_channel->get_socket(), false);
+	}
+}
+
+//------------------------------------------------------------------------------	
+//
+int64_t TcpThread::retry_starved()
+{
+	if (m_starved.empty()) {
+		return WAIT_FOREVER;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (now < m_starved_retry) {
+		// rounded up, so as not to wake too early
+		return std::chrono::duration_cast<std::chrono::microseconds>(m_starved_retry - now).count() + 1;
+	}
+
+	// deliver what is pending, and receive again once there is a packet to
+	// receive into. io_uring takes care of the latter on its own
+	std::vector<TcpChannel*> starved;
+	starved.swap(m_starved);
+	for (TcpChannel* channel : starved) {
+		// ignore channels removed meanwhile
+		if (m_channels.find(channel) == m_channels.end()) {
+			continue;
+		}
+		if (!channel->deliver_rx_packets() || (!m_uring && !channel->prepare_rx_packet())) {
+			m_starved.push_back(channel);
+		} else if (!m_uring) {
+			m_sockets.notify_receive_ready(channel->get_socket(), true);
+		}
+	}
+	if (m_starved.empty()) {
+		return WAIT_FOREVER;
+	}
+	m_starved_retry = now + STARVED_RETRY;
+	return STARVED_RETRY.count();
 }
 
 //------------------------------------------------------------------------------	
@@ -229,7 +591,7 @@ void TcpThread::shutdown()
 	 */
 	REMO_INFO("requesting thread to terminate");
 	// send sentinel to thread to wake it from poll()
-	add_channel(nullptr);
+	enqueue({ Command::Kind::shutdown, nullptr, nullptr });
 }
 
 //------------------------------------------------------------------------------
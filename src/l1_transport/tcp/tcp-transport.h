@@ -17,10 +17,18 @@
 #include "l1_transport/transport.h"
 #include "l0_system/socket.h"
 #include "l0_system/worker.h"
+#include "utils/mpsc_queue.h"
 
 #include "tcp-channel.h"
+#include "tcp-uring.h"
 //
 // C++ 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <vector>
 //
 //
 //------------------------------------------------------------------------------
@@ -41,26 +49,51 @@ class TcpTransport;
 //------------------------------------------------------------------------------
 //
 /**
- * This class handles the actual socket communication for all our channels.
+ * This class handles the actual socket communication for a share of our channels.
  * 
  * The functionality is separated from TcpTransport in order to avoid
- * concurrent access to member variables.
+ * concurrent access to member variables. A channel is handled by the same
+ * thread for its whole life.
  */
 class TcpThread: public Worker
 {
 
 // ctor/dtor
 public:
-	TcpThread(TcpTransport* a_transport);
+	//! a_listen_addr: address to accept connections on, or nullptr for none
+	TcpThread(TcpTransport* a_transport, const SockAddr* a_listen_addr);
 	virtual ~TcpThread();
 
 	//! add a channel to be handled by this thread
 	//! takes ownership
 	void add_channel(TcpChannel* a_channel);
 	void remove_channel(TcpChannel* a_channel);
+	//! call the given channel when its socket is ready to send, until disabled.
+	//! may be enabled by any thread, but disabled only by our own
+	void notify_send_ready(TcpChannel* a_channel, bool a_enable);
+	//! have the packets gathered by the given channel sent when they are due.
+	//! may be called by any thread
+	void send_later(TcpChannel* a_channel);
+	//! have the given function called by our thread, e.g. to access our channels
+	//! without locking. may be called by any thread
+	void post(std::function<void()> a_work);
+	//! called by a channel that is out of packets to receive into. it is no
+	//! longer called to receive until retried after a short delay
+	void receive_starved(TcpChannel* a_channel);
 
 	void shutdown() override;
 
+	//! address connections are accepted on
+	SockAddr get_listen_addr() const { return m_serversock.get_socket_addr(); }
+
+	//! get a new packet of the given size class without waiting, as waiting
+	//! would stall all of our channels. nullptr if there is none
+	packet_ptr try_take_packet(PacketSize a_size_class) { return packet_ptr(m_packet_pool->try_take(a_size_class)); }
+	//! get a packet without a buffer, to be used as a slice of another one
+	packet_ptr take_slice() { return packet_ptr(m_packet_pool->take_slice()); }
+	//! pool providing the packets received into
+	const PacketPool& get_packet_pool() const { return *m_packet_pool; }
+
 // protected member functions
 protected:
 	//! handle communication
@@ -72,23 +105,66 @@ protected:
 
 	//! called when server socket is ready to accept a new connection
 	void handle_incoming_connection();
-	//! called when the receiving end of the "pseudo queue" is ready to receive
+	//! called with a connection accepted on the server socket
+	void handle_accepted(Socket&& a_socket);
+	//! called when commands have been queued for us
 	void handle_cmd();
 
 	//! internal add channel
 	void do_add_channel(TcpChannel* a_channel);
+	//! internal notify send ready
+	void do_notify_send_ready(TcpChannel* a_channel, bool a_enable);
+	//! internal send later
+	void do_send_later(TcpChannel* a_channel);
+	//! send packets gathered that are due. returns microseconds until the next
+	//! ones are, or WAIT_FOREVER
+	int64_t send_gathered();
+	//! have channels out of packets receive again if it is time to retry.
+	//! returns microseconds until the next retry, or WAIT_FOREVER
+	int64_t retry_starved();
+
+// private types
+private:
+	//! requests sent to our thread
+	struct Command {
+		enum class Kind { add_channel, send_ready, send_later, call, shutdown } kind;
+		TcpChannel* channel;
+		std::function<void()> work;
+	};
+
+// private member functions
+private:
+	//! queue a command, waking up our thread if it has none yet
+	void enqueue(Command&& a_cmd);
+	//! carry out a command taken from the queue
+	void do_cmd(Command& a_cmd);
 
 // private members
 private:
 	//! our transport controller (owner)
 	TcpTransport* m_transport;
+	//! packets received into. our own if there are several threads, to avoid contention
+	PacketPool* m_packet_pool;
+	std::unique_ptr<PacketPool> m_own_packet_pool;
+	//! channels handled by this thread
+	std::unordered_set<TcpChannel*> m_channels;
+	//! channels waiting for their socket to be ready to send
+	std::unordered_set<TcpChannel*> m_sending;
+	//! channels gathering packets to be sent at once
+	std::vector<TcpChannel*> m_gathering;
+	//! channels out of packets to receive into, and when to retry them
+	std::vector<TcpChannel*> m_starved;
+	std::chrono::steady_clock::time_point m_starved_retry;
 	//! sockets handled by this thread
 	SocketSet m_sockets;
-	//! socket for accepting incoming connections
+	//! used instead of the socket set if requested and supported
+	std::unique_ptr<TcpUring> m_uring;
+	//! socket for accepting incoming connections, if any
 	Socket m_serversock;
-	//! sockets used as "pseudo-queue" for poor man's inter-thread communication
-	Socket m_ctrl_in;
-	Socket m_ctrl_out;
+	bool m_listening;
+	//! commands from other threads, and the event signalled when there are some
+	utils::MpscQueue<Command> m_commands;
+	EventSocket m_commands_event;
 };
 
 
@@ -102,8 +178,34 @@ class TcpTransport: public Transport
 public:
 	//! class specific settings go here
 	struct Settings: public Transport::Settings {
-		//! "server" socket address
+		//! "server" socket address, or a Unix socket address. see UdsTransport
 		SockAddr listen_addr = SockAddr(":1986");
+		//! facility used to wait for ready sockets
+		SocketSet::Backend socket_backend = SocketSet::Backend::Default;
+		//! accept and receive through io_uring where the system supports it,
+		//! instead of waiting for ready sockets
+		bool io_uring = false;
+		//! number of packets handed to io_uring to receive into, a power of two
+		uint16_t io_uring_rx_buffers = 64;
+		//! limits of the queue of each channel holding packets until the socket is
+		//! ready to send. send throws, and try_send returns false, if exceeded
+		size_t send_queue_packets = 1024;
+		size_t send_queue_bytes = 4 * 1024 * 1024;
+		//! disable Nagle's algorithm, sending small segments without delay
+		bool tcp_nodelay = false;
+		//! gather packets sent while others are still queued for up to this long,
+		//! to send them with a single system call, even if the socket is ready
+		//! before. a packet with nothing queued is always sent right away. 0 sends
+		//! queued packets as soon as the socket is ready
+		uint32_t send_coalesce_us = 0;
+		//! send the packets gathered right away once they amount to this many bytes
+		size_t send_coalesce_bytes = 16 * 1024;
+		//! number of threads handling the channels, each channel stays with one of them.
+		//! with several, each has its own packet pool and, where the system supports
+		//! it, accepts connections on its own socket bound to the same port. otherwise
+		//! the first one accepts and hands them out in turn. note that accept and
+		//! receive handlers are then called on several threads concurrently
+		size_t reactors = 1;
 
 	} settings;
 
@@ -119,10 +221,25 @@ public:
 	//! handle close event
 	virtual void closed(Channel* a_channel) override;
 
+// protected member functions called by TcpThread
+protected:
+	friend class TcpThread;
+	//! thread to hand on a connection accepted by the given one
+	TcpThread* get_thread_for_accepted(TcpThread* a_acceptor);
+
+// private member functions
+private:
+	//! next thread in turn, to spread channels evenly
+	TcpThread* get_next_thread();
+
 // private members
 private:
-	//! worker thread doing the socket communication
-	TcpThread m_thread;
+	//! worker threads doing the socket communication
+	std::vector<std::unique_ptr<TcpThread>> m_threads;
+	//! true if every thread accepts connections on its own
+	bool m_sharded;
+	//! counter to take turns among the threads
+	std::atomic<size_t> m_next_thread;
 };
 
 
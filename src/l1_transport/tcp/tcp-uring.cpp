@@ -0,0 +1,340 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#include "tcp-uring.h"
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+#include "tcp-transport.h"
+#include "tcp-channel.h"
+#include "utils/logger.h"
+#include "utils/contracts.h"
+//
+// C++
+#include <algorithm>
+//
+// system
+#include <errno.h>
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace trans {
+//------------------------------------------------------------------------------
+
+//! logger instance
+static Logger logger("TcpUring");
+
+
+//------------------------------------------------------------------------------
+// constants
+//------------------------------------------------------------------------------
+//
+//! operations that can be queued at once. the ring is submitted when full
+static const unsigned RING_ENTRIES = 256;
+//! how soon to retry receiving when out of packets to receive into
+static const int64_t STARVED_RETRY_US = 1000;
+//! user data of operations whose completion is of no interest
+static const uint64_t IGNORED = 0;
+
+
+//------------------------------------------------------------------------------
+// class implementation
+//------------------------------------------------------------------------------
+//
+TcpUring::TcpUring(TcpThread* a_thread, uint16_t a_rx_buffers):
+	m_thread(a_thread),
+	m_rx_buffers(a_rx_buffers),
+	m_rx_empty(),
+	m_sources(),
+	m_starved(),
+	m_dispatching(nullptr),
+	m_ring(RING_ENTRIES)
+{
+	// all buffers are empty first
+	m_ring.setup_buffers(a_rx_buffers);
+	for (uint16_t id = a_rx_buffers; id --> 0 ;) {
+		m_rx_empty.push_back(id);
+	}
+	refill_rx_buffers();
+}
+
+//------------------------------------------------------------------------------
+//
+TcpUring::~TcpUring()
+{
+	REMO_ASSERT(m_sources.empty(),
+		"all sockets and channels must be removed before destroying");
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::add_listener(Socket* a_socket, const accept_handler& a_handler)
+{
+	Source* source = new Source();
+	source->kind = Source::Kind::listener;
+	source->fd = a_socket->get_fd();
+	source->on_accept = a_handler;
+	add_source(a_socket, source);
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::add_notifier(Socket* a_socket, const ready_handler& a_handler)
+{
+	Source* source = new Source();
+	source->kind = Source::Kind::notifier;
+	source->fd = a_socket->get_fd();
+	source->on_ready = a_handler;
+	add_source(a_socket, source);
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::add_channel(TcpChannel* a_channel)
+{
+	Source* source = new Source();
+	source->kind = Source::Kind::channel;
+	source->fd = a_channel->get_socket()->get_fd();
+	source->channel = a_channel;
+	add_source(a_channel, source);
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::add_sender(Socket* a_socket, const ready_handler& a_handler)
+{
+	Source* source = new Source();
+	source->kind = Source::Kind::sender;
+	source->fd = a_socket->get_fd();
+	source->on_ready = a_handler;
+	add_source(a_socket, source);
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::add_source(const void* a_key, Source* a_source)
+{
+	REMO_PRECOND({
+		REMO_ASSERT(m_sources.find(a_key) == m_sources.end(),
+			"must not be added twice");
+	});
+
+	a_source->key = a_key;
+	m_sources[a_key].reset(a_source);
+	arm(a_source);
+
+	REMO_INFO("added #%d (count: %zu)", a_source->fd, count());
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::remove_source(const void* a_key)
+{
+	auto it = m_sources.find(a_key);
+	REMO_ASSERT(it != m_sources.end(),
+		"must have been added");
+
+	Source* source = it->second.get();
+	if (source->removed) {
+		return;
+	}
+	source->removed = true;
+
+	REMO_INFO("removing #%d (count: %zu)", source->fd, count());
+	if (source->armed) {
+		// keep it until its operation has ended
+		m_ring.cancel(reinterpret_cast<uint64_t>(source), IGNORED);
+	} else if (source != m_dispatching) {
+		erase_source(source);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::erase_source(Source* a_source)
+{
+	REMO_INFO("removed #%d", a_source->fd);
+	m_starved.erase(std::remove(m_starved.begin(), m_starved.end(), a_source), m_starved.end());
+	const void* key = a_source->key;
+	m_sources.erase(key);
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::arm(Source* a_source)
+{
+	const uint64_t user_data = reinterpret_cast<uint64_t>(a_source);
+	switch (a_source->kind) {
+	case Source::Kind::listener:
+		m_ring.accept_multishot(a_source->fd, user_data);
+		break;
+	case Source::Kind::notifier:
+		m_ring.poll_multishot(a_source->fd, user_data);
+		break;
+	case Source::Kind::channel:
+		m_ring.recv_multishot(a_source->fd, user_data);
+		break;
+	case Source::Kind::sender:
+		// once, as the socket stays ready to send most of the time
+		m_ring.poll_send(a_source->fd, user_data);
+		break;
+	}
+	a_source->armed = true;
+}
+
+//------------------------------------------------------------------------------
+//
+size_t TcpUring::poll(int64_t a_timeout_us)
+{
+	refill_rx_buffers();
+
+	// retry receiving for channels that ran out of buffers, soon if there are none yet
+	if (!m_starved.empty()) {
+		if (m_rx_empty.size() < m_rx_buffers.size()) {
+			for (Source* source : m_starved) {
+				arm(source);
+			}
+			m_starved.clear();
+		} else if (a_timeout_us == WAIT_FOREVER || a_timeout_us > STARVED_RETRY_US) {
+			a_timeout_us = STARVED_RETRY_US;
+		}
+	}
+
+	// submit and wait
+	m_ring.wait_us(a_timeout_us);
+
+	// handle all completions
+	size_t count = 0;
+	IoUring::Completion completion;
+	while (m_ring.next(completion)) {
+		dispatch(completion);
+		++count;
+	}
+	return count;
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::dispatch(const IoUring::Completion& a_completion)
+{
+	// take back the packet received into, if any
+	packet_ptr packet;
+	if (a_completion.has_buffer()) {
+		const uint16_t id = a_completion.get_buffer_id();
+		packet = std::move(m_rx_buffers[id]);
+		m_rx_empty.push_back(id);
+	}
+
+	Source* source = reinterpret_cast<Source*>(a_completion.user_data);
+	if (!source) {
+		return;
+	}
+	if (!a_completion.has_more()) {
+		source->armed = false;
+	}
+
+	// removed meanwhile? then nothing is of interest anymore
+	if (source->removed) {
+		if (source->kind == Source::Kind::listener && a_completion.result >= 0) {
+			// close connection accepted just before
+			Socket::adopt(a_completion.result);
+		}
+		if (!source->armed) {
+			erase_source(source);
+		}
+		return;
+	}
+
+	m_dispatching = source;
+	const int32_t result = a_completion.result;
+	switch (source->kind) {
+	case Source::Kind::listener:
+		if (result >= 0) {
+			source->on_accept(Socket::adopt(result));
+		} else {
+			REMO_WARN("accepting on #%d failed with error %d", source->fd, -result);
+		}
+		break;
+	case Source::Kind::notifier:
+	case Source::Kind::sender:
+		if (result >= 0) {
+			source->on_ready();
+		} else {
+			REMO_WARN("polling #%d failed with error %d", source->fd, -result);
+		}
+		break;
+	case Source::Kind::channel:
+		dispatch_channel(source, a_completion, packet);
+		break;
+	}
+	m_dispatching = nullptr;
+
+	// the handler may have removed it, otherwise keep its operation armed
+	if (source->removed) {
+		if (!source->armed) {
+			erase_source(source);
+		}
+	} else if (!source->armed &&
+		std::find(m_starved.begin(), m_starved.end(), source) == m_starved.end()) {
+		arm(source);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::dispatch_channel(Source* a_source, const IoUring::Completion& a_completion,
+	packet_ptr& a_packet)
+{
+	const int32_t result = a_completion.result;
+	if (result > 0) {
+		REMO_ASSERT(a_packet,
+			"data must be received into a provided buffer");
+		a_source->channel->received_chunk(a_packet, static_cast<size_t>(result));
+	} else if (result == 0) {
+		// orderly shutdown by peer
+		a_source->channel->receive_shutdown();
+	} else if (result == -ENOBUFS) {
+		// data is left in the socket, retry when we have buffers again
+		REMO_WARN("out of packets to receive into for #%d, %zu in use",
+			a_source->fd, m_thread->get_packet_pool().get_size());
+		m_starved.push_back(a_source);
+	} else {
+		// e.g. connection reset
+		REMO_WARN("receiving on #%d failed with error %d", a_source->fd, -result);
+		a_source->channel->receive_shutdown();
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+void TcpUring::refill_rx_buffers()
+{
+	while (!m_rx_empty.empty()) {
+		// do not wait for packets, as it is us who hands them on
+		packet_ptr packet = m_thread->try_take_packet(PacketSize::medium);
+		if (!packet) {
+			return;
+		}
+		TcpChannel::init_rx_packet(*packet);
+
+		const uint16_t id = m_rx_empty.back();
+		m_rx_empty.pop_back();
+		RBuffer& payload = packet->get_payload();
+		m_ring.provide_buffer(id, payload.get_data(), payload.get_capacity());
+		m_rx_buffers[id] = std::move(packet);
+	}
+}
+
+//------------------------------------------------------------------------------
+	} // end namespace trans
+} // end namespace remo
+//------------------------------------------------------------------------------
@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+#include "l1_transport/packet.h"
+#include "l0_system/io_uring.h"
+#include "l0_system/socket.h"
+//
+// C++ 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace trans {
+//------------------------------------------------------------------------------
+
+using namespace sys;
+
+//------------------------------------------------------------------------------
+// forward declarations
+//------------------------------------------------------------------------------
+//
+class TcpThread;
+class TcpChannel;
+
+//------------------------------------------------------------------------------
+// class declaration
+//------------------------------------------------------------------------------
+//
+/**
+ * Event loop of a TcpThread based on io_uring, used instead of a SocketSet
+ * where the system supports it.
+ * 
+ * Connections are accepted and data is received by multishot operations, which
+ * stay armed across completions. Data is received into packets of the pool that
+ * are handed to the kernel in advance, and the packet holding a chunk is handed
+ * on to its channel. A single system call per wakeup thus submits and reaps any
+ * number of operations, instead of a poll plus a receive per ready socket.
+ */
+class TcpUring
+{
+// types
+public:
+	//! callback type for accepted connections
+	typedef std::function<void(Socket&&)> accept_handler;
+	//! callback type for ready events. must receive all data available
+	typedef std::function<void()> ready_handler;
+
+// ctor/dtor
+public:
+	//! a_rx_buffers: number of packets to receive into, a power of two
+	TcpUring(TcpThread* a_thread, uint16_t a_rx_buffers);
+	~TcpUring();
+
+// public member functions
+public:
+	//! true if the system supports everything needed
+	static bool is_supported() { return IoUring::is_supported(); }
+
+	//! accept connections on the given listening socket
+	void add_listener(Socket* a_socket, const accept_handler& a_handler);
+	//! get notified when the given socket is ready to receive
+	void add_notifier(Socket* a_socket, const ready_handler& a_handler);
+	//! receive data on behalf of the given channel
+	void add_channel(TcpChannel* a_channel);
+	//! get notified when the given socket is ready to send, until removed
+	void add_sender(Socket* a_socket, const ready_handler& a_handler);
+
+	//! stop handling the given socket or channel. its operation is cancelled,
+	//! and it is counted until the cancellation completed
+	void remove(Socket* a_socket) { remove_source(a_socket); }
+	void remove(TcpChannel* a_channel) { remove_source(a_channel); }
+
+	//! submit operations and handle completions. returns the number handled
+	size_t poll(int64_t a_timeout_us = WAIT_FOREVER);
+
+	//! number of sockets and channels handled
+	size_t count() const { return m_sources.size(); }
+
+// private types
+private:
+	//! something we have an operation for, kept armed until removed
+	struct Source {
+		enum class Kind { listener, notifier, channel, sender } kind;
+		//! socket or channel it was added for
+		const void* key;
+		int fd;
+		TcpChannel* channel;
+		accept_handler on_accept;
+		ready_handler on_ready;
+		//! operation in flight
+		bool armed;
+		//! removal requested, waiting for the operation to end
+		bool removed;
+	};
+
+// private member functions
+private:
+	void add_source(const void* a_key, Source* a_source);
+	void remove_source(const void* a_key);
+	void erase_source(Source* a_source);
+	void arm(Source* a_source);
+	void dispatch(const IoUring::Completion& a_completion);
+	void dispatch_channel(Source* a_source, const IoUring::Completion& a_completion, packet_ptr& a_packet);
+	//! hand fresh packets to the kernel for the ones received into
+	void refill_rx_buffers();
+
+// private members
+private:
+	//! the thread we run on, providing the packets to receive into
+	TcpThread* m_thread;
+	//! packets handed to the kernel, by buffer id. destroyed after the ring
+	std::vector<packet_ptr> m_rx_buffers;
+	//! buffer ids without a packet
+	std::vector<uint16_t> m_rx_empty;
+	//! sources by the socket or channel they were added for
+	std::unordered_map<const void*, std::unique_ptr<Source>> m_sources;
+	//! channels whose receive stopped for lack of buffers
+	std::vector<Source*> m_starved;
+	//! source whose completion is being handled
+	Source* m_dispatching;
+	//! the ring
+	IoUring m_ring;
+};
+
+//------------------------------------------------------------------------------
+	} // end namespace trans
+} // end namespace remo
+//------------------------------------------------------------------------------
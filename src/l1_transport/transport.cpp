@@ -31,16 +31,6 @@ namespace remo {
 static Logger logger("Transport");
 
 
-//------------------------------------------------------------------------------	
-// constants
-//------------------------------------------------------------------------------	
-//
-//! maximum number of packets available
-//! NOTE: this was selected as an arbitrary value and probably depends
-//!       on the "concurrencyness" of the system (e.g. max. number of threads)
-const size_t PACKET_POOL_SIZE = 16;
-
-
 //------------------------------------------------------------------------------
 // class implementation
 //------------------------------------------------------------------------------	
@@ -48,10 +38,10 @@ const size_t PACKET_POOL_SIZE = 16;
 Transport::Transport(const Settings& a_settings):
 	settings(a_settings),
 	m_channels(),
-	m_packet_pool(),
+	m_channels_mutex(),
+	m_packet_pool(a_settings.packet_pool),
 	m_accept_handler()
 {
-	alloc_packets();
 }
 
 //------------------------------------------------------------------------------	
@@ -92,6 +82,7 @@ void Transport::closed(Channel* a_channel)
 //
 void Transport::add_channel(Channel* a_channel)
 {
+	std::lock_guard<std::mutex> lock(m_channels_mutex);
 	REMO_PRECOND({
 		REMO_ASSERT(m_channels.find(a_channel) == m_channels.end(),
 			"channel must not yet exist");
@@ -104,12 +95,15 @@ void Transport::add_channel(Channel* a_channel)
 //
 void Transport::remove_channel(Channel* a_channel)
 {
-	REMO_PRECOND({
-		REMO_ASSERT(m_channels.find(a_channel) != m_channels.end(),
-			"channel must exist");
-	});
-
-	m_channels.erase(a_channel);
+	{
+		std::lock_guard<std::mutex> lock(m_channels_mutex);
+		REMO_PRECOND({
+			REMO_ASSERT(m_channels.find(a_channel) != m_channels.end(),
+				"channel must exist");
+		});
+
+		m_channels.erase(a_channel);
+	}
 	delete a_channel;
 }
 
@@ -117,39 +111,31 @@ void Transport::remove_channel(Channel* a_channel)
 //
 void Transport::remove_channels()
 {
+	std::lock_guard<std::mutex> lock(m_channels_mutex);
 	for (auto it = m_channels.begin(); it != m_channels.end(); it++) {
 		delete *it;
 	}
 	m_channels.clear();
 }
 
-//------------------------------------------------------------------------------	
-//
-void Transport::close_channels()
-{
-	for (auto it = m_channels.begin(); it != m_channels.end(); it++) {
-		(*it)->close();
-	}
-}
-
-//------------------------------------------------------------------------------	
+//------------------------------------------------------------------------------
 //
-void Transport::alloc_packets()
+packet_ptr Transport::take_packet(size_t a_payload_size)
 {
-    // pre-allocate packets
-    for (size_t i = 0; i < PACKET_POOL_SIZE; i++) {
-        m_packet_pool.add(new Packet());
-    }
+	return take_packet(m_packet_pool, a_payload_size);
 }
 
 //------------------------------------------------------------------------------
 //
-packet_ptr Transport::take_packet()
+packet_ptr Transport::take_packet(PacketPool& a_pool, size_t a_payload_size)
 {
-	packet_ptr packet(m_packet_pool.take());
-	REMO_THROW_IF(!packet, 
-		ErrorCode::ERR_OUT_OF_PACKETS, 
-		"out of packets");
+	packet_ptr packet(a_pool.take(a_payload_size));
+	if (!packet) {
+		// caller decides how to go on
+		REMO_WARN("out of packets for %zu bytes payload, %zu in use",
+			a_payload_size, a_pool.get_size());
+		return packet;
+	}
 	REMO_ASSERT(packet->get_size() == 0,
 		"a fresh packet must be empty");
 	return packet;
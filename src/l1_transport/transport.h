@@ -16,12 +16,13 @@
 // project
 #include "channel.h"
 #include "packet.h"
-#include "utils/recycling.h"
+#include "packet_pool.h"
 #include "utils/settings.h"
 //
 // C++ 
 #include <unordered_set>
 #include <functional>
+#include <mutex>
 #include <string>
 //
 //
@@ -40,6 +41,8 @@ class Transport
 public:
 	//! class specific settings go here
 	struct Settings: public utils::Settings {
+		//! packets allocated in advance, and maximum number of packets, per size class
+		PacketPool::Limits packet_pool;
 
 	} settings;
 
@@ -59,8 +62,19 @@ public:
 	//! register a callback function that is invoked when an incoming connection was established
 	void on_accept(const accept_handler& a_handler);
 
-	//! get a new packet from the pool. intended to be used by channels when receiving data
-	packet_ptr take_packet();
+	//! get a new packet from the pool, sized for the given payload. intended to be used by
+	//! channels when receiving data. waits if all packets of its size class are in use,
+	//! and returns an empty pointer if that timed out
+	packet_ptr take_packet(size_t a_payload_size = 0);
+	//! get a new packet of the given size class from the pool. does not wait, and
+	//! returns an empty pointer if all are in use
+	packet_ptr try_take_packet(PacketSize a_size_class) { return packet_ptr(m_packet_pool.try_take(a_size_class)); }
+	//! get a packet without a buffer from the pool, to be used as a slice of another one.
+	//! returns an empty pointer if all are in use
+	packet_ptr take_slice() { return packet_ptr(m_packet_pool.take_slice()); }
+
+	//! packet pool, e.g. for its counters
+	const PacketPool& get_packet_pool() const { return m_packet_pool; }
 
 // public member functions called by Channel & subclasses
 public:
@@ -72,7 +86,8 @@ public:
 // protected member functions called by TcpThread
 protected:
 	friend class TcpThread;
-	void close_channels();
+	//! get a new packet from the given pool, sized for the given payload
+	static packet_ptr take_packet(PacketPool& a_pool, size_t a_payload_size);
 
 // protected member functions
 protected:
@@ -81,10 +96,7 @@ protected:
 	void add_channel(Channel* a_channel);
 	// removes (and deletes) a channel from this transport
 	void remove_channel(Channel* a_channel);
-
-// private member functions
-private:
-	void alloc_packets();
+	//! removes (and deletes) all channels
 	void remove_channels();
 
 
@@ -93,8 +105,10 @@ private:
 	//! set of channels handled by this transport
 	typedef std::unordered_set<Channel*> Channels;
 	Channels m_channels;
+	//! guards the set of channels, as they may be added by several threads
+	std::mutex m_channels_mutex;
 	//! packet pool to avoid heap allocations
-	RecyclingPool<Packet> m_packet_pool;
+	PacketPool m_packet_pool;
 	//! callback function that is invoked when an incoming connection was established
 	accept_handler m_accept_handler;
 };
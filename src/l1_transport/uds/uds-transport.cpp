@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#include "uds-transport.h"
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+#include "utils/logger.h"
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace trans {
+//------------------------------------------------------------------------------
+
+//! logger instance
+static Logger logger("UdsTransport");
+
+//! scheme of endpoints
+static const std::string UNIX_SCHEME = "unix://";
+//! separates the scheme of an endpoint
+static const std::string SCHEME_DELIM = "://";
+
+
+//------------------------------------------------------------------------------
+// class implementation
+//------------------------------------------------------------------------------
+//
+UdsTransport::UdsTransport(const Settings& a_settings):
+	TcpTransport(a_settings)
+{
+}
+
+//------------------------------------------------------------------------------
+//
+UdsTransport::~UdsTransport()
+{
+}
+
+//------------------------------------------------------------------------------
+//
+Channel* UdsTransport::connect(const std::string& a_endpoint)
+{
+	if (a_endpoint.find(SCHEME_DELIM) == std::string::npos) {
+		// just a path
+		return TcpTransport::connect(UNIX_SCHEME + a_endpoint);
+	}
+	REMO_THROW_IF(a_endpoint.compare(0, UNIX_SCHEME.size(), UNIX_SCHEME) != 0,
+		ErrorCode::ERR_SOCKET_INVALID_ADDRESS,
+		"Not a Unix socket address: '%s'", a_endpoint.c_str());
+	return TcpTransport::connect(a_endpoint);
+}
+
+//------------------------------------------------------------------------------
+	} // end namespace trans
+} // end namespace remo
+//------------------------------------------------------------------------------
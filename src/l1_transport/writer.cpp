@@ -11,6 +11,9 @@
 
 #include "utils/logger.h"
 
+#include <cstring> // memcpy
+#include <stdint.h> // SIZE_MAX
+
 //------------------------------------------------------------------------------
 namespace remo {
 	namespace trans {
@@ -24,25 +27,42 @@ static Logger logger("Writer");
 // class Writer
 //------------------------------------------------------------------------------	
 //
-Writer::Writer(Buffer& a_buffer):
+Writer::Writer(RBuffer& a_buffer):
 	m_buffer(a_buffer)
 {
 }
 
 //------------------------------------------------------------------------------
 
-void BinaryWriter::write_value(const char* a_string)
+void BinaryWriter::write_query(const std::string& a_function)
 {
-	// write type info byte
-	write<uint8_t>(TypeId::type_cstr);
-	
-	// output characters
-	for (const char* p = a_string; *p; ++p) {
-		write<uint8_t>(*p);
+	// write packet type
+	write<uint8_t>(PacketType::packet_query);
+	// write name of function whose id is requested
+	write_value(a_function);
+}
+
+//------------------------------------------------------------------------------
+
+void BinaryWriter::write_info(const std::string& a_function, bool a_found, uint32_t a_function_id)
+{
+	// write packet type
+	write<uint8_t>(PacketType::packet_info);
+	// write function name
+	write_value(a_function);
+	// write function id, or null if no such function
+	if (a_found) {
+		write_value(a_function_id);
+	} else {
+		write<uint8_t>(TypeId::type_null);
 	}
+}
 
-	// output terminating NUL character
-	write<uint8_t>(0);
+//------------------------------------------------------------------------------
+
+void BinaryWriter::write_value(const char* a_string)
+{
+	write_string(a_string, std::strlen(a_string));
 }
 
 //------------------------------------------------------------------------------
@@ -66,13 +86,200 @@ void BinaryWriter::write_value(arraysize_t a_size)
 {
 	REMO_THROW_IF(m_has_arraysize, 
 		ErrorCode::ERR_POINTER_NEEDS_SIZE, 
-		"arraysize_t parameter required before pointer type");
+		"arraysize_t parameter must be followed by pointer type");
+
+	// determine number of significant bytes
+	const uint64_t bits = a_size.value;
+	const size_t wire_size = compact_size(bits);
+
+	// write type info byte and actual bytes
+	uint8_t* p = grow(1 + wire_size);
+	p[0] = static_cast<uint8_t>(modifier_arraysize | wire_size);
+	compact_store(p + 1, bits, wire_size);
+
+	// remember for subsequent pointer
 	m_arraysize = a_size;
 	m_has_arraysize = true;
 }
 
 //------------------------------------------------------------------------------
 
+void BinaryWriter::write_string(const char* a_data, size_t a_length)
+{
+#if REMO_LENGTH_PREFIXED_STRINGS
+	// length goes into the compact encoding, its wire size into the type info byte
+	const size_t wire_size = compact_size(a_length);
+#else
+	// no length, receiver needs to look for the terminator
+	const size_t wire_size = 0;
+#endif
+
+	// reserve type info byte, length, characters and NUL terminator at once
+	uint8_t* p = reserve(1 + wire_size + a_length + 1);
+	if (!p) {
+		// large string, characters may continue in further segments
+		p = grow(1 + wire_size);
+		p[0] = static_cast<uint8_t>((wire_size << 4) | TypeId::type_cstr);
+		compact_store(p + 1, a_length, wire_size);
+		append(a_data, a_length);
+		write<uint8_t>(0);
+		return;
+	}
+
+	// write type info byte
+	p[0] = static_cast<uint8_t>((wire_size << 4) | TypeId::type_cstr);
+	compact_store(p + 1, a_length, wire_size);
+
+	// output characters in bulk. the terminator is kept, so that the
+	// receiver can pass the string on in place
+	if (a_length > 0) {
+		std::memcpy(p + 1 + wire_size, a_data, a_length);
+	}
+	p[1 + wire_size + a_length] = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void BinaryWriter::insert_struct_header(size_t a_start)
+{
+	// the length of the fields is known only now
+	const size_t length = get_offset() - a_start;
+	const size_t wire_size = compact_size(length);
+
+	// fields within the current segment, with room for type info byte and length?
+	uint8_t* p = get_written(a_start);
+	if (p && try_grow(1 + wire_size)) {
+		// yes -> make room in front of the fields
+		std::memmove(p + 1 + wire_size, p, length);
+		p[0] = static_cast<uint8_t>((wire_size << 4) | TypeId::type_any);
+		compact_store(p + 1, length, wire_size);
+		return;
+	}
+
+	// no -> write the fields again after type info byte and length
+	std::vector<uint8_t> fields;
+	take_written(a_start, fields);
+	p = grow(1 + wire_size);
+	p[0] = static_cast<uint8_t>((wire_size << 4) | TypeId::type_any);
+	compact_store(p + 1, length, wire_size);
+	append(fields.data(), length);
+}
+
+//------------------------------------------------------------------------------
+
+void BinaryWriter::write_encoded_struct(const uint8_t* a_encoded)
+{
+	const size_t wire_size = a_encoded[0] >> 4;
+	const size_t size = 1 + wire_size + static_cast<size_t>(compact_load(a_encoded + 1, wire_size));
+	uint8_t* p = reserve(size);
+	if (p) {
+		std::memcpy(p, a_encoded, size);
+	} else {
+		append(a_encoded, size);
+	}
+}
+
+//------------------------------------------------------------------------------
+
+void BinaryWriter::write_array(TypeId a_type, const void* a_data, size_t a_item_size)
+{
+	// assume size of 1 if not specified
+	const size_t count = m_has_arraysize ? m_arraysize.value : 1;
+	m_has_arraysize = false;
+
+	// align items to their size, relative to the start of the buffer.
+	// this allows the receiver to access them in place
+	const size_t padding = (0 - (get_offset() + 1)) & (a_item_size - 1);
+
+	// guard against overflow
+	REMO_THROW_IF(count > (SIZE_MAX - 1 - padding) / a_item_size, 
+		ErrorCode::ERR_INVALID_ARRAY_LENGTH, 
+		"invalid array length: %zu", 
+		count);
+	const size_t data_size = count * a_item_size;
+
+	// slowly changing integers may be shorter as differences
+	if (write_delta_array(a_type, a_data, count, a_item_size, padding + data_size)) {
+		return;
+	}
+
+	// reserve everything at once
+	uint8_t* p = reserve(1 + padding + data_size);
+	if (!p) {
+		// large array, items may continue in further segments
+		p = grow(1 + padding);
+		p[0] = a_type;
+		std::memset(p + 1, 0, padding);
+		append_items(a_data, count, a_item_size);
+		return;
+	}
+
+	// write type info byte
+	p[0] = a_type;
+
+	// output padding and items in bulk
+	std::memset(p + 1, 0, padding);
+	if (data_size > 0) {
+		std::memcpy(p + 1 + padding, a_data, data_size);
+		sys::convert_le_array(p + 1 + padding, count, a_item_size);
+	}
+}
+
+//------------------------------------------------------------------------------
+
+void BinaryWriter::append_items(const void* a_data, size_t a_count, size_t a_item_size)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	// items cannot be converted in place when split across segments
+	std::vector<uint8_t> items(static_cast<const uint8_t*>(a_data), 
+		static_cast<const uint8_t*>(a_data) + a_count * a_item_size);
+	sys::convert_le_array(items.data(), a_count, a_item_size);
+	append(items.data(), items.size());
+#else
+	append(a_data, a_count * a_item_size);
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+bool BinaryWriter::write_delta_array(TypeId a_type, const void* a_data, size_t a_count, size_t a_item_size, 
+	size_t a_plain_size)
+{
+#if REMO_DELTA_ARRAYS
+	// only const arrays, as the receiver cannot provide decoded items in place
+	const TypeId item_type = static_cast<TypeId>(a_type & ~modifier_mask);
+	if (!is_cptr_type(a_type) || !delta_supported(item_type) || a_count < REMO_DELTA_ARRAYS_MIN_COUNT) {
+		return false;
+	}
+
+	// shorter than plain?
+	const size_t size = delta_encoded_size(a_data, a_count, a_item_size);
+	if (size >= a_plain_size) {
+		// no -> write plain
+		return false;
+	}
+
+	// write type info byte and encoded items
+	uint8_t* p = reserve(1 + size);
+	if (!p) {
+		// large array, encode separately, as it may continue in further segments
+		write<uint8_t>(static_cast<uint8_t>(modifier_delta | item_type));
+		std::vector<uint8_t> encoded(size);
+		delta_encode(encoded.data(), a_data, a_count, a_item_size);
+		append(encoded.data(), size);
+		return true;
+	}
+	p[0] = static_cast<uint8_t>(modifier_delta | item_type);
+	delta_encode(p + 1, a_data, a_count, a_item_size);
+	return true;
+#else
+	(void)a_type; (void)a_data; (void)a_count; (void)a_item_size; (void)a_plain_size;
+	return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
 void BinaryWriter::write_value(const TypedValue& a_value)
 {
 	switch (a_value.type()) {
@@ -97,6 +304,10 @@ void BinaryWriter::write_value(const TypedValue& a_value)
 	case type_void:
 		return write<uint8_t>(TypeId::type_void);
 	case type_any:
+		if (a_value.get_any()) {
+			// struct, copy its encoding
+			return write_encoded_struct(a_value.get_any());
+		}
 		return write<uint8_t>(TypeId::type_any);
 	case type_bool:
 		return write_value(a_value.get<bool>());
@@ -107,6 +318,8 @@ void BinaryWriter::write_value(const TypedValue& a_value)
 //	case type_error:
 	case type_float:
 		return write_value(a_value.get<float>());
+	case type_arraysize:
+		return write_value(a_value.get<arraysize_t>());
 	// pointer types
 	case type_uint8_ptr:
 		return write_value(a_value.get<uint8_t*>());
@@ -11,11 +11,45 @@
 
 #include "packet.h"
 #include "buffer.h"
+#include "compact.h"
+#include "delta.h"
 #include "../l0_system/types.h"
 #include "../l0_system/endianness.h"
 
 #include <stdlib.h>
 #include <iostream> // debugging
+#include <vector>
+#include <tuple>
+#include <type_traits>
+#include <cstring> // memcpy
+
+//------------------------------------------------------------------------------
+// defines
+//------------------------------------------------------------------------------
+//
+//! write strings with their length in front, so that receivers can skip them
+//! without scanning for the terminator. disable to talk to peers that only
+//! understand NUL-terminated strings
+#ifndef REMO_LENGTH_PREFIXED_STRINGS
+#define REMO_LENGTH_PREFIXED_STRINGS   1
+#endif
+
+//! write floating point values in the shortest of the compact encodings.
+//! disable to talk to peers that only understand the plain one
+#ifndef REMO_COMPACT_FLOATS
+#define REMO_COMPACT_FLOATS            1
+#endif
+
+//! write const integer arrays as differences between their items, if that
+//! is shorter. disable to talk to peers that only understand plain arrays
+#ifndef REMO_DELTA_ARRAYS
+#define REMO_DELTA_ARRAYS              1
+#endif
+
+//! minimum number of items for an array to be considered for delta encoding
+#ifndef REMO_DELTA_ARRAYS_MIN_COUNT
+#define REMO_DELTA_ARRAYS_MIN_COUNT    4
+#endif
 
 //------------------------------------------------------------------------------
 namespace remo {
@@ -23,9 +57,38 @@ namespace remo {
 //------------------------------------------------------------------------------	
 
 
+//------------------------------------------------------------------------------
+//
+//! upper bound of the bytes written for a value of the given type, if known
+//! at compile time, i.e. for scalars. zero for all others
+template<typename T>
+struct MaxWireSize {
+	static const size_t value = std::is_arithmetic<T>::value ? 1 + sizeof(T) : 0;
+};
+template<>
+struct MaxWireSize<bool> {
+	static const size_t value = 1;
+};
+
+//! sum of the upper bounds of the given types, zero if any of them has none
+template<typename... Ts>
+struct MaxWireSizeSum;
+template<>
+struct MaxWireSizeSum<> {
+	static const size_t value = 0;
+};
+template<typename T, typename... Ts>
+struct MaxWireSizeSum<T, Ts...> {
+	static const size_t head = MaxWireSize<typename std::decay<T>::type>::value;
+	static const size_t tail = MaxWireSizeSum<Ts...>::value;
+	static const size_t value = head && (tail || sizeof...(Ts) == 0) ? head + tail : 0;
+};
+
+//------------------------------------------------------------------------------
+
 class Writer {
 public:
-	Writer(Buffer& a_buffer);
+	Writer(RBuffer& a_buffer);
 
 	template<typename T>
 	void write(const T& a_value)
@@ -34,97 +97,277 @@ public:
 		sys::set_le(static_cast<T*>(m_buffer.grow(sizeof(a_value))), a_value);
 	}
 
+protected:
+	//! append the given number of bytes to the buffer and return a pointer to them
+	uint8_t* grow(size_t a_size)
+	{
+		return static_cast<uint8_t*>(m_buffer.grow(a_size));
+	}
+
+	//! like grow(), but nullptr if the bytes do not fit into the current segment
+	uint8_t* try_grow(size_t a_size)
+	{
+		return static_cast<uint8_t*>(m_buffer.try_grow(a_size));
+	}
+
+	//! reserve bytes for a value. small values are kept contiguous, even if
+	//! that leaves the rest of the current segment unused. for large ones, 
+	//! nullptr is returned if they do not fit, and they need to be append()ed
+	uint8_t* reserve(size_t a_size)
+	{
+		uint8_t* p = try_grow(a_size);
+		if (!p && a_size <= MAX_CONTIGUOUS_SIZE) {
+			p = grow(a_size);
+		}
+		return p;
+	}
+
+	//! append bytes that may continue in further segments
+	void append(const void* a_data, size_t a_size)
+	{
+		m_buffer.append(a_data, a_size);
+	}
+
+	//! number of bytes written so far
+	size_t get_offset() const
+	{
+		return m_buffer.get_total_size();
+	}
+
+	//! pointer to bytes written so far, starting at the given offset,
+	//! or nullptr if they are not within the current segment
+	uint8_t* get_written(size_t a_offset)
+	{
+		return m_buffer.access_tail(a_offset);
+	}
+
+	//! copy bytes written so far, and discard them
+	void take_written(size_t a_offset, std::vector<uint8_t>& o_data)
+	{
+		o_data.resize(get_offset() - a_offset);
+		m_buffer.copy_out(a_offset, o_data.data(), o_data.size());
+		m_buffer.truncate(a_offset);
+	}
+
+	//! give back bytes reserved by try_grow() but not written, i.e. between the
+	//! cursor they were written through and the end of the reservation
+	void commit(const uint8_t* a_cursor, const uint8_t* a_end)
+	{
+		m_buffer.shrink(static_cast<size_t>(a_end - a_cursor));
+	}
+
+	//! values up to this size are never split across segments
+	static const size_t MAX_CONTIGUOUS_SIZE = 64;
+
 private:
-	Buffer& m_buffer;
+	RBuffer& m_buffer;
 };
 
 class BinaryWriter: public Writer
 {
 public:
-	BinaryWriter(Buffer& a_buffer): Writer(a_buffer) {}
+	BinaryWriter(RBuffer& a_buffer): Writer(a_buffer) {}
 
 	template<typename... Args>
-	void write_call(const std::string a_function, Args... args)
+	void write_call(const std::string& a_function, Args&... args)
 	{
 		// write packet type
 		write<uint8_t>(PacketType::packet_call);
 		// write function name
-		write_value(a_function.c_str());
+		write_value(a_function);
 		// write arguments
 		REMO_FOREACH_ARG(args, write_value);
 	}
 
+	template<typename... Args>
+	void write_call(uint32_t a_function_id, Args&... args)
+	{
+		// all arguments scalar? then the message size is bounded at compile time
+		const size_t max_size = 1 + MaxWireSizeSum<uint32_t, Args...>::value;
+		if (max_size > 1) {
+			// yes -> reserve it at once, and write through a cursor without further checks
+			if (uint8_t* const begin = try_grow(max_size)) {
+				uint8_t* p = begin;
+				*p++ = PacketType::packet_call;
+				p = put_scalar(p, a_function_id);
+				int dummy[] = { 0,(p = put_scalar(p, args),0)... };
+				(void)dummy;
+				commit(p, begin + max_size);
+				return;
+			}
+		}
+
+		// write packet type
+		write<uint8_t>(PacketType::packet_call);
+		// write function id as obtained by a query
+		write_value(a_function_id);
+		// write arguments
+		REMO_FOREACH_ARG(args, write_value);
+	}
+
+	void write_query(const std::string& a_function);
+	void write_info(const std::string& a_function, bool a_found, uint32_t a_function_id);
+
 	void write_result(const TypedValue& a_result, const ArgList& a_args)
 	{
 		// write packet type
 		write<uint8_t>(PacketType::packet_result);
 		// write function result
 		write_value(a_result);
-		// write output parameters
+		// write output parameters, i.e. mutable pointers along with their array size
+		const TypedValue* arraysize = nullptr;
 		for (const TypedValue& arg : a_args) {
-			if (is_ptr_type(arg.type())) {
+			if (arg.type() == type_arraysize) {
+				arraysize = &arg;
+			} else if (is_ptr_type(arg.type())) {
+				if (arraysize) {
+					write_value(*arraysize);
+					arraysize = nullptr;
+				}
 				write_value(arg);
+			} else if (is_cptr_type(arg.type())) {
+				// const pointers are not written back, neither is their size
+				arraysize = nullptr;
 			}
 		}
 	}
 
-	// write scalar value
+	// write packet type and result of a call. to be followed by write_outparam()
 	template<typename T>
-	void write_value(const T& a_value)
+	void write_result_value(const T& a_result)
 	{
-		// make copy of value, as we need to modify and restore it
-		T value = a_value;
-		unsigned char* p = reinterpret_cast<unsigned char*>(&value);
-		
-		// determine number of leading non-zero bytes
-		uint8_t wire_size = 0;
-		LITTLE_ENDIAN_FOR(i, sizeof(value)) {
-			if (!value) {
-				break;
+		// scalar result? then reserve its upper bound at once, see write_call()
+		const size_t max_size = 1 + MaxWireSize<T>::value;
+		if (max_size > 1) {
+			if (uint8_t* const begin = try_grow(max_size)) {
+				uint8_t* p = begin;
+				*p++ = PacketType::packet_result;
+				p = put_scalar(p, a_result);
+				commit(p, begin + max_size);
+				return;
 			}
-			++wire_size;
-			p[i] = 0;
 		}
-		// restore value
-		value = a_value;
 
-		// write type info byte
-		write<uint8_t>((wire_size << 4) | TypeInfo<T>::id());
+		// write packet type
+		write<uint8_t>(PacketType::packet_result);
+		// write function result
+		write_value(a_result);
+	}
 
-		// output actual bytes		
-		LITTLE_ENDIAN_FOR(i, wire_size) {
-			write<uint8_t>(p[i]);
+	// write "out" parameter along with its array size, if it was received as mutable pointer
+	template<typename T>
+	void write_outparam(TypeId a_type, T* const& a_ptr)
+	{
+		if (!is_ptr_type(a_type)) {
+			// const pointer, not written back, neither is its size
+			m_has_outparam_arraysize = false;
+			return;
+		}
+		if (m_has_outparam_arraysize) {
+			write_value(m_outparam_arraysize);
+			m_has_outparam_arraysize = false;
 		}
+		write_array(a_type, a_ptr, sizeof(T));
 	}
 
-	// write array
-	template<typename T, int N>
-	void write_value(T(&a_array)[N]) {
-		static_assert(dependent_false<T>::value, "array types not yet supported by libremo");
+	// array size of a subsequent "out" parameter
+	void write_outparam(TypeId, const arraysize_t& a_size)
+	{
+		m_outparam_arraysize = a_size;
+		m_has_outparam_arraysize = true;
 	}
 
-	// write pointer
+	// struct received through a pointer, written back if it was mutable
 	template<typename T>
-	void write_value(T* a_ptr)
+	void write_outparam(TypeId a_type, const struct_ref<T>& a_ref)
 	{
-		// assume size of 1 if not specified
-		if (!m_has_arraysize) {
-			m_arraysize = 1;
+		if (is_ptr_type(a_type)) {
+			write<uint8_t>(a_type);
+			write_struct(a_ref.value);
 		}
+	}
+
+	// template used to filter out non-pointer types in "out" parameters
+	template<typename T>
+	void write_outparam(TypeId, const T&)
+	{
+	}
+
+	// write scalar value or struct
+	template<typename T>
+	void write_value(const T& a_value)
+	{
+		write_value(a_value, is_struct<T>());
+	}
+
+	// write scalar value
+	template<typename T>
+	void write_value(const T& a_value, std::false_type /* struct */)
+	{
+		// determine number of significant bytes
+		const uint64_t bits = compact_bits(a_value);
+		const size_t wire_size = compact_size(bits);
+
+		// reserve type info byte and actual bytes at once
+		uint8_t* p = grow(1 + wire_size);
 
-		// get pointer to array data
-		unsigned char* p = reinterpret_cast<unsigned char*>(a_ptr);
-		
 		// write type info byte
-		write<uint8_t>(TypeInfo<T*>::id());
+		p[0] = static_cast<uint8_t>((wire_size << 4) | TypeInfo<T>::id());
 
 		// output actual bytes
-		for (size_t j = 0; j < m_arraysize.value; j++) {
-			LITTLE_ENDIAN_FOR(i, sizeof(*a_ptr)) {
-				write<uint8_t>(p[i]);
-			}
-		}
-	}	
+		compact_store(p + 1, bits, wire_size);
+	}
+
+#if REMO_COMPACT_FLOATS
+	// write floating point value
+	void write_value(double a_value) { write_float(a_value); }
+	void write_value(float a_value) { write_float(a_value); }
+#endif
+
+	// write array of known size
+	template<typename T, size_t N>
+	void write_value(T(&a_array)[N])
+	{
+		write_value(arraysize_t(N));
+		write_array(TypeInfo<T*>::id(), a_array, sizeof(T));
+	}
+
+	// write vector as const array
+	template<typename T>
+	void write_value(const std::vector<T>& a_vector)
+	{
+		static_assert(!std::is_same<T, bool>::value, "std::vector<bool> is not contiguous");
+		write_value(arraysize_t(a_vector.size()));
+		write_value(a_vector.data());
+	}
+
+	// write pointer. taken by reference, so that arrays do not decay to it
+	template<typename T>
+	void write_value(T* const& a_ptr)
+	{
+		write_value(a_ptr, is_struct<T>());
+	}
+
+	template<typename T>
+	void write_value(T* a_ptr, std::false_type /* struct */)
+	{
+		write_array(TypeInfo<T*>::id(), a_ptr, sizeof(T));
+	}
+
+	// write pointer to struct, followed by the struct itself
+	template<typename T>
+	void write_value(T* a_ptr, std::true_type /* struct */)
+	{
+		write<uint8_t>(TypeInfo<T*>::id());
+		write_struct(*a_ptr);
+	}
+
+	// write struct registered by REMO_STRUCT or REMO_FIXED_STRUCT
+	template<typename T>
+	void write_value(const T& a_value, std::true_type /* struct */)
+	{
+		write_struct(a_value);
+	}
 
 	// write array size
 	void write_value(arraysize_t a_size);
@@ -132,6 +375,28 @@ public:
 	// write string
 	void write_value(char* a_string);
 	void write_value(const char* a_string);
+	void write_value(const std::string& a_string)
+	{
+		write_string(a_string.data(), a_string.size());
+	}
+#if REMO_HAS_STRING_VIEW
+	void write_value(std::string_view a_string)
+	{
+		write_string(a_string.data(), a_string.size());
+	}
+#endif
+
+	// write string literal or char array
+	template<size_t N>
+	void write_value(const char(&a_string)[N])
+	{
+		write_value(static_cast<const char*>(a_string));
+	}
+	template<size_t N>
+	void write_value(char(&a_string)[N])
+	{
+		write_value(static_cast<const char*>(a_string));
+	}
 	
 	// write boolean
 	void write_value(bool a_bool);
@@ -139,9 +404,131 @@ public:
 	// write typed value
 	void write_value(const TypedValue& a_value);
 
+protected:
+	template<typename T>
+	void write_struct(const T& a_value)
+	{
+		write_struct(a_value, std::integral_constant<bool, StructInfo<T>::is_fixed>());
+	}
+
+	// trivially copyable struct, copied as a whole
+	template<typename T>
+	void write_struct(const T& a_value, std::true_type /* fixed */)
+	{
+		const size_t wire_size = compact_size(sizeof(T));
+		uint8_t* p = reserve(1 + wire_size + sizeof(T));
+		if (!p) {
+			// large struct, may continue in further segments
+			p = grow(1 + wire_size);
+			p[0] = static_cast<uint8_t>((wire_size << 4) | TypeId::type_any);
+			compact_store(p + 1, sizeof(T), wire_size);
+			append(&a_value, sizeof(T));
+			return;
+		}
+		p[0] = static_cast<uint8_t>((wire_size << 4) | TypeId::type_any);
+		compact_store(p + 1, sizeof(T), wire_size);
+		std::memcpy(p + 1 + wire_size, &a_value, sizeof(T));
+	}
+
+	// struct written field by field, each one in its compact encoding
+	template<typename T>
+	void write_struct(const T& a_value, std::false_type /* fixed */)
+	{
+		typedef decltype(StructInfo<T>::fields()) Fields;
+		const size_t start = get_offset();
+		write_fields(a_value, StructInfo<T>::fields(), 
+			make_index_sequence<std::tuple_size<Fields>::value>());
+		insert_struct_header(start);
+	}
+
+	template<typename T, typename Fields, size_t... Is>
+	void write_fields(const T& a_value, const Fields& a_fields, index_sequence<Is...>)
+	{
+		// NOTE: the "0," avoids the "ISO C++ forbids zero-size array" pendantic warning
+		int dummy[] = { 0,(write_value(a_value.*std::get<Is>(a_fields)),0)... };
+		(void)dummy;
+	}
+
+	void insert_struct_header(size_t a_start);
+	void write_encoded_struct(const uint8_t* a_encoded);
+
+	template<typename T>
+	void write_float(T a_value)
+	{
+		// choose encoding
+		uint8_t header = 0;
+		size_t wire_size = 0;
+		const uint64_t bits = compact_encode(a_value, header, wire_size);
+
+		// write type info byte and actual bytes
+		uint8_t* p = grow(1 + wire_size);
+		p[0] = header;
+		compact_store(p + 1, bits, wire_size);
+	}
+
+	//! write scalar value through a cursor that has room for MaxWireSize<T> bytes.
+	//! returns the cursor advanced by the bytes written. non-scalars never get here
+	template<typename T>
+	static uint8_t* put_scalar(uint8_t* a_cursor, const T& a_value)
+	{
+		return put_scalar(a_cursor, a_value, std::is_arithmetic<T>());
+	}
+
+	template<typename T>
+	static uint8_t* put_scalar(uint8_t* a_cursor, const T& a_value, std::true_type /* arithmetic */)
+	{
+		const uint64_t bits = compact_bits(a_value);
+		const size_t wire_size = compact_size(bits);
+		a_cursor[0] = static_cast<uint8_t>((wire_size << 4) | TypeInfo<T>::id());
+		compact_store(a_cursor + 1, bits, wire_size);
+		return a_cursor + 1 + wire_size;
+	}
+
+	template<typename T>
+	static uint8_t* put_scalar(uint8_t* a_cursor, const T&, std::false_type /* arithmetic */)
+	{
+		return a_cursor;
+	}
+
+	static uint8_t* put_scalar(uint8_t* a_cursor, bool a_bool, std::true_type /* arithmetic */)
+	{
+		a_cursor[0] = static_cast<uint8_t>(((a_bool & 1) << 4) | TypeId::type_bool);
+		return a_cursor + 1;
+	}
+
+#if REMO_COMPACT_FLOATS
+	template<typename T>
+	static uint8_t* put_float(uint8_t* a_cursor, T a_value)
+	{
+		uint8_t header = 0;
+		size_t wire_size = 0;
+		const uint64_t bits = compact_encode(a_value, header, wire_size);
+		a_cursor[0] = header;
+		compact_store(a_cursor + 1, bits, wire_size);
+		return a_cursor + 1 + wire_size;
+	}
+	static uint8_t* put_scalar(uint8_t* a_cursor, double a_value, std::true_type /* arithmetic */)
+	{
+		return put_float(a_cursor, a_value);
+	}
+	static uint8_t* put_scalar(uint8_t* a_cursor, float a_value, std::true_type /* arithmetic */)
+	{
+		return put_float(a_cursor, a_value);
+	}
+#endif
+
+	void write_string(const char* a_data, size_t a_length);
+	void write_array(TypeId a_type, const void* a_data, size_t a_item_size);
+	void append_items(const void* a_data, size_t a_count, size_t a_item_size);
+	bool write_delta_array(TypeId a_type, const void* a_data, size_t a_count, size_t a_item_size, 
+		size_t a_plain_size);
+
 private:
 	bool m_has_arraysize = false;
 	arraysize_t m_arraysize = {};
+	//! array size of the next "out" parameter
+	bool m_has_outparam_arraysize = false;
+	arraysize_t m_outparam_arraysize = {};
 };
 
 //------------------------------------------------------------------------------
@@ -67,9 +67,9 @@ void function::check_args(const ArgList& args)
         m_param_types.size(), args.size());
 
     // check if argument and parameter types match
-    // TODO allow cast here? For now we do an exact match
+    // TODO allow cast here? For now we do an exact match, except for T* -> const T*
     for (size_t i = 0; i < m_param_types.size(); i++) {
-        REMO_THROW_IF(args[i].type() != m_param_types[i], 
+        REMO_THROW_IF(!is_convertible_type(args[i].type(), m_param_types[i]), 
             ErrorCode::ERR_PARAM_TYPE_MISMATCH, 
             "cannot convert '%s' to '%s' for argument %zu to remote function '%s'",
             get_type_name(args[i].type()), get_type_name(m_param_types[i]),
@@ -79,6 +79,51 @@ void function::check_args(const ArgList& args)
 
 
 //------------------------------------------------------------------------------
+//
+TypeId function::read_arg_type(trans::BinaryReader& a_reader, size_t a_index, uint8_t& o_modifier)
+{
+    // check number of arguments
+    REMO_THROW_IF(!a_reader.has_more(),
+        ErrorCode::ERR_PARAM_NUM_MISMATCH, 
+        "Parameter number mismatch: expected %zu, got %zu",
+        m_param_types.size(), a_index);
+
+    // check if argument and parameter types match
+    TypeId type = a_reader.read_type(o_modifier);
+    REMO_THROW_IF(!is_convertible_type(type, m_param_types[a_index]), 
+        ErrorCode::ERR_PARAM_TYPE_MISMATCH, 
+        "cannot convert '%s' to '%s' for argument %zu to remote function '%s'",
+        get_type_name(type), get_type_name(m_param_types[a_index]),
+        a_index+1, to_string().c_str());
+
+    return type;
+}
+
+//------------------------------------------------------------------------------
+//
+void function::check_args_end(trans::BinaryReader& a_reader)
+{
+    // any excess arguments?
+    if (a_reader.has_more()) {
+        // yes -> count them for the error message
+        size_t count = m_param_types.size();
+        while (a_reader.has_more()) {
+            a_reader.read_typed_value();
+            count++;
+        }
+        REMO_THROW(ErrorCode::ERR_PARAM_NUM_MISMATCH, 
+            "Parameter number mismatch: expected %zu, got %zu",
+            m_param_types.size(), count);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+void function::unsupported_result()
+{
+    REMO_THROW(ErrorCode::ERR_INVALID_VALUE_TYPE, 
+        "%s: struct results cannot be returned by a generic call", get_name().c_str());
+}
 
 //------------------------------------------------------------------------------
 } // end namespace remo
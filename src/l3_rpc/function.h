@@ -11,6 +11,10 @@
 
 #include "item.h"
 #include "dynamic_call.h"
+#include "static_call.h"
+
+#include "../l1_transport/reader.h"
+#include "../l1_transport/writer.h"
 
 //------------------------------------------------------------------------------
 namespace remo {
@@ -31,11 +35,75 @@ public:
 protected:
 	void check_args(const ArgList& args);
 
+	TypeId read_arg_type(trans::BinaryReader& a_reader, size_t a_index, uint8_t& o_modifier);
+	void check_args_end(trans::BinaryReader& a_reader);
+	void unsupported_result();
+
+	// read argument of type known at compile time, checking its type on the fly
+	template<typename T>
+	T read_arg(trans::BinaryReader& a_reader, size_t a_index, TypeId& o_type)
+	{
+		uint8_t modifier = 0;
+		o_type = read_arg_type(a_reader, a_index, modifier);
+		return a_reader.read_static<T>(modifier);
+	}
+
+	// decode arguments straight from the packet, call function and write result
+	template<typename Func, typename Ret, typename... Arg, size_t... Is>
+	void static_dispatch(Func& a_func, trans::BinaryReader& a_reader, trans::BinaryWriter& a_writer,
+		index_sequence<Is...>)
+	{
+		// received argument types. one extra element to avoid a zero-size array
+		TypeId types[sizeof...(Arg) + 1];
+		// NOTE: braced initialization guarantees left-to-right evaluation order
+		std::tuple<typename arg_storage<Arg>::type...> args {
+			read_arg<typename arg_storage<Arg>::type>(a_reader, Is, types[Is])... };
+		check_args_end(a_reader);
+		static_call<Ret>(a_func, types, args, a_writer, index_sequence<Is...>(), std::is_void<Ret>());
+	}
+
+	// convert result for generic calls
+	template<typename T>
+	TypedValue make_result(const T& a_result)
+	{
+		return make_result(a_result, is_struct<T>());
+	}
+
+	template<typename T>
+	TypedValue make_result(const T& a_result, std::false_type /* struct */)
+	{
+		return TypedValue(a_result);
+	}
+
+	// structs are only returned by dispatch(), as they need to be encoded
+	template<typename T>
+	TypedValue make_result(const T&, std::true_type /* struct */)
+	{
+		unsupported_result();
+		return TypedValue(TypeId::type_any);
+	}
+
+	// strings are kept until the next call, as the typed value only points to them
+	TypedValue make_result(const std::string& a_result)
+	{
+		m_string_result = a_result;
+		return TypedValue(m_string_result.c_str());
+	}
+
+#if REMO_HAS_STRING_VIEW
+	TypedValue make_result(std::string_view a_result)
+	{
+		return make_result(std::string(a_result));
+	}
+#endif
+
 	virtual const char* item_type() override { return "function"; }
 
 protected:
 	TypeId m_result_type;
 	TypeList m_param_types;
+	//! storage for string results of generic calls
+	std::string m_string_result;
 };
 
 //------------------------------------------------------------------------------
@@ -55,7 +123,13 @@ public:
 	virtual TypedValue call(const ArgList& args) override
 	{
 		check_args(args);
-		return TypedValue(dynamic_call<decltype(m_func), Ret, Arg...>(m_func, args));
+		return make_result(dynamic_call<decltype(m_func), Ret, Arg...>(m_func, args));
+	}
+
+	virtual void dispatch(trans::BinaryReader& a_reader, trans::BinaryWriter& a_writer) override
+	{
+		static_dispatch<decltype(m_func), Ret, Arg...>(m_func, a_reader, a_writer,
+			make_index_sequence<sizeof...(Arg)>());
 	}
 
 private:
@@ -81,6 +155,11 @@ public:
 		return call(args, &Lambda::operator());
 	}
 
+	virtual void dispatch(trans::BinaryReader& a_reader, trans::BinaryWriter& a_writer) override
+	{
+		dispatch(a_reader, a_writer, &Lambda::operator());
+	}
+
 
 // helper overloads to capture result and parameter types
 private:
@@ -94,7 +173,7 @@ private:
 	template<typename Class, typename Ret, typename... Args>
 	TypedValue call(const ArgList& args, Ret (Class::*)(Args...) const)
 	{
-		return TypedValue(dynamic_call<Lambda, Ret, Args...>(m_lambda, args));
+		return make_result(dynamic_call<Lambda, Ret, Args...>(m_lambda, args));
 	}
 
 	template<typename Class, typename... Args>
@@ -104,6 +183,13 @@ private:
 		return TypedValue(TypeId::type_void);
 	}
 
+	template<typename Class, typename Ret, typename... Args>
+	void dispatch(trans::BinaryReader& a_reader, trans::BinaryWriter& a_writer, Ret (Class::*)(Args...) const)
+	{
+		static_dispatch<Lambda, Ret, Args...>(m_lambda, a_reader, a_writer,
+			make_index_sequence<sizeof...(Args)>());
+	}
+
 
 private:
 	Lambda m_lambda;
@@ -10,6 +10,8 @@
 #include "item.h"
 
 #include "local_endpoint.h"
+#include "../l1_transport/reader.h"
+#include "../l1_transport/writer.h"
 #include "utils/logger.h"
 
 
@@ -27,6 +29,7 @@ static Logger logger("Item");
 //
 Item::Item(const std::string& a_name):
     m_endpoint(nullptr), 
+    m_id(INVALID_ITEM_ID),
     m_name(a_name)
 {
     // check item name
@@ -45,6 +48,16 @@ Item::~Item()
     }
 }
 
+//------------------------------------------------------------------------------
+//
+void Item::dispatch(trans::BinaryReader& a_reader, trans::BinaryWriter& a_writer)
+{
+    // generic implementation: decode arguments, call and write result
+    a_reader.read_args();
+    TypedValue result = call(a_reader.get_args());
+    a_writer.write_result(result, a_reader.get_args());
+}
+
 //------------------------------------------------------------------------------
 //
 std::string Item::get_full_name() const
@@ -12,6 +12,7 @@
 #include "../l0_system/types.h"
 
 #include <string>
+#include <stdint.h>
 
 //------------------------------------------------------------------------------
 namespace remo {
@@ -19,6 +20,16 @@ namespace remo {
 
 // forward declaration
 class LocalEndpoint;
+namespace trans {
+	class BinaryReader;
+	class BinaryWriter;
+}
+
+//! identifies an item within its endpoint. transmitted instead of the name
+typedef uint32_t ItemId;
+
+//! id of an item that is not registered
+const ItemId INVALID_ITEM_ID = UINT32_MAX;
 
 //------------------------------------------------------------------------------
 // class definition
@@ -30,10 +41,12 @@ public:
 	virtual ~Item();
 
 	virtual TypedValue call(const ArgList& args) = 0;
+	virtual void dispatch(trans::BinaryReader& a_reader, trans::BinaryWriter& a_writer);
 
 	virtual std::string to_string() const;
 
 	const std::string& get_name() const { return m_name; }
+	ItemId get_id() const { return m_id; }
 	std::string get_full_name() const;
 
 	static bool is_valid_name(const std::string& a_name);
@@ -41,6 +54,7 @@ public:
 protected:
 	friend class LocalEndpoint;
 	void set_endpoint(LocalEndpoint* a_endpoint) { m_endpoint = a_endpoint; }
+	void set_id(ItemId a_id) { m_id = a_id; }
 	const LocalEndpoint* get_endpoint() const { return m_endpoint; }
 
 protected:
@@ -50,6 +64,8 @@ protected:
 private:
 	//! endpoint to which this item belongs
 	LocalEndpoint* m_endpoint;
+	//! id assigned by the endpoint
+	ItemId m_id;
 	//! item name
 	std::string m_name;
 };
@@ -10,6 +10,7 @@
 #include "local_endpoint.h"
 
 #include "remote_endpoint.h"
+#include "../l1_transport/reader.h"
 #include "utils/logger.h"
 
 
@@ -28,6 +29,7 @@ static Logger logger("LocalEndpoint");
 LocalEndpoint::LocalEndpoint():
 	Endpoint(),
 	m_items(),
+	m_items_by_id(),
 	m_remotes()
 {
 }
@@ -74,6 +76,10 @@ void LocalEndpoint::register_item(Item* a_item)
         "%s with same name already exists: '%s'",
         ret.first->second->item_type(), ret.first->first.c_str());
 
+    // assign next id
+    a_item->set_id(static_cast<ItemId>(m_items_by_id.size()));
+    m_items_by_id.push_back(a_item);
+
     // remember us
     a_item->set_endpoint(this);
 
@@ -98,6 +104,10 @@ void LocalEndpoint::unregister_item(Item* a_item)
         "%s not found for unregistration: '%s'",
         a_item->item_type(), a_item->get_full_name().c_str());    
 
+    // release id. it is not reused, so that stale ids cannot hit another item
+    m_items_by_id[a_item->get_id()] = nullptr;
+    a_item->set_id(INVALID_ITEM_ID);
+
     // forget us
     a_item->set_endpoint(nullptr);
 
@@ -114,6 +124,7 @@ void LocalEndpoint::clear_items()
         delete it->second;
     }
     m_items.clear();
+    m_items_by_id.clear();
 }
 
 //------------------------------------------------------------------------------	
@@ -124,6 +135,13 @@ Item* LocalEndpoint::find_item(const std::string& a_full_name)
     return it != m_items.end() ? it->second : nullptr;
 }
 
+//------------------------------------------------------------------------------	
+//
+Item* LocalEndpoint::find_item(ItemId a_id)
+{
+    return a_id < m_items_by_id.size() ? m_items_by_id[a_id] : nullptr;
+}
+
 //------------------------------------------------------------------------------
 //
 TypedValue LocalEndpoint::call(const std::string& a_func_name, const ArgList& args)
@@ -139,6 +157,46 @@ TypedValue LocalEndpoint::call(const std::string& a_func_name, const ArgList& ar
     return item->call(args);	
 }
 
+//------------------------------------------------------------------------------
+//
+TypedValue LocalEndpoint::call(ItemId a_func_id, const ArgList& args)
+{
+    // get function item
+    Item* item = find_item(a_func_id);
+    REMO_THROW_IF(!item,
+        ErrorCode::ERR_RPC_NOT_FOUND, 
+        "remote procedure not found: #%u",
+        a_func_id);
+
+    // call it
+    return item->call(args);	
+}
+
+//------------------------------------------------------------------------------
+//
+void LocalEndpoint::dispatch(trans::BinaryReader& a_reader, trans::BinaryWriter& a_writer)
+{
+    // get function item
+    a_reader.read_call_header();
+    Item* item = nullptr;
+    if (a_reader.has_function_id()) {
+        item = find_item(a_reader.get_function_id());
+        REMO_THROW_IF(!item,
+            ErrorCode::ERR_RPC_NOT_FOUND, 
+            "remote procedure not found: #%u",
+            a_reader.get_function_id());
+    } else {
+        item = find_item(a_reader.get_function());
+        REMO_THROW_IF(!item,
+            ErrorCode::ERR_RPC_NOT_FOUND, 
+            "remote procedure not found: '%s'",
+            a_reader.get_function().c_str());
+    }
+
+    // decode arguments, call it and write result
+    item->dispatch(a_reader, a_writer);
+}
+
 //------------------------------------------------------------------------------
 //
 void LocalEndpoint::add_remote(RemoteEndpoint* a_remote)
@@ -50,6 +50,7 @@ protected:
 	void unregister_item(Item* a_item);
 	void clear_items();
 	Item* find_item(const std::string& a_full_name);
+	Item* find_item(ItemId a_id);
 
 	void add_remote(RemoteEndpoint* a_remote);
 	void clear_remotes();
@@ -57,10 +58,14 @@ protected:
 protected:
 	friend class RemoteEndpoint;
 	TypedValue call(const std::string& a_func_name, const ArgList& args);
+	TypedValue call(ItemId a_func_id, const ArgList& args);
+	void dispatch(trans::BinaryReader& a_reader, trans::BinaryWriter& a_writer);
 
 private:
 	//! container for looking up items by full name
 	std::unordered_map<std::string, Item*> m_items;	
+	//! container for looking up items by id. ids are not reused
+	std::vector<Item*> m_items_by_id;
 	//! list of remote endpoints that represent this endpoint to the outside
 	std::vector<RemoteEndpoint*> m_remotes;
 };
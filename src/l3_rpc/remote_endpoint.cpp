@@ -14,6 +14,8 @@
 #include "../l1_transport/writer.h"
 #include "utils/logger.h"
 
+#include <cstring> // memset
+
 
 //------------------------------------------------------------------------------
 namespace remo {
@@ -22,15 +24,8 @@ namespace remo {
 //! logger instance
 static Logger logger("RemoteEndpoint");
 
-
-//------------------------------------------------------------------------------	
-// constants
-//------------------------------------------------------------------------------	
-//
-//! maximum number of packets available
-//! NOTE: this was selected as an arbitrary value and probably depends
-//!       on the "concurrencyness" of the system (e.g. max. number of threads)
-const size_t PACKET_POOL_SIZE = 16;
+//! alignment of replies written after the call in the same packet
+static const size_t REPLY_ALIGNMENT = 8;
 
 
 //------------------------------------------------------------------------------
@@ -42,7 +37,6 @@ RemoteEndpoint::RemoteEndpoint(LocalEndpoint* a_local):
 	m_local(a_local),
 	m_packet_pool()
 {
-	alloc_packets();
 }
 
 //------------------------------------------------------------------------------
@@ -88,6 +82,12 @@ void RemoteEndpoint::handle_packet(packet_ptr& a_packet)
     case trans::PacketType::packet_result:
         handle_result(a_packet);
         break;
+    case trans::PacketType::packet_query:
+        handle_query(a_packet);
+        break;
+    case trans::PacketType::packet_info:
+        handle_info(a_packet);
+        break;
     default:
         REMO_WARN("ignoring packet of unknown type 0x%02X", type);
     }
@@ -97,16 +97,29 @@ void RemoteEndpoint::handle_packet(packet_ptr& a_packet)
 //
 void RemoteEndpoint::handle_call(packet_ptr& a_packet)
 {
-    trans::BinaryReader reader(a_packet->get_payload());
-    reader.read_call();
-
-    // call it
-    TypedValue result = m_local->call(reader.get_function(), reader.get_args());
+    // reads are range-checked, so a malformed call fails before it is dispatched
+    trans::RBuffer& payload = a_packet->get_payload();
+    trans::BinaryReader reader(payload);
+
+    // room for the reply after the call? it starts aligned like the call, so that arrays stay aligned
+    const size_t call_size = (payload.get_size() + REPLY_ALIGNMENT - 1) & ~(REPLY_ALIGNMENT - 1);
+    if (a_packet->get_buffer_size() > 0 && !payload.get_next() && call_size < payload.get_capacity()) {
+        // yes -> reply in place. arguments still refer to the call while the reply is written
+        std::memset(payload.grow(call_size - payload.get_size()), 0, call_size - payload.get_size());
+        trans::BinaryWriter reply_writer(payload);
+        m_local->dispatch(reader, reply_writer);
+        // then drop the call, leaving the reply
+        a_packet->drop_front(call_size);
+        send_packet(a_packet);
+        return;
+    }
 
+    // no -> reply in a packet of its own
     packet_ptr reply = take_packet();
     trans::BinaryWriter reply_writer(reply->get_payload());
 
-    reply_writer.write_result(result, reader.get_args());
+    // call it
+    m_local->dispatch(reader, reply_writer);
 
     send_packet(reply);
     
@@ -122,22 +135,69 @@ void RemoteEndpoint::handle_result(packet_ptr& a_packet)
 
 //------------------------------------------------------------------------------	
 //
-void RemoteEndpoint::alloc_packets()
+void RemoteEndpoint::handle_query(packet_ptr& a_packet)
+{
+    trans::BinaryReader reader(a_packet->get_payload());
+    reader.read_query();
+
+    // look up function
+    Item* item = m_local->find_item(reader.get_function());
+
+    // reply with its id
+    packet_ptr reply = take_packet();
+    trans::BinaryWriter reply_writer(reply->get_payload());
+    reply_writer.write_info(reader.get_function(), item != nullptr, 
+        item ? item->get_id() : INVALID_ITEM_ID);
+
+    send_packet(reply);
+}
+
+//------------------------------------------------------------------------------	
+//
+void RemoteEndpoint::handle_info(packet_ptr& a_packet)
 {
-    // pre-allocate packets
-    for (size_t i = 0; i < PACKET_POOL_SIZE; i++) {
-        m_packet_pool.add(new trans::Packet());
+    trans::BinaryReader reader(a_packet->get_payload());
+    ItemId id = INVALID_ITEM_ID;
+    // names unknown are remembered as well, so that they are not queried on every call
+    if (!reader.read_info(id)) {
+        id = INVALID_ITEM_ID;
     }
+    m_function_ids[reader.get_function()] = id;
+}
+
+//------------------------------------------------------------------------------	
+//
+ItemId RemoteEndpoint::resolve(const std::string& a_function)
+{
+    // already known, or known to be missing?
+    auto it = m_function_ids.find(a_function);
+    if (it != m_function_ids.end()) {
+        // yes -> done
+        return it->second;
+    }
+
+    // query remote side. the reply is handled by handle_info()
+    packet_ptr query = take_packet();
+    trans::BinaryWriter writer(query->get_payload());
+    writer.write_query(a_function);
+    send_packet(query);
+
+    // got it?
+    it = m_function_ids.find(a_function);
+    return it != m_function_ids.end() ? it->second : INVALID_ITEM_ID;
 }
 
 //------------------------------------------------------------------------------
 //
-packet_ptr RemoteEndpoint::take_packet()
+packet_ptr RemoteEndpoint::take_packet(size_t a_payload_size)
 {
-	packet_ptr packet(m_packet_pool.take());
+	packet_ptr packet(m_packet_pool.take(a_payload_size));
+    // calls cannot go on without a packet, so the wait timing out is an error
     REMO_THROW_IF(!packet, 
         ErrorCode::ERR_OUT_OF_PACKETS, 
-        "out of packets. maybe some transport plugin leaking?");
+        "out of packets after waiting %d ms, %zu in use. maybe some transport plugin leaking?",
+        m_packet_pool.get_limits(trans::PacketPool::get_size_class(a_payload_size)).wait_timeout_ms,
+        m_packet_pool.get_size());
 	return packet;
 }
 
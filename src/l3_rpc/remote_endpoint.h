@@ -10,8 +10,13 @@
 #pragma once
 
 #include "endpoint.h"
+#include "item.h"
 
 #include "../l1_transport/packet.h"
+#include "../l1_transport/reader.h"
+#include "../l1_transport/packet_pool.h"
+
+#include <unordered_map>
 
 
 //------------------------------------------------------------------------------
@@ -35,10 +40,16 @@ public:
 	virtual ~RemoteEndpoint();
 
 	template<typename... Args>
-	TypedValue call(const std::string& a_function, Args... args);
+	TypedValue call(const std::string& a_function, Args&&... args);
 
 protected:
-	packet_ptr take_packet();
+	//! send a call by id, or by name if the id is invalid, and read its result
+	template<typename... Args>
+	TypedValue invoke(ItemId a_id, const std::string& a_function, Args&... args);
+
+	packet_ptr take_packet(size_t a_payload_size = 0);
+
+	ItemId resolve(const std::string& a_function);
 
 	void send_packet(packet_ptr& a_packet);
 	void receive_packet(packet_ptr& a_packet);
@@ -46,17 +57,23 @@ protected:
 	void handle_packet(packet_ptr& a_packet);
 	void handle_call(packet_ptr& a_packet);
 	void handle_result(packet_ptr& a_packet);
-
-private:
-	void alloc_packets();
+	void handle_query(packet_ptr& a_packet);
+	void handle_info(packet_ptr& a_packet);
 
 private:
 	//! the local endpoint that this endpoint represents to the outside
 	LocalEndpoint* m_local;
 	//! packet pool to avoid heap allocations
-	RecyclingPool<trans::Packet> m_packet_pool;
+	trans::PacketPool m_packet_pool;
 	//! TODO use some data structure
 	packet_ptr m_received_result {};
+	//! reply to the last call, referenced by its result
+	packet_ptr m_last_reply {};
+	//! values of the last reply that the reader had to copy, e.g. as they spanned segments
+	trans::Reader::Storage m_last_reply_storage {};
+	//! function ids obtained from the remote side, so that calls need not carry the name.
+	//! INVALID_ITEM_ID for names unknown there, which are called by name without querying
+	std::unordered_map<std::string, ItemId> m_function_ids;
 
 };
 
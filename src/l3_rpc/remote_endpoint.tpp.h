@@ -22,19 +22,54 @@ namespace remo {
 //------------------------------------------------------------------------------
 //
 template<typename... Args>
-TypedValue RemoteEndpoint::call(const std::string& a_function, Args... args)
+TypedValue RemoteEndpoint::call(const std::string& a_function, Args&&... args)
+{
+    // determine function id
+    ItemId id = resolve(a_function);
+    if (id != INVALID_ITEM_ID) {
+        try {
+            return invoke(id, a_function, args...);
+        } catch (const error& e) {
+            if (e.code() != ErrorCode::ERR_RPC_NOT_FOUND) {
+                throw;
+            }
+            // registered anew under another id meanwhile? ids are not reused, so
+            // forget this one and retry once by name
+            m_function_ids.erase(a_function);
+        }
+    }
+
+    // unknown to remote side, let it fail there
+    TypedValue result = invoke(INVALID_ITEM_ID, a_function, args...);
+    // known after all, so its id is worth querying again next time
+    m_function_ids.erase(a_function);
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//
+template<typename... Args>
+TypedValue RemoteEndpoint::invoke(ItemId a_id, const std::string& a_function, Args&... args)
 {
     packet_ptr packet = take_packet();
     trans::BinaryWriter writer(packet->get_payload());
-    writer.write_call(a_function, args...);
+    if (a_id != INVALID_ITEM_ID) {
+        writer.write_call(a_id, args...);
+    } else {
+        writer.write_call(a_function, args...);
+    }
 
     send_packet(packet);
     //receive_packet(&packet);
 
-    packet_ptr reply = std::move(m_received_result);
+    // keep reply until the next call, as strings and arrays in the result point into it
+    m_last_reply = std::move(m_received_result);
 
-    trans::BinaryReader reader(reply->get_payload());
-    return reader.read_result(args...);
+    trans::BinaryReader reader(m_last_reply->get_payload());
+    TypedValue result = reader.read_result(args...);
+    // the same goes for values copied by the reader. those of the previous reply are released
+    reader.swap_storage(m_last_reply_storage);
+    return result;
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "../l0_system/types.h"
+#include "../l1_transport/writer.h"
+
+#include <tuple>
+#include <type_traits>
+
+
+//------------------------------------------------------------------------------
+namespace remo {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// struct definition
+//------------------------------------------------------------------------------
+//
+//! storage type of a decoded argument. structs received through a pointer
+//! need a place to live during the call
+template<typename T>
+struct arg_storage { typedef T type; };
+
+template<typename T>
+struct arg_storage<T*> {
+    typedef typename std::conditional<is_struct<T>::value, struct_ref<T>, T*>::type type;
+};
+
+//------------------------------------------------------------------------------
+// functions
+//------------------------------------------------------------------------------
+//
+/*
+    write the "out" parameters of a call. the types are the ones received,
+    so that pointers are written back if and only if the caller passed them
+    as mutable.
+*/
+template <typename Tuple, size_t... Is>
+void static_write_outparams(const TypeId* a_types, Tuple& a_args, trans::BinaryWriter& a_writer,
+    index_sequence<Is...>)
+{
+    // NOTE: the "0," avoids the "ISO C++ forbids zero-size array" pendantic warning
+    int dummy[] = { 0,(a_writer.write_outparam(a_types[Is], std::get<Is>(a_args)),0)... };
+    (void)dummy;
+}
+
+//------------------------------------------------------------------------------
+//
+/*
+    call function with arguments stored in a tuple and write the result
+    along with the "out" parameters.
+*/
+template <typename Ret, typename Func, typename Tuple, size_t... Is>
+void static_call(Func& a_func, const TypeId* a_types, Tuple& a_args, trans::BinaryWriter& a_writer,
+    index_sequence<Is...>, std::false_type /* void result */)
+{
+    Ret result = a_func(std::get<Is>(a_args)...);
+    a_writer.write_result_value(result);
+    static_write_outparams(a_types, a_args, a_writer, index_sequence<Is...>());
+}
+
+//------------------------------------------------------------------------------
+//
+template <typename Ret, typename Func, typename Tuple, size_t... Is>
+void static_call(Func& a_func, const TypeId* a_types, Tuple& a_args, trans::BinaryWriter& a_writer,
+    index_sequence<Is...>, std::true_type /* void result */)
+{
+    a_func(std::get<Is>(a_args)...);
+    a_writer.write_result_value(TypedValue(TypeId::type_void));
+    static_write_outparams(a_types, a_args, a_writer, index_sequence<Is...>());
+}
+
+//------------------------------------------------------------------------------
+} // end namespace remo
+//------------------------------------------------------------------------------
@@ -11,6 +11,7 @@
 
 #include "l3_rpc/local_endpoint.h"
 #include "l3_rpc/remote_endpoint.h"
+#include "l1_transport/struct.h"
 
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,200 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "recycling.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+#include <stddef.h>
+
+//------------------------------------------------------------------------------
+namespace remo {
+//------------------------------------------------------------------------------
+
+//! limits of an elastic pool
+struct PoolLimits {
+	//! objects allocated in advance, and kept when idle
+	size_t low_watermark = 16;
+	//! maximum number of objects, taken or not
+	size_t high_watermark = 1024;
+	//! time to wait for an object to be recycled at the ceiling, zero to not wait at all
+	int wait_timeout_ms = 1000;
+};
+
+//! counters of an elastic pool
+struct PoolStats {
+	//! objects currently allocated, taken or not
+	size_t size;
+	//! maximum number of objects allocated at once
+	size_t peak_size;
+	//! number of times an object had to be waited for
+	size_t waits;
+};
+
+//------------------------------------------------------------------------------
+
+/**
+ * Pool that allocates objects on demand
+ *
+ * Objects are allocated when the pool runs dry, up to the high watermark.
+ * When recycled while more than the low watermark objects are idle, they
+ * are destroyed instead, so that the pool shrinks back after a burst.
+ * At the ceiling, take() waits for an object to be recycled, and gives up
+ * after a timeout by returning nullptr.
+ *
+ * Taking and recycling objects stays lock-free as long as the pool neither
+ * grows nor runs dry.
+ */
+template<typename Recyclable>
+class ElasticPool: public RecyclingPool<Recyclable> {
+public:
+	typedef RecyclingPool<Recyclable> Base;
+	//! function that allocates a new object, default constructed if empty
+	typedef std::function<Recyclable*()> Factory;
+
+	ElasticPool(const PoolLimits& a_limits = PoolLimits(), const Factory& a_factory = Factory()):
+		Base(),
+		m_limits(a_limits),
+		m_factory(a_factory),
+		m_size(0),
+		m_peak_size(0),
+		m_waits(0),
+		m_idle(0),
+		m_waiters(0),
+		m_wait_lock(),
+		m_wait_cond()
+	{
+		// allocate objects in advance
+		for (size_t i = 0; i < m_limits.low_watermark; i++) {
+			add(create());
+		}
+		m_size = m_peak_size = m_limits.low_watermark;
+	}
+
+	//! take an object, waiting for one at the ceiling. nullptr if the wait timed out
+	Recyclable* take()
+	{
+		Recyclable* object = try_take();
+		if (object || m_limits.wait_timeout_ms <= 0) {
+			return object;
+		}
+
+		// wait for an object to be recycled
+		m_waits.fetch_add(1, std::memory_order_relaxed);
+		const auto deadline = std::chrono::steady_clock::now()
+			+ std::chrono::milliseconds(m_limits.wait_timeout_ms);
+		std::unique_lock<std::mutex> lock(m_wait_lock);
+		m_waiters.fetch_add(1);
+		while (!(object = try_take())) {
+			const auto now = std::chrono::steady_clock::now();
+			if (now >= deadline) {
+				break;
+			}
+			// wake up now and then, in case a notification came in between
+			m_wait_cond.wait_for(lock, std::min<std::chrono::steady_clock::duration>(
+				deadline - now, std::chrono::milliseconds(10)));
+		}
+		m_waiters.fetch_sub(1);
+		return object;
+	}
+
+	//! take an object without waiting. nullptr if the pool is at the ceiling
+	Recyclable* try_take()
+	{
+		Recyclable* object = Base::take();
+		if (object) {
+			m_idle.fetch_sub(1, std::memory_order_relaxed);
+			return object;
+		}
+		return grow();
+	}
+
+	virtual void add(Recyclable* a_object) override
+	{
+		// more objects idle than needed, and no one waiting?
+		if (m_idle.load(std::memory_order_relaxed) >= m_limits.low_watermark
+			&& m_waiters.load() == 0) {
+			// yes -> shrink
+			m_size.fetch_sub(1, std::memory_order_relaxed);
+			Base::destroy(a_object);
+			return;
+		}
+
+		// counted before it can be taken, so that the count never drops below zero
+		m_idle.fetch_add(1, std::memory_order_relaxed);
+		Base::add(a_object);
+
+		// anyone waiting?
+		if (m_waiters.load() > 0) {
+			// yes -> wake up
+			std::lock_guard<std::mutex> lock(m_wait_lock);
+			m_wait_cond.notify_one();
+		}
+	}
+
+	PoolStats get_stats() const
+	{
+		PoolStats stats;
+		stats.size = m_size.load(std::memory_order_relaxed);
+		stats.peak_size = m_peak_size.load(std::memory_order_relaxed);
+		stats.waits = m_waits.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	const PoolLimits& get_limits() const { return m_limits; }
+
+private:
+	//! allocate a further object, unless at the ceiling
+	Recyclable* grow()
+	{
+		size_t size = m_size.load(std::memory_order_relaxed);
+		do {
+			if (size >= m_limits.high_watermark) {
+				return nullptr;
+			}
+		} while (!m_size.compare_exchange_weak(size, size + 1, std::memory_order_relaxed));
+
+		size_t peak = m_peak_size.load(std::memory_order_relaxed);
+		while (peak < size + 1 && !m_peak_size.compare_exchange_weak(peak, size + 1,
+			std::memory_order_relaxed)) {
+		}
+
+		Recyclable* object = create();
+		Base::adopt(object);
+		return object;
+	}
+
+	Recyclable* create()
+	{
+		return m_factory ? m_factory() : new Recyclable();
+	}
+
+private:
+	const PoolLimits m_limits;
+	const Factory m_factory;
+	std::atomic<size_t> m_size;
+	std::atomic<size_t> m_peak_size;
+	std::atomic<size_t> m_waits;
+	//! objects in the pool, possibly including some about to be taken
+	std::atomic<size_t> m_idle;
+	//! threads waiting for an object
+	std::atomic<size_t> m_waiters;
+	std::mutex m_wait_lock;
+	std::condition_variable m_wait_cond;
+};
+
+//------------------------------------------------------------------------------
+} // end namespace remo
+//------------------------------------------------------------------------------
@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+//
+// C++
+#include <atomic>
+#include <stddef.h> // size_t
+#include <utility> // move
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace utils {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// class declaration
+//------------------------------------------------------------------------------
+//
+/**
+ * lock-free queue with any number of producers and a single consumer.
+ *
+ * producers push onto a stack (Treiber stack), while the consumer takes all
+ * items at once and reverses them, so they come out in the order pushed by
+ * each thread. as items are never popped one by one, there is no ABA problem.
+ *
+ * push reports when the queue was empty, such that producers can wake up the
+ * consumer only once for all items it takes at a time.
+ */
+template<typename T>
+class MpscQueue
+{
+// ctor/dtor
+public:
+	MpscQueue():
+		m_top(nullptr)
+	{
+	}
+
+	~MpscQueue()
+	{
+		// items not taken are discarded
+		discard(m_top.load(std::memory_order_acquire));
+	}
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+// public member functions
+public:
+	//! add an item, may be called by any thread.
+	//! returns true if the queue was empty before
+	bool push(T a_item)
+	{
+		Node* node = new Node(std::move(a_item));
+		Node* top = m_top.load(std::memory_order_relaxed);
+		do {
+			node->next = top;
+		} while (!m_top.compare_exchange_weak(top, node,
+			std::memory_order_release, std::memory_order_relaxed));
+		return top == nullptr;
+	}
+
+	//! take all items and call the given function for each of them in turn.
+	//! may be called by the consumer only. returns the number of items taken.
+	//! if the function throws, the items after the one it threw for are dropped
+	template<typename Func>
+	size_t consume_all(Func&& a_func)
+	{
+		Node* node = m_top.exchange(nullptr, std::memory_order_acquire);
+		if (!node) {
+			return 0;
+		}
+
+		// last pushed first -> reverse
+		Node* first = nullptr;
+		while (node) {
+			Node* next = node->next;
+			node->next = first;
+			first = node;
+			node = next;
+		}
+
+		size_t count = 0;
+		while (first) {
+			Node* next = first->next;
+			try {
+				a_func(first->item);
+			} catch (...) {
+				// the items left are dropped, but not leaked
+				delete first;
+				discard(next);
+				throw;
+			}
+			delete first;
+			first = next;
+			++count;
+		}
+		return count;
+	}
+
+	//! true if there are no items. just a hint if producers are busy
+	bool empty() const
+	{
+		return m_top.load(std::memory_order_relaxed) == nullptr;
+	}
+
+// private types
+private:
+	struct Node {
+		Node(T&& a_item): item(std::move(a_item)), next(nullptr) {}
+		T item;
+		Node* next;
+	};
+
+// private member functions
+private:
+	static void discard(Node* a_node)
+	{
+		while (a_node) {
+			Node* next = a_node->next;
+			delete a_node;
+			a_node = next;
+		}
+	}
+
+// private members
+private:
+	//! item pushed last
+	std::atomic<Node*> m_top;
+};
+
+//------------------------------------------------------------------------------
+	} // end namespace utils
+} // end namespace remo
+//------------------------------------------------------------------------------
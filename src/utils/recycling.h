@@ -11,61 +11,182 @@
 
 #include "l0_system/error.h"
 
+#include <atomic>
 #include <mutex>
+#include <vector>
+#include <stdint.h>
 
 //------------------------------------------------------------------------------
 namespace remo {
 //------------------------------------------------------------------------------	
 
 
+/**
+ * Pool of recyclable objects
+ *
+ * The pool is a lock-free stack (Treiber stack), as objects are taken and 
+ * recycled by different threads for every message. To avoid the ABA problem,
+ * the top of the stack is a 64 bit word combining the object with a tag that
+ * changes on every update. Objects are referred to by the index of a slot
+ * instead of their address, such that both fit into a portable 64 bit 
+ * compare-and-swap. A slot is assigned when an object is first added, which
+ * is the only operation that takes a lock. Objects can therefore be added to
+ * one pool only.
+ *
+ * The stack is linked through the slots rather than the objects, so that 
+ * objects may be destroyed while other threads are about to take them.
+ * Slots are reused, but never freed while the pool exists.
+ */
 template<typename Recyclable>
 class RecyclingPool {
 public:
 	RecyclingPool():
-		m_first(nullptr),
+		m_top(0),
+		m_chunks(),
+		m_count(0),
+		m_free_slots(),
 		m_lock()
 	{
 	}
 
 	virtual ~RecyclingPool()
 	{
-		Recyclable* obj = m_first;
-		while (obj) {
-			Recyclable* tmp = obj;
-			obj = obj->get_next();
-			delete tmp;
+		// objects taken are owned by their users
+		uint32_t index = static_cast<uint32_t>(m_top.load(std::memory_order_acquire));
+		while (index) {
+			Slot& slot = get_slot(index);
+			index = slot.next.load(std::memory_order_relaxed);
+			delete slot.object.load(std::memory_order_relaxed);
+		}
+		for (Slot* chunk : m_chunks) {
+			delete[] chunk;
 		}
 	}
 
-	void add(Recyclable* a_object) 
+	virtual void add(Recyclable* a_object) 
 	{
-		std::lock_guard<std::mutex> lock(m_lock);
-
+		// new to the pool?
+		if (a_object->m_home != this) {
+			// yes -> assign slot
+			register_object(a_object);
+		}
 		a_object->set_pool(nullptr);
-		a_object->set_next(m_first);
-		m_first = a_object;
+
+		// push
+		const uint32_t index = a_object->m_index;
+		Slot& slot = get_slot(index);
+		uint64_t top = m_top.load(std::memory_order_relaxed);
+		do {
+			slot.next.store(static_cast<uint32_t>(top), std::memory_order_relaxed);
+		} while (!m_top.compare_exchange_weak(top, make_top(index, top), 
+			std::memory_order_release, std::memory_order_relaxed));
 	}
 
 	Recyclable* take() 
+	{
+		// pop
+		uint64_t top = m_top.load(std::memory_order_acquire);
+		for (;;) {
+			const uint32_t index = static_cast<uint32_t>(top);
+			if (!index) {
+				// out of objects
+				return nullptr;
+			}
+			// the successor may be outdated, in which case the tag has changed as well
+			Slot& slot = get_slot(index);
+			const uint32_t next = slot.next.load(std::memory_order_relaxed);
+			if (m_top.compare_exchange_weak(top, make_top(next, top), 
+				std::memory_order_acquire, std::memory_order_acquire)) {
+				// remember where you come from
+				Recyclable* object = slot.object.load(std::memory_order_relaxed);
+				object->set_pool(this);
+				return object;
+			}
+		}
+	}
+
+protected:
+	//! add a new object as if it was taken from the pool
+	void adopt(Recyclable* a_object)
+	{
+		register_object(a_object);
+		a_object->set_pool(this);
+	}
+
+	//! destroy an object instead of recycling it, and release its slot
+	void destroy(Recyclable* a_object)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_free_slots.push_back(a_object->m_index);
+		}
+		a_object->set_pool(nullptr);
+		delete a_object;
+	}
+
+private:
+	//! entry of the slot table
+	struct Slot {
+		std::atomic<Recyclable*> object;
+		//! index of the next slot in the stack
+		std::atomic<uint32_t> next;
+	};
+
+	//! number of slots per chunk of the slot table
+	static const uint32_t CHUNK_SIZE = 1024;
+	//! maximum number of chunks, limiting the number of objects
+	static const uint32_t MAX_CHUNKS = 1024;
+
+	//! combine slot index and an incremented tag into the top of the stack
+	static uint64_t make_top(uint32_t a_index, uint64_t a_prev_top)
+	{
+		return (((a_prev_top >> 32) + 1) << 32) | a_index;
+	}
+
+	//! slot with the given index, starting at 1
+	Slot& get_slot(uint32_t a_index) const
+	{
+		const uint32_t i = a_index - 1;
+		return m_chunks[i / CHUNK_SIZE][i % CHUNK_SIZE];
+	}
+
+	void register_object(Recyclable* a_object)
 	{
 		std::lock_guard<std::mutex> lock(m_lock);
 
-		if (m_first) {
-			// remove first object from our list
-			Recyclable* object = m_first;
-			m_first = m_first->get_next();
-			// remember where you come from
-			object->set_pool(this);
-			return object;
+		// belongs to another pool, or too many objects?
+		if (a_object->m_home || (m_free_slots.empty() && m_count == CHUNK_SIZE * MAX_CHUNKS)) {
+			// yes -> cannot add
+			REMO_THROW_NOLOG(ErrorCode::ERR_CANNOT_RECYCLE,
+				"cannot add object to pool");
+		}
+
+		// reuse a slot of a destroyed object, or append one
+		uint32_t index = 0;
+		if (!m_free_slots.empty()) {
+			index = m_free_slots.back();
+			m_free_slots.pop_back();
 		} else {
-			// out of objects
-			return nullptr;
+			// chunks are never moved, so that existing slots can be read without lock
+			if (m_count % CHUNK_SIZE == 0) {
+				m_chunks[m_count / CHUNK_SIZE] = new Slot[CHUNK_SIZE];
+			}
+			index = ++m_count;
 		}
+		get_slot(index).object.store(a_object, std::memory_order_relaxed);
+		a_object->m_home = this;
+		a_object->m_index = index;
 	}
 
 private:
-	Recyclable* m_first;
-	// TODO eliminate?
+	//! tag in the upper, index of the first slot in the lower 32 bits
+	std::atomic<uint64_t> m_top;
+	//! slot table, to get objects by their index
+	Slot* m_chunks[MAX_CHUNKS];
+	uint32_t m_count;
+	//! slots of destroyed objects
+	std::vector<uint32_t> m_free_slots;
+	//! taken when assigning slots only
 	std::mutex m_lock;
 };
 
@@ -74,7 +195,7 @@ private:
 template<typename SubClass>
 class Recyclable {
 public:
-	Recyclable(): m_pool(nullptr), m_next(nullptr)
+	Recyclable(): m_pool(nullptr), m_home(nullptr), m_index(0)
 	{
 	}
 
@@ -117,18 +238,11 @@ private:
 		m_pool = a_pool;
 	}
 
-	SubClass* get_next() {
-		return m_next;
-	}
-
-	void set_next(SubClass* a_object) {
-		m_next = a_object;
-	}
-
-
 private:
 	Pool* m_pool;
-	SubClass* m_next;
+	//! pool that the object has been added to, and its slot there
+	Pool* m_home;
+	uint32_t m_index;
 };
 
 //------------------------------------------------------------------------------	
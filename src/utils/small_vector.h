@@ -0,0 +1,220 @@
+//------------------------------------------------------------------------------
+/**
+ * @license
+ * Copyright (c) Daniel Pauli <dapaulid@gmail.com>
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+//------------------------------------------------------------------------------
+#pragma once
+
+//------------------------------------------------------------------------------
+// includes
+//------------------------------------------------------------------------------
+//
+// project
+//
+// C++
+#include <stddef.h> // size_t
+#include <new> // placement new
+#include <type_traits> // aligned_storage
+#include <utility> // move
+//
+//
+//------------------------------------------------------------------------------
+namespace remo {
+	namespace utils {
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// class declaration
+//------------------------------------------------------------------------------
+//
+/**
+ * vector-like container that stores up to N elements inline, i.e. without
+ * any heap allocation. only when more elements are added, they are moved
+ * to the heap, doubling the capacity each time.
+ *
+ * the capacity is retained by clear(), so a reused container does not
+ * allocate again.
+ */
+template<typename T, size_t N>
+class SmallVector
+{
+// types
+public:
+	typedef T value_type;
+	typedef T* iterator;
+	typedef const T* const_iterator;
+
+// ctor/dtor
+public:
+	SmallVector():
+		m_data(get_inline_data()),
+		m_size(0),
+		m_capacity(N)
+	{
+	}
+
+	SmallVector(const SmallVector& a_other):
+		SmallVector()
+	{
+		reserve(a_other.size());
+		for (const T& value : a_other) {
+			push_back(value);
+		}
+	}
+
+	SmallVector(SmallVector&& a_other):
+		SmallVector()
+	{
+		take(a_other);
+	}
+
+	~SmallVector()
+	{
+		clear();
+		release();
+	}
+
+// operators
+public:
+	SmallVector& operator=(const SmallVector& a_other)
+	{
+		if (this != &a_other) {
+			clear();
+			reserve(a_other.size());
+			for (const T& value : a_other) {
+				push_back(value);
+			}
+		}
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& a_other)
+	{
+		if (this != &a_other) {
+			clear();
+			release();
+			take(a_other);
+		}
+		return *this;
+	}
+
+	T& operator[](size_t a_index) { return m_data[a_index]; }
+	const T& operator[](size_t a_index) const { return m_data[a_index]; }
+
+// public member functions
+public:
+	void push_back(const T& a_value)
+	{
+		emplace_back(a_value);
+	}
+
+	template<typename... Args>
+	void emplace_back(Args&&... args)
+	{
+		if (m_size == m_capacity) {
+			reserve(m_capacity * 2);
+		}
+		new (m_data + m_size) T(std::forward<Args>(args)...);
+		++m_size;
+	}
+
+	void pop_back()
+	{
+		m_data[--m_size].~T();
+	}
+
+	void clear()
+	{
+		for (size_t i = 0; i < m_size; i++) {
+			m_data[i].~T();
+		}
+		m_size = 0;
+	}
+
+	void reserve(size_t a_capacity)
+	{
+		// large enough?
+		if (a_capacity <= m_capacity) {
+			// yes -> nothing to do
+			return;
+		}
+
+		// move elements to new storage
+		T* data = static_cast<T*>(::operator new(a_capacity * sizeof(T)));
+		for (size_t i = 0; i < m_size; i++) {
+			new (data + i) T(std::move(m_data[i]));
+			m_data[i].~T();
+		}
+		release();
+		m_data = data;
+		m_capacity = a_capacity;
+	}
+
+	size_t size() const { return m_size; }
+	size_t capacity() const { return m_capacity; }
+	bool empty() const { return m_size == 0; }
+
+	//! true if the elements are stored inline, i.e. not on the heap
+	bool is_inline() const { return m_data == get_inline_data(); }
+
+	T* data() { return m_data; }
+	const T* data() const { return m_data; }
+
+	iterator begin() { return m_data; }
+	iterator end() { return m_data + m_size; }
+	const_iterator begin() const { return m_data; }
+	const_iterator end() const { return m_data + m_size; }
+
+// private member functions
+private:
+	T* get_inline_data() { return reinterpret_cast<T*>(m_inline); }
+	const T* get_inline_data() const { return reinterpret_cast<const T*>(m_inline); }
+
+	//! free heap storage, if any. elements must have been destroyed
+	void release()
+	{
+		if (!is_inline()) {
+			::operator delete(m_data);
+			m_data = get_inline_data();
+			m_capacity = N;
+		}
+	}
+
+	//! take over elements of another vector, which must be empty and inline
+	void take(SmallVector& a_other)
+	{
+		if (a_other.is_inline()) {
+			// move elements one by one
+			for (T& value : a_other) {
+				push_back(std::move(value));
+			}
+			a_other.clear();
+		} else {
+			// steal heap storage
+			m_data = a_other.m_data;
+			m_size = a_other.m_size;
+			m_capacity = a_other.m_capacity;
+			a_other.m_data = a_other.get_inline_data();
+			a_other.m_size = 0;
+			a_other.m_capacity = N;
+		}
+	}
+
+// private members
+private:
+	//! inline storage for the first N elements
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type m_inline[N];
+	//! points to either inline or heap storage
+	T* m_data;
+	size_t m_size;
+	size_t m_capacity;
+};
+
+//------------------------------------------------------------------------------
+	} // end namespace utils
+} // end namespace remo
+//------------------------------------------------------------------------------
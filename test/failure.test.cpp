@@ -34,6 +34,81 @@ TEST(Failure, call_with_param_type)
     }
 }
 
+//------------------------------------------------------------------------------
+//
+TEST(Failure, call_unknown_function)
+{
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    try {
+        remote->call("testfunc");
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_RPC_NOT_FOUND);
+    }
+
+    // bound later
+    endpoint.bind("testfunc", [](){});
+    remote->call("testfunc");
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Failure, call_unknown_function_repeatedly)
+{
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // the name is queried once, then called right away
+    for (int i = 0; i < 3; i++) {
+        try {
+            remote->call("testfunc");
+            FAIL() << "must throw an exception";
+        } catch (const remo::error& e) {
+            EXPECT_EQ(e.code(), remo::ErrorCode::ERR_RPC_NOT_FOUND);
+        }
+    }
+    endpoint.bind("testfunc", []() { return (uint32_t)1; });
+    EXPECT_EQ(remote->call("testfunc").get<uint32_t>(), 1u);
+    EXPECT_EQ(remote->call("testfunc").get<uint32_t>(), 1u);
+}
+
+//------------------------------------------------------------------------------
+//
+//! endpoint whose functions can be bound anew
+class RebindingEndpoint: public remo::LocalEndpoint {
+public:
+    void unbind(const std::string& a_name) { delete find_item(a_name); }
+};
+
+//------------------------------------------------------------------------------
+//
+TEST(Failure, call_rebound_function)
+{
+    RebindingEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    endpoint.bind("testfunc", []() { return (uint32_t)1; });
+    EXPECT_EQ(remote->call("testfunc").get<uint32_t>(), 1u);
+
+    // the id known for it is stale now
+    endpoint.unbind("testfunc");
+    endpoint.bind("testfunc", []() { return (uint32_t)2; });
+    EXPECT_EQ(remote->call("testfunc").get<uint32_t>(), 2u);
+    EXPECT_EQ(remote->call("testfunc").get<uint32_t>(), 2u);
+
+    // gone for good
+    endpoint.unbind("testfunc");
+    try {
+        remote->call("testfunc");
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_RPC_NOT_FOUND);
+    }
+}
+
+
 
 //------------------------------------------------------------------------------
 // end of file
@@ -3,6 +3,7 @@
 #include "remo.h"
 
 #include <limits>
+#include <algorithm>
 
 static bool free_func_called = false;
 
@@ -13,6 +14,22 @@ static uint32_t simple_func(uint32_t a1)
     return 4321;
 }
 
+//! struct transmitted field by field
+struct Point {
+    int32_t x;
+    int32_t y;
+    double weight;
+    std::string label;
+};
+REMO_STRUCT(Point, &Point::x, &Point::y, &Point::weight, &Point::label);
+
+//! struct transmitted as a whole
+struct Sample {
+    uint64_t timestamp;
+    float values[4];
+};
+REMO_FIXED_STRUCT(Sample);
+
 //------------------------------------------------------------------------------
 //
 template<typename T>
@@ -85,6 +102,164 @@ TYPED_TEST(Integration, func_with_one_numeric_outparam)
     EXPECT_EQ(a1, std::numeric_limits<NumericType>::min());
 }
 
+//------------------------------------------------------------------------------
+//
+TYPED_TEST(Integration, func_with_array_inparam)
+{
+    using NumericType  = typename TestFixture::MyParamType;
+
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    bool func_called = false;
+
+    // register function
+    endpoint.bind("test_func", [&](remo::arraysize_t n, const NumericType* a1) {
+        func_called = true;
+        EXPECT_EQ(n.value, (size_t)10);
+        for (size_t i = 0; i < n.value; i++) {
+            EXPECT_EQ(a1[i], (NumericType)(i % 2 ? i : 0));
+        }
+        return (uint32_t)n.value;
+    });
+
+    // call function with arraysize_t and const pointer
+    NumericType a1[10];
+    for (size_t i = 0; i < 10; i++) {
+        a1[i] = (NumericType)(i % 2 ? i : 0);
+    }
+    const NumericType* p1 = a1;
+    remo::TypedValue result = remote->call("test_func", remo::arraysize_t(10), p1);
+    ASSERT_TRUE(func_called);
+    EXPECT_EQ(result.get<uint32_t>(), (uint32_t)10);
+
+    // call function with mutable array of known size. the function does not
+    // modify it, so the array must not change
+    func_called = false;
+    result = remote->call("test_func", a1);
+    ASSERT_TRUE(func_called);
+    EXPECT_EQ(result.get<uint32_t>(), (uint32_t)10);
+    for (size_t i = 0; i < 10; i++) {
+        EXPECT_EQ(a1[i], (NumericType)(i % 2 ? i : 0));
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TYPED_TEST(Integration, func_with_array_outparam)
+{
+    using NumericType  = typename TestFixture::MyParamType;
+
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // register function
+    endpoint.bind("test_func", [&](remo::arraysize_t n, NumericType* a1) {
+        // modify outparam
+        for (size_t i = 0; i < n.value; i++) {
+            a1[i] = std::numeric_limits<NumericType>::max();
+        }
+    });
+
+    // call function with arraysize_t and pointer
+    NumericType a1[5] = {};
+    remote->call("test_func", remo::arraysize_t(5), &a1[0]);
+    for (size_t i = 0; i < 5; i++) {
+        EXPECT_EQ(a1[i], std::numeric_limits<NumericType>::max());
+    }
+
+    // call function with array of known size
+    NumericType a2[7] = {};
+    remote->call("test_func", a2);
+    for (size_t i = 0; i < 7; i++) {
+        EXPECT_EQ(a2[i], std::numeric_limits<NumericType>::max());
+    }
+
+    // call function with empty array
+    remote->call("test_func", remo::arraysize_t(0), (NumericType*)nullptr);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Integration, func_with_vector_inparam)
+{
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // register function
+    endpoint.bind("test_func", [&](remo::arraysize_t n, const float* a1) {
+        float sum = 0;
+        for (size_t i = 0; i < n.value; i++) {
+            sum += a1[i];
+        }
+        return sum;
+    });
+
+    // call function
+    std::vector<float> a1 = { 1.5f, 2.5f, 3.0f };
+    remo::TypedValue result = remote->call("test_func", a1);
+    EXPECT_EQ(result.get<float>(), 7.0f);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Integration, func_with_timestamp_vector_inparam)
+{
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // slowly increasing, sent as differences
+    std::vector<int64_t> timestamps;
+    for (int64_t i = 0; i < 50; i++) {
+        timestamps.push_back(1700000000000 + i * 20);
+    }
+
+    // register function
+    endpoint.bind("test_func", [&](remo::arraysize_t n, const int64_t* a1) {
+        EXPECT_EQ(n.value, timestamps.size());
+        for (size_t i = 0; i < n.value; i++) {
+            EXPECT_EQ(a1[i], timestamps[i]);
+        }
+        return a1[n.value - 1] - a1[0];
+    });
+
+    // call function
+    remo::TypedValue result = remote->call("test_func", timestamps);
+    EXPECT_EQ(result.get<int64_t>(), (int64_t)(49 * 20));
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Integration, func_with_large_params_and_result)
+{
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // exceeds a single packet by far, so it continues in further segments
+    std::vector<uint32_t> items;
+    for (uint32_t i = 0; i < 50000; i++) {
+        items.push_back(i * 2654435761u);
+    }
+    const std::string text(100000, 'x');
+
+    // register function
+    endpoint.bind("test_func", [&](remo::arraysize_t n, const uint32_t* a1, std::string a2) {
+        EXPECT_EQ(n.value, items.size());
+        EXPECT_TRUE(std::equal(a1, a1 + n.value, items.begin()));
+        EXPECT_EQ(a2, text);
+        return a2 + "y";
+    });
+
+    // call function
+    remo::TypedValue result = remote->call("test_func", items, text);
+    EXPECT_EQ(result.get<std::string>(), text + "y");
+}
+
 //------------------------------------------------------------------------------
 //
 TEST(Integration, func_with_one_string_inparam)
@@ -107,6 +282,113 @@ TEST(Integration, func_with_one_string_inparam)
     ASSERT_TRUE(func_called);
 }
 
+//------------------------------------------------------------------------------
+//
+TEST(Integration, func_with_std_string_param_and_result)
+{
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // register function
+    endpoint.bind("test_func", [&](std::string a1, uint32_t a2) {
+        EXPECT_EQ(a1, std::string("config/key"));
+        return a1 + "/" + std::to_string(a2);
+    });
+
+    // call function
+    const std::string key = "config/key";
+    remo::TypedValue result = remote->call("test_func", key, (uint32_t)42);
+    EXPECT_EQ(result.get<std::string>(), std::string("config/key/42"));
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Integration, func_with_reply_in_call_packet)
+{
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // register function: the result is built from the arguments,
+    // and the outparam is copied into the reply as well
+    endpoint.bind("test_func", [&](const char* a1, remo::arraysize_t n, uint32_t* a2) {
+        for (size_t i = 0; i < n.value; i++) {
+            a2[i] = a2[i] * 2 + 1;
+        }
+        return std::string(a1) + "!";
+    });
+
+    // call function repeatedly so that packets are recycled in between
+    for (uint32_t k = 0; k < 8; k++) {
+        const std::string arg(k * 7, 'a' + k);
+        uint32_t a2[13];
+        for (uint32_t i = 0; i < 13; i++) {
+            a2[i] = i + k;
+        }
+        remo::TypedValue result = remote->call("test_func", arg.c_str(), remo::arraysize_t(13), &a2[0]);
+        EXPECT_EQ(result.get<std::string>(), arg + "!");
+        for (uint32_t i = 0; i < 13; i++) {
+            EXPECT_EQ(a2[i], (i + k) * 2 + 1);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Integration, func_with_struct_params_and_result)
+{
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // register function
+    endpoint.bind("test_func", [&](Point a1, Sample a2) {
+        EXPECT_EQ(a1.x, -3);
+        EXPECT_EQ(a1.label, std::string("origin"));
+        EXPECT_EQ(a2.timestamp, (uint64_t)1234567890123);
+        EXPECT_EQ(a2.values[3], 4.5f);
+        a1.x += 10;
+        a1.weight *= 2;
+        return a1;
+    });
+
+    // call function
+    Point point = { -3, 7, 0.25, "origin" };
+    Sample sample = { 1234567890123, { 1.0f, 2.0f, 3.0f, 4.5f } };
+    remo::TypedValue result = remote->call("test_func", point, sample);
+    Point returned = result.get<Point>();
+    EXPECT_EQ(returned.x, 7);
+    EXPECT_EQ(returned.y, 7);
+    EXPECT_EQ(returned.weight, 0.5);
+    EXPECT_EQ(returned.label, std::string("origin"));
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Integration, func_with_struct_outparam)
+{
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // register function
+    endpoint.bind("test_func", [&](const Point* a1, Point* a2) {
+        a2->x = a1->x * 2;
+        a2->y = a1->y * 2;
+        a2->label = a1->label + "*2";
+    });
+
+    // call function
+    Point in = { 1, 2, 0.0, "in" };
+    Point out = { 0, 0, 0.0, "" };
+    remote->call("test_func", (const Point*)&in, &out);
+    EXPECT_EQ(out.x, 2);
+    EXPECT_EQ(out.y, 4);
+    EXPECT_EQ(out.label, std::string("in*2"));
+    EXPECT_EQ(in.x, 1);
+}
+
 //------------------------------------------------------------------------------
 //
 TYPED_TEST(Integration, func_with_two_numeric_inparams)
@@ -154,6 +436,25 @@ TEST(Integration, func_with_no_params_and_no_result)
     ASSERT_TRUE(func_called);
 }
 
+//------------------------------------------------------------------------------
+//
+TEST(Integration, funcs_called_by_id)
+{
+    // create endpoint
+    remo::LocalEndpoint endpoint;
+    remo::RemoteEndpoint* remote = endpoint.connect(".");
+
+    // register functions
+    endpoint.bind("func_a", [&]() { return (uint32_t)1; });
+    endpoint.bind("func_b", [&]() { return (uint32_t)2; });
+
+    // call functions repeatedly, the name is only transmitted once
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(remote->call("func_b").get<uint32_t>(), (uint32_t)2);
+        EXPECT_EQ(remote->call("func_a").get<uint32_t>(), (uint32_t)1);
+    }
+}
+
 //------------------------------------------------------------------------------
 //
 TEST(integration, simple)
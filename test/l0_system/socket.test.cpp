@@ -6,6 +6,10 @@
 #include <future>
 #include <string.h>
 #include <chrono>
+#include <thread>
+
+#include <stdio.h> // fopen
+#include <unistd.h> // access
 
 //------------------------------------------------------------------------------
 // helpers
@@ -103,6 +107,45 @@ TEST(SockAddr, Invalid)
     }
 }
 
+//------------------------------------------------------------------------------
+//
+TEST(SockAddr, UnixPath)
+{
+	SockAddr addr("unix:///run/svc.sock");
+
+	EXPECT_EQ(addr.get_family(), AddrFamily::Unix);
+	EXPECT_EQ(addr.get_port(), 0);
+	EXPECT_EQ(addr.get_path(), "/run/svc.sock");
+	EXPECT_STREQ(addr.to_string().c_str(), "unix:///run/svc.sock");
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SockAddr, UnixAbstract)
+{
+	SockAddr addr("unix://@svc");
+
+	EXPECT_EQ(addr.get_family(), AddrFamily::Unix);
+	// no file
+	EXPECT_EQ(addr.get_path(), "");
+	EXPECT_STREQ(addr.to_string().c_str(), "unix://@svc");
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SockAddr, UnixInvalid)
+{
+	for (const std::string& str : { 
+		std::string("unix://"), std::string("unix://@"), "unix:///" + std::string(200, 'x') }) {
+		try {
+			SockAddr addr(str);
+			FAIL() << "must not be reached";
+		} catch (const remo::error& e) {
+			EXPECT_EQ(e.code(), remo::ErrorCode::ERR_SOCKET_INVALID_ADDRESS);
+		}
+	}
+}
+
 //------------------------------------------------------------------------------
 //
 TEST(Socket, NonBlockingReceive)
@@ -166,12 +209,91 @@ TEST(Socket, SendReceive_TCP)
 
 //------------------------------------------------------------------------------
 //
-TEST(SocketSet, Poll)
+TEST(Socket, SendReceive_Unix)
+{
+	const char sendbuf [] = "Hello World!";
+	char recvbuf [sizeof(sendbuf)];
+
+	for (const char* str : { "unix:///tmp/remo-socket-test.sock", "unix://@remo-socket-test" }) {
+		const SockAddr addr(str);
+		Socket s1(SockProto::TCP, AddrFamily::Unix);
+		Socket s2(SockProto::TCP, AddrFamily::Unix);
+
+		Socket::remove_file(addr);
+		s2.bind(addr);
+		s2.listen();
+		EXPECT_EQ(s2.get_socket_addr().to_string(), str);
+
+		s1.connect(addr);
+		Socket s3 = s2.accept();
+		// the connecting end has no name
+		EXPECT_EQ(s3.get_remote_addr().to_string(), "unix://");
+
+		Socket::IOResult send_result = s1.send(sendbuf, sizeof(sendbuf));
+		EXPECT_EQ(send_result, Socket::IOResult::Success);
+
+		Socket::IOResult recv_result = s3.recv(recvbuf, sizeof(recvbuf));
+		EXPECT_EQ(recv_result, Socket::IOResult::Success);
+		EXPECT_TRUE(memcmp(recvbuf, sendbuf, sizeof(sendbuf)) == 0);
+		Socket::remove_file(addr);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+static void ExpectAddressInUse(const SockAddr& a_addr)
+{
+	try {
+		Socket::remove_stale_file(a_addr);
+		FAIL() << "must throw an exception";
+	} catch (const remo::error& e) {
+		EXPECT_EQ(e.code(), remo::ErrorCode::ERR_SOCKET_BIND_FAILED);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Socket, RemoveStaleFile)
+{
+	const char* path = "/tmp/remo-socket-test.sock";
+	const SockAddr addr(std::string("unix://") + path);
+	Socket::remove_file(addr);
+
+	// nothing to remove
+	Socket::remove_stale_file(addr);
+
+	// a socket listening there is left alone
+	{
+		Socket s(SockProto::TCP, AddrFamily::Unix);
+		s.bind(addr);
+		s.listen();
+		ExpectAddressInUse(addr);
+		EXPECT_EQ(access(path, F_OK), 0);
+	}
+
+	// but its file is removed once it is closed
+	EXPECT_EQ(access(path, F_OK), 0);
+	Socket::remove_stale_file(addr);
+	EXPECT_NE(access(path, F_OK), 0);
+
+	// so are files other than sockets
+	FILE* file = fopen(path, "w");
+	ASSERT_NE(file, nullptr);
+	fclose(file);
+	ExpectAddressInUse(addr);
+	EXPECT_EQ(access(path, F_OK), 0);
+	remove(path);
+}
+
+
+//------------------------------------------------------------------------------
+//
+static void TestPoll(SocketSet::Backend a_backend)
 {
     Socket s1(SockProto::UDP);
 	Socket s2(SockProto::UDP);
 
-	SocketSet ss;
+	SocketSet ss(a_backend);
 	ss.add(&s1);
 	ss.add(&s2);
 
@@ -216,6 +338,158 @@ TEST(SocketSet, Poll)
 	EXPECT_EQ(num_ready, (size_t)1);
 	EXPECT_FALSE(s1_ready);
 	EXPECT_TRUE(s2_ready);
+
+	// ready to send is reported only while requested
+	bool s1_send_ready = false;
+	s1.on_send_ready([&](){
+		s1_send_ready = true;
+	});
+	ss.notify_send_ready(&s1, true);
+	ss.poll(NO_WAIT);
+	EXPECT_TRUE(s1_send_ready);
+	EXPECT_FALSE(s1_ready);
+	ss.notify_send_ready(&s1, false);
+	s1_send_ready = false;
+	ss.poll(NO_WAIT);
+	EXPECT_FALSE(s1_send_ready);
+
+	// removed socket must not be reported anymore
+	ss.remove(&s2);
+	s1_ready = s2_ready = false;
+	num_ready = ss.poll(NO_WAIT);
+	EXPECT_EQ(num_ready, (size_t)0);
+	EXPECT_FALSE(s2_ready);
+	EXPECT_EQ(ss.count(), (size_t)1);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SocketSet, Poll)
+{
+	TestPoll(SocketSet::Backend::Poll);
+	TestPoll(SocketSet::Backend::Epoll);
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestPollTimeout(SocketSet::Backend a_backend)
+{
+    Socket s1(SockProto::UDP);
+	s1.bind(SockAddr::localhost);
+	SocketSet ss(a_backend);
+	ss.add(&s1);
+
+	// waits at least as long as requested, also below a millisecond
+	for (int64_t timeout_us : { 300, 1500 }) {
+		auto start = std::chrono::steady_clock::now();
+		EXPECT_EQ(ss.poll_us(timeout_us), (size_t)0);
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		EXPECT_GE(elapsed, std::chrono::microseconds(timeout_us));
+		EXPECT_LT(elapsed, std::chrono::seconds(1));
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SocketSet, PollTimeout)
+{
+	TestPollTimeout(SocketSet::Backend::Poll);
+	TestPollTimeout(SocketSet::Backend::Epoll);
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestEventSocket(SocketSet::Backend a_backend)
+{
+	EventSocket event;
+	int ready = 0;
+	event.on_receive_ready([&ready]() { ready++; });
+	SocketSet ss(a_backend);
+	ss.add(&event);
+
+	// not ready until signalled
+	EXPECT_EQ(ss.poll(NO_WAIT), (size_t)0);
+
+	// signals are merged, and can come from any thread
+	event.signal();
+	std::thread([&event]() { event.signal(); }).join();
+	EXPECT_EQ(ss.poll(POLL_TIMEOUT), (size_t)1);
+	EXPECT_EQ(ready, 1);
+
+	// stays ready until reset
+	EXPECT_EQ(ss.poll(NO_WAIT), (size_t)1);
+	event.reset();
+	EXPECT_EQ(ss.poll(NO_WAIT), (size_t)0);
+	// resetting again does no harm
+	event.reset();
+	EXPECT_EQ(ss.poll(NO_WAIT), (size_t)0);
+
+	event.signal();
+	EXPECT_EQ(ss.poll(POLL_TIMEOUT), (size_t)1);
+	ss.remove(&event);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SocketSet, EventSocket)
+{
+	TestEventSocket(SocketSet::Backend::Poll);
+	TestEventSocket(SocketSet::Backend::Epoll);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SocketSet, Backend)
+{
+	SocketSet ss;
+#ifdef __linux__
+	EXPECT_EQ(ss.get_backend(), SocketSet::Backend::Epoll);
+#else
+	EXPECT_EQ(ss.get_backend(), SocketSet::Backend::Poll);
+#endif
+	// portable fallback is always available
+	SocketSet ss_poll(SocketSet::Backend::Poll);
+	EXPECT_EQ(ss_poll.get_backend(), SocketSet::Backend::Poll);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SocketSet, RemoveInCallback)
+{
+	SocketSet ss(SocketSet::Backend::Epoll);
+	if (ss.get_backend() != SocketSet::Backend::Epoll) {
+		return;
+	}
+
+	// two sockets ready at once, the first one handled removes the other
+    Socket s1(SockProto::UDP);
+	Socket s2(SockProto::UDP);
+	s1.bind(SockAddr::localhost);
+	s2.bind(SockAddr::localhost);
+	s1.connect(s2.get_socket_addr());
+	s2.connect(s1.get_socket_addr());
+	ss.add(&s1);
+	ss.add(&s2);
+
+	int num_handled = 0;
+	s1.on_receive_ready([&](){
+		++num_handled;
+		ss.remove(&s2);
+	});
+	s2.on_receive_ready([&](){
+		++num_handled;
+		ss.remove(&s1);
+	});
+
+	const char data [] = "Hello";
+	EXPECT_EQ(s1.send(data, sizeof(data)), Socket::IOResult::Success);
+	EXPECT_EQ(s2.send(data, sizeof(data)), Socket::IOResult::Success);
+	sleep(10);
+
+	size_t num_ready = ss.poll(NO_WAIT);
+	EXPECT_EQ(num_ready, (size_t)1);
+	EXPECT_EQ(num_handled, 1);
+	EXPECT_EQ(ss.count(), (size_t)1);
 }
 
 //------------------------------------------------------------------------------
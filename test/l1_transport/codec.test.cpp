@@ -0,0 +1,553 @@
+#include "../test.h"
+
+#include "l1_transport/packet.h"
+#include "l1_transport/reader.h"
+#include "l1_transport/writer.h"
+#include "l1_transport/struct.h"
+
+#include <limits>
+#include <cstring> // memcmp
+#include <memory>
+#include <vector>
+
+//! struct transmitted field by field
+struct CodecFields {
+    uint8_t a;
+    double b;
+};
+REMO_STRUCT(CodecFields, &CodecFields::a, &CodecFields::b);
+
+//! struct transmitted as a whole
+struct CodecFixed {
+    uint32_t a;
+    uint16_t b;
+};
+REMO_FIXED_STRUCT(CodecFixed);
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------
+//
+using namespace remo::trans;
+using namespace remo;
+
+//! reference implementation of the original byte-wise encoder
+template<typename T>
+static void legacy_write_value(Writer& a_writer, const T& a_value)
+{
+	T value = a_value;
+	unsigned char* p = reinterpret_cast<unsigned char*>(&value);
+	uint8_t wire_size = 0;
+	LITTLE_ENDIAN_FOR(i, sizeof(value)) {
+		if (!value) {
+			break;
+		}
+		++wire_size;
+		p[i] = 0;
+	}
+	value = a_value;
+	a_writer.write<uint8_t>((wire_size << 4) | TypeInfo<T>::id());
+	LITTLE_ENDIAN_FOR(i, wire_size) {
+		a_writer.write<uint8_t>(p[i]);
+	}
+}
+
+//! some values of different magnitudes
+template<typename T>
+static std::vector<T> sample_values()
+{
+	std::vector<T> values = {
+		T(0), T(1), T(2), T(100),
+		std::numeric_limits<T>::min(),
+		std::numeric_limits<T>::max(),
+		std::numeric_limits<T>::lowest(),
+	};
+	if (std::numeric_limits<T>::is_signed) {
+		values.push_back(T(-1));
+		values.push_back(T(-100));
+	}
+	return values;
+}
+
+//------------------------------------------------------------------------------
+// tests
+//------------------------------------------------------------------------------
+//
+template<typename T>
+struct Codec : public testing::Test
+{
+    using MyParamType = T;
+};
+
+//------------------------------------------------------------------------------
+//
+using NumericTypes = testing::Types<
+    uint8_t, uint16_t, uint32_t, uint64_t,
+    int8_t, int16_t, int32_t, int64_t,
+    float, double, bool
+>;
+TYPED_TEST_SUITE(Codec, NumericTypes);
+
+//------------------------------------------------------------------------------
+//
+TYPED_TEST(Codec, roundtrip)
+{
+    using NumericType  = typename TestFixture::MyParamType;
+
+    for (NumericType value : sample_values<NumericType>()) {
+        Packet packet;
+        BinaryWriter writer(packet.get_payload());
+        writer.write_value(value);
+
+        BinaryReader reader(packet.get_payload());
+        TypedValue result = reader.read_typed_value();
+        EXPECT_EQ(result.get<NumericType>(), value);
+        EXPECT_FALSE(reader.has_more());
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TYPED_TEST(Codec, wire_compatible)
+{
+    using NumericType  = typename TestFixture::MyParamType;
+
+    // booleans have their own encoding
+    if (std::is_same<NumericType, bool>::value) {
+        return;
+    }
+
+    for (NumericType value : sample_values<NumericType>()) {
+        Packet expected;
+        Writer legacy_writer(expected.get_payload());
+        legacy_write_value(legacy_writer, value);
+
+        // floating point values have a more compact encoding,
+        // but the plain one must still be understood
+        if (std::is_floating_point<NumericType>::value) {
+            BinaryReader reader(expected.get_payload());
+            EXPECT_EQ(reader.read_typed_value().get<NumericType>(), value);
+            continue;
+        }
+
+        Packet actual;
+        BinaryWriter writer(actual.get_payload());
+        writer.write_value(value);
+
+        EXPECT_EQ(actual.get_payload().to_hex(), expected.get_payload().to_hex());
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, sign_bit_preserved)
+{
+    // only the sign bit and the lowest mantissa bit set.
+    // the original encoder stopped at -0.0 and lost the sign
+    const double value = -std::numeric_limits<double>::denorm_min();
+
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_value(value);
+
+    BinaryReader reader(packet.get_payload());
+    EXPECT_EQ(reader.read_typed_value().get<double>(), value);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, bad_wire_size)
+{
+    // uint16_t announcing 3 bytes
+    Packet packet;
+    Writer writer(packet.get_payload());
+    writer.write<uint8_t>((3 << 4) | type_uint16);
+    writer.write<uint8_t>(0x12);
+    writer.write<uint8_t>(0x34);
+    writer.write<uint8_t>(0x56);
+
+    BinaryReader reader(packet.get_payload());
+    try {
+        reader.read_typed_value();
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_BAD_PACKET);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, float_compact)
+{
+    // value, expected size including the type info byte
+    const std::vector<std::pair<double, size_t>> samples = {
+        { 0.0, 1 },           // plain, no bytes
+        { 1.0, 3 },           // reversed, 3F F0
+        { -1234.5, 4 },       // reversed, C0 93 4A
+        { 3.1415927410125732, 5 }, // exactly representable as float
+        { 0.1, 9 },           // full mantissa
+    };
+
+    for (const auto& sample : samples) {
+        Packet packet;
+        BinaryWriter writer(packet.get_payload());
+        writer.write_value(sample.first);
+        EXPECT_EQ(packet.get_payload().get_size(), sample.second) << sample.first;
+
+        BinaryReader reader(packet.get_payload());
+        EXPECT_EQ(reader.read_typed_value().get<double>(), sample.first);
+    }
+
+    // float
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_value(0.5f);
+    EXPECT_EQ(packet.get_payload().get_size(), (size_t)2); // reversed, 3F
+    BinaryReader reader(packet.get_payload());
+    EXPECT_EQ(reader.read_typed_value().get<float>(), 0.5f);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, float_special_values)
+{
+    const double values[] = {
+        -0.0,
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN(),
+        std::numeric_limits<float>::denorm_min(),
+        std::numeric_limits<float>::max(),
+        std::numeric_limits<double>::max(),
+    };
+
+    for (double value : values) {
+        Packet packet;
+        BinaryWriter writer(packet.get_payload());
+        writer.write_value(value);
+
+        // compare bit patterns, as NaN is not equal to itself
+        BinaryReader reader(packet.get_payload());
+        const double result = reader.read_typed_value().get<double>();
+        EXPECT_EQ(std::memcmp(&result, &value, sizeof(value)), 0) << value;
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, array_aligned)
+{
+    const double values[3] = { 1.0, -2.0, 3.5 };
+
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_value((uint8_t)1);
+    writer.write_value(values);
+
+    // uint8_t value, array size, pointer type, then items aligned to 8 bytes
+    EXPECT_EQ(packet.get_payload().get_size(), (size_t)(8 + 3 * sizeof(double)));
+
+    BinaryReader reader(packet.get_payload());
+    EXPECT_EQ(reader.read_typed_value().get<uint8_t>(), (uint8_t)1);
+    EXPECT_EQ(reader.read_typed_value().get<remo::arraysize_t>().value, (size_t)3);
+    const double* result = reader.read_typed_value().get<const double*>();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(result) % sizeof(double), (uintptr_t)0);
+    EXPECT_EQ(result, reinterpret_cast<const double*>(packet.get_payload().get_data() + 8));
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_EQ(result[i], values[i]);
+    }
+    EXPECT_FALSE(reader.has_more());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, bad_array_length)
+{
+    // array size exceeding the packet
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_value(arraysize_t(1000000));
+    writer.write<uint8_t>(type_uint32_ptr);
+    writer.write<uint32_t>(0);
+
+    BinaryReader reader(packet.get_payload());
+    reader.read_typed_value();
+    try {
+        reader.read_typed_value();
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_INVALID_ARRAY_LENGTH);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, string_roundtrip)
+{
+    const std::string long_string(300, 'x');
+
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_value("");
+    writer.write_value("hello");
+    writer.write_value(long_string);
+
+    BinaryReader reader(packet.get_payload());
+    EXPECT_STREQ(reader.read_typed_value().get<const char*>(), "");
+    EXPECT_STREQ(reader.read_typed_value().get<const char*>(), "hello");
+    EXPECT_EQ(reader.read_typed_value().get<std::string>(), long_string);
+    EXPECT_FALSE(reader.has_more());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, string_nul_terminated)
+{
+    // strings without length, as written by older peers
+    Packet packet;
+    Writer writer(packet.get_payload());
+    writer.write<uint8_t>(type_cstr);
+    for (char c : std::string("abc")) {
+        writer.write<uint8_t>(c);
+    }
+    writer.write<uint8_t>(0);
+
+    BinaryReader reader(packet.get_payload());
+    EXPECT_STREQ(reader.read_typed_value().get<const char*>(), "abc");
+    EXPECT_FALSE(reader.has_more());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, string_not_terminated)
+{
+    // length-prefixed string whose terminator is missing
+    Packet packet;
+    Writer writer(packet.get_payload());
+    writer.write<uint8_t>((1 << 4) | type_cstr);
+    writer.write<uint8_t>(2);
+    writer.write<uint8_t>('a');
+    writer.write<uint8_t>('b');
+    writer.write<uint8_t>('c');
+
+    BinaryReader reader(packet.get_payload());
+    try {
+        reader.read_typed_value();
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_BAD_PACKET);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, delta_array)
+{
+    // monotonic timestamps in microseconds
+    std::vector<uint64_t> timestamps;
+    for (uint64_t i = 0; i < 32; i++) {
+        timestamps.push_back(1700000000000000ULL + i * 1000 + (i % 3));
+    }
+    // small changes in both directions, wrapping around
+    const std::vector<int16_t> readings = { 0, -1, 1, 32767, -32768, 100, 99, 98 };
+
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_value(timestamps);
+    const size_t timestamps_size = packet.get_payload().get_size();
+    writer.write_value(readings);
+
+    // first delta takes 7 bytes, the others 2
+    EXPECT_EQ(timestamps_size, (size_t)(2 + 1 + 16 + 7 + 31 * 2));
+
+    BinaryReader reader(packet.get_payload());
+    EXPECT_EQ(reader.read_typed_value().get<remo::arraysize_t>().value, timestamps.size());
+    const uint64_t* timestamps_result = reader.read_typed_value().get<const uint64_t*>();
+    for (size_t i = 0; i < timestamps.size(); i++) {
+        EXPECT_EQ(timestamps_result[i], timestamps[i]);
+    }
+    EXPECT_EQ(reader.read_typed_value().get<remo::arraysize_t>().value, readings.size());
+    const int16_t* readings_result = reader.read_typed_value().get<const int16_t*>();
+    for (size_t i = 0; i < readings.size(); i++) {
+        EXPECT_EQ(readings_result[i], readings[i]);
+    }
+    EXPECT_FALSE(reader.has_more());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, delta_array_bad_size)
+{
+    // 4 items of 16 bits, one announcing 9 bytes
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_value(arraysize_t(4));
+    writer.write<uint8_t>(modifier_delta | type_uint16);
+    writer.write<uint8_t>(0x11);
+    writer.write<uint8_t>(0x91);
+    for (int i = 0; i < 12; i++) {
+        writer.write<uint8_t>(0);
+    }
+
+    BinaryReader reader(packet.get_payload());
+    reader.read_typed_value();
+    try {
+        reader.read_typed_value();
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_BAD_PACKET);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, struct_roundtrip)
+{
+    const CodecFields fields = { 200, 1.5 };
+    const CodecFixed fixed = { 0xDEADBEEF, 0x1234 };
+
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_value(fields);
+    writer.write_value(fixed);
+
+    // fields: type info byte, length, then uint8_t and reversed double
+    EXPECT_EQ(packet.get_payload().get_size(), 2 + 2 + 3 + 2 + sizeof(CodecFixed));
+
+    BinaryReader reader(packet.get_payload());
+    const CodecFields fields_result = reader.read_typed_value().get<CodecFields>();
+    EXPECT_EQ(fields_result.a, fields.a);
+    EXPECT_EQ(fields_result.b, fields.b);
+    const CodecFixed fixed_result = reader.read_typed_value().get<CodecFixed>();
+    EXPECT_EQ(fixed_result.a, fixed.a);
+    EXPECT_EQ(fixed_result.b, fixed.b);
+    EXPECT_FALSE(reader.has_more());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, struct_size_mismatch)
+{
+    // fixed struct received with a different size
+    Packet packet;
+    Writer writer(packet.get_payload());
+    writer.write<uint8_t>((1 << 4) | type_any);
+    writer.write<uint8_t>(4);
+    writer.write<uint32_t>(0);
+
+    BinaryReader reader(packet.get_payload());
+    try {
+        reader.read_typed_value().get<CodecFixed>();
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_BAD_PACKET);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+//! buffer continuing in segments of the given size, such that values span several ones
+class SegmentedBuffer: public RBuffer
+{
+public:
+    explicit SegmentedBuffer(size_t a_segment_size):
+        m_segment_size(a_segment_size)
+    {
+        m_storage.emplace_back(a_segment_size);
+        init(m_storage.back().data(), a_segment_size);
+    }
+
+protected:
+    RBuffer* new_segment() override
+    {
+        m_storage.emplace_back(m_segment_size);
+        m_segments.emplace_back(new RBuffer());
+        m_segments.back()->init(m_storage.back().data(), m_segment_size);
+        return m_segments.back().get();
+    }
+
+private:
+    size_t m_segment_size;
+    std::vector<std::vector<uint8_t>> m_storage;
+    std::vector<std::unique_ptr<RBuffer>> m_segments;
+};
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, segmented_read)
+{
+    const CodecFields fields = { 7, -2.5 };
+    const uint32_t array[] = { 1, 2, 3, 4, 5 };
+    const int64_t timestamps[] = { 1000, 1010, 1020, 1030, 1040, 1050 };
+    std::string name(100, 'n');
+    uint16_t value = 1234;
+    arraysize_t size(5);
+    const uint32_t* items = array;
+    arraysize_t delta_size(6);
+    const int64_t* delta_items = timestamps;
+
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_call(42, name, value, size, items, fields, delta_size, delta_items);
+
+    // values spanning segments are read like contiguous ones
+    for (size_t segment_size = 1; segment_size <= 16; segment_size++) {
+        SegmentedBuffer buffer(segment_size);
+        buffer.append(packet.get_payload().get_data(), packet.get_payload().get_size());
+        ASSERT_EQ(buffer.get_total_size(), packet.get_payload().get_size());
+
+        BinaryReader reader(buffer);
+        reader.read_call();
+        EXPECT_EQ(reader.get_function_id(), 42u);
+        const ArgList& args = reader.get_args();
+        ASSERT_EQ(args.size(), 7u) << "segment size " << segment_size;
+        EXPECT_EQ(args[0].get<std::string>(), name);
+        EXPECT_EQ(args[1].get<uint16_t>(), value);
+        EXPECT_EQ(args[3].get<const uint32_t*>()[4], 5u);
+        EXPECT_EQ(args[4].get<CodecFields>().b, fields.b);
+        EXPECT_EQ(args[6].get<const int64_t*>()[5], 1050);
+    }
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Codec, scalar_call_reserved)
+{
+    uint8_t u8 = 0xAB;
+    int32_t i32 = -70000;
+    uint64_t u64 = 0x0102030405060708ull;
+    bool flag = true;
+    double d = 0.5;
+    float f = -1.25f;
+
+    // written through a cursor into a reservation of the upper bound
+    Packet packet;
+    BinaryWriter writer(packet.get_payload());
+    writer.write_call(42, u8, i32, u64, flag, d, f);
+
+    // written value by value, as the reservation does not fit into a segment
+    SegmentedBuffer buffer(16);
+    BinaryWriter segmented_writer(buffer);
+    segmented_writer.write_call(42, u8, i32, u64, flag, d, f);
+
+    // only the bytes written are kept, the same in both cases
+    std::vector<uint8_t> expected(buffer.get_total_size());
+    buffer.copy_out(0, expected.data(), expected.size());
+    ASSERT_EQ(packet.get_payload().get_size(), expected.size());
+    EXPECT_EQ(std::memcmp(packet.get_payload().get_data(), expected.data(), expected.size()), 0);
+
+    BinaryReader reader(packet.get_payload());
+    reader.read_call();
+    const ArgList& args = reader.get_args();
+    ASSERT_EQ(args.size(), 6u);
+    EXPECT_EQ(args[0].get<uint8_t>(), u8);
+    EXPECT_EQ(args[1].get<int32_t>(), i32);
+    EXPECT_EQ(args[2].get<uint64_t>(), u64);
+    EXPECT_EQ(args[3].get<bool>(), flag);
+    EXPECT_EQ(args[4].get<double>(), d);
+    EXPECT_EQ(args[5].get<float>(), f);
+}
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------
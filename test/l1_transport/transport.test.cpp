@@ -4,10 +4,18 @@
 #include "l1_transport/reader.h"
 #include "l1_transport/writer.h"
 #include "l1_transport/tcp/tcp-transport.h"
+#include "l1_transport/uds/uds-transport.h"
 
 #include "utils/recycling.h"
 
 #include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <unistd.h> // access
 
 //------------------------------------------------------------------------------
 // tests
@@ -18,24 +26,37 @@ using namespace remo;
 
 //------------------------------------------------------------------------------
 //
-static void TestSendReceive(size_t a_payload_size)
+static TcpTransport::Settings TestSettings()
 {
 	TcpTransport::Settings settings;
 	settings.listen_addr = SockAddr("localhost:1986");
-	TcpTransport transport(settings);
+	return settings;
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestSendReceive(size_t a_payload_size, size_t a_rx_buffer_size = 0,
+	const TcpTransport::Settings& a_settings = TestSettings())
+{
+	TcpTransport transport(a_settings);
 
 	std::promise<void> p;
 	auto f = p.get_future();
-	transport.on_accept([&p, a_payload_size](Channel* a_channel) {
-		a_channel->on_receive([&p, a_payload_size](Channel*, packet_ptr& a_packet) {
-			p.set_value();
+	transport.on_accept([&p, a_payload_size, a_rx_buffer_size](Channel* a_channel) {
+		a_channel->on_receive([&p, a_payload_size, a_rx_buffer_size](Channel*, packet_ptr& a_packet) {
 			// check packet size
 			EXPECT_EQ(a_packet->get_size(), a_payload_size);
+			// check size class, if given
+			if (a_rx_buffer_size > 0) {
+				EXPECT_EQ(a_packet->get_buffer_size(), a_rx_buffer_size);
+				EXPECT_EQ(a_packet->get_payload().get_next(), nullptr);
+			}
 			// check packet contents
 			Reader reader(a_packet->get_payload());
 			for (size_t i = 0; i < a_payload_size; i++)	{
 				EXPECT_EQ(reader.read<uint8_t>(), (uint8_t)(i & 0xff));
 			}
+			p.set_value();
 		});
 	});
 
@@ -76,12 +97,683 @@ TEST(Transport, SendReceive_MaxPayload)
 	TestSendReceive(REMO_MAX_PACKET_PAYLOAD_SIZE);
 }
 
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_SizeClasses)
+{
+	// received into a packet of the smallest class that holds it
+	TestSendReceive(32, REMO_PACKET_SIZE_SMALL);
+	TestSendReceive(2000, REMO_PACKET_SIZE_MEDIUM);
+	TestSendReceive(20000, REMO_PACKET_SIZE_LARGE);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_SocketBackends)
+{
+	// portable fallback, and epoll where available
+	TcpTransport::Settings settings = TestSettings();
+	settings.socket_backend = SocketSet::Backend::Poll;
+	TestSendReceive(32, 0, settings);
+	TestSendReceive(300 * 1000, 0, settings);
+	settings.socket_backend = SocketSet::Backend::Epoll;
+	TestSendReceive(32, 0, settings);
+	TestSendReceive(300 * 1000, 0, settings);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_IoUring)
+{
+	// falls back to the socket set where not supported
+	TcpTransport::Settings settings = TestSettings();
+	settings.io_uring = true;
+	TestSendReceive(0, 0, settings);
+	TestSendReceive(32, 0, settings);
+	TestSendReceive(REMO_MAX_PACKET_PAYLOAD_SIZE, 0, settings);
+	TestSendReceive(300 * 1000, 0, settings);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_LargePayload)
+{
+	// continues in further segments
+	TestSendReceive(300 * 1000);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, PacketPool_SizeClasses)
+{
+	PacketPool pool;
+	const size_t header = REMO_MAX_PACKET_HEADER_SIZE;
+	EXPECT_EQ(PacketPool::get_size_class(0), PacketSize::small);
+	EXPECT_EQ(PacketPool::get_size_class(REMO_PACKET_SIZE_SMALL - header), PacketSize::small);
+	EXPECT_EQ(PacketPool::get_size_class(REMO_PACKET_SIZE_SMALL - header + 1), PacketSize::medium);
+	EXPECT_EQ(PacketPool::get_size_class(REMO_PACKET_SIZE_MEDIUM - header + 1), PacketSize::large);
+	EXPECT_EQ(PacketPool::get_size_class(REMO_MAX_MESSAGE_SIZE), PacketSize::large);
+
+	// packets are sized for their class
+	packet_ptr packet(pool.take(1000));
+	ASSERT_TRUE(packet != nullptr);
+	EXPECT_EQ(packet->get_buffer_size(), (size_t)REMO_PACKET_SIZE_MEDIUM);
+	EXPECT_EQ(packet->get_payload().get_capacity(), REMO_PACKET_SIZE_MEDIUM - header);
+	EXPECT_EQ(pool.get_stats(PacketSize::medium).peak_size, pool.get_limits(PacketSize::medium).low_watermark);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, PacketPool_Slab)
+{
+	PacketPool::Limits limits;
+	limits.slab = true;
+	limits.small.high_watermark = 4;
+	limits.medium.high_watermark = 2;
+	limits.large.high_watermark = 1;
+	PacketPool pool(limits);
+	ASSERT_TRUE(pool.get_slab() != nullptr);
+	const uint8_t* begin = pool.get_slab()->get_data();
+	const uint8_t* end = begin + pool.get_slab()->get_size();
+	EXPECT_EQ((uintptr_t)begin % 64, 0u);
+
+	// all packets are allocated in advance, within the slab
+	EXPECT_EQ(pool.get_size(), 7u);
+	packet_ptr packet(pool.take(REMO_PACKET_SIZE_MEDIUM));
+	ASSERT_TRUE(packet != nullptr);
+	EXPECT_EQ(packet->get_buffer_size(), (size_t)REMO_PACKET_SIZE_LARGE);
+	EXPECT_GE(packet->get_data() - packet->get_header_capacity(), begin);
+	EXPECT_LE(packet->get_data() + packet->get_payload().get_capacity(), end);
+
+	// and kept when recycled
+	packet.reset();
+	EXPECT_EQ(pool.get_size(), 7u);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, PacketPool_Slices)
+{
+	PacketPool::Limits limits;
+	limits.small.low_watermark = 1;
+	limits.small.high_watermark = 1;
+	limits.small.wait_timeout_ms = 0;
+	PacketPool pool(limits);
+
+	packet_ptr block(pool.take());
+	ASSERT_TRUE(block != nullptr);
+	Writer writer(block->get_payload());
+	writer.write<uint32_t>(0x11111111);
+	writer.write<uint32_t>(0x22222222);
+
+	// a slice refers to the bytes of the packet, and takes the rest along
+	packet_ptr slice(pool.take_slice());
+	ASSERT_TRUE(slice != nullptr);
+	slice->slice(*block, sizeof(uint32_t));
+	block->drop_front(sizeof(uint32_t));
+	EXPECT_EQ(slice->get_size(), sizeof(uint32_t));
+	EXPECT_EQ(block->get_size(), sizeof(uint32_t));
+	EXPECT_EQ(Reader(block->get_payload()).read<uint32_t>(), 0x22222222u);
+
+	// the packet is kept as long as the slice is
+	block.reset();
+	EXPECT_EQ(pool.take(), nullptr);
+	EXPECT_EQ(Reader(slice->get_payload()).read<uint32_t>(), 0x11111111u);
+	slice.reset();
+	packet_ptr packet(pool.take());
+	EXPECT_TRUE(packet != nullptr);
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestPipelined(const TcpTransport::Settings& a_settings)
+{
+	const size_t COUNT = 2000;
+
+	TcpTransport transport(a_settings);
+
+	// packets received in a single read are delivered one by one, in order.
+	// all of them are aligned, such that arrays in them can be accessed in place
+	std::promise<void> p;
+	auto f = p.get_future();
+	size_t received = 0;
+	transport.on_accept([&p, &received](Channel* a_channel) {
+		a_channel->on_receive([&p, &received](Channel*, packet_ptr& a_packet) {
+			EXPECT_EQ(a_packet->get_size(), sizeof(uint32_t) + received % 7);
+			EXPECT_EQ(reinterpret_cast<uintptr_t>(a_packet->get_payload().get_data()) % sizeof(uint64_t), 0u)
+				<< "packet " << received;
+			Reader reader(a_packet->get_payload());
+			EXPECT_EQ(reader.read<uint32_t>(), (uint32_t)received);
+			if (++received == COUNT) {
+				p.set_value();
+			}
+		});
+	});
+
+	// send packets of varying size as fast as possible
+	Channel* channel = transport.connect("localhost:1986");
+	for (size_t i = 0; i < COUNT; i++) {
+		packet_ptr packet = transport.take_packet();
+		Writer writer(packet->get_payload());
+		writer.write<uint32_t>((uint32_t)i);
+		for (size_t j = 0; j < i % 7; j++) {
+			writer.write<uint8_t>(0xAA);
+		}
+		channel->send(packet);
+	}
+
+	ASSERT_EQ(f.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_Pipelined)
+{
+	TestPipelined(TestSettings());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_Pipelined_IoUring)
+{
+	TcpTransport::Settings settings = TestSettings();
+	settings.io_uring = true;
+	TestPipelined(settings);
+
+	// runs out of buffers to receive into now and then
+	settings.io_uring_rx_buffers = 2;
+	TestPipelined(settings);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_OutOfPackets)
+{
+	const size_t COUNT = 100;
+	const size_t PAYLOAD_SIZE = 100;
+
+	// the server runs out of packets to receive into, as it holds on to them
+	TcpTransport::Settings server_settings = TestSettings();
+	server_settings.packet_pool.small.low_watermark = 4;
+	server_settings.packet_pool.small.high_watermark = 4;
+	TcpTransport server(server_settings);
+	TcpTransport::Settings client_settings = TestSettings();
+	client_settings.listen_addr = SockAddr("localhost:1987");
+	TcpTransport client(client_settings);
+
+	std::mutex mutex;
+	std::vector<packet_ptr> held;
+	bool holding = true;
+	size_t received = 0;
+	std::promise<TcpThread*> pt;
+	std::promise<void> p;
+	auto f = p.get_future();
+	server.on_accept([&](Channel* a_channel) {
+		pt.set_value(static_cast<TcpChannel*>(a_channel)->get_thread());
+		a_channel->on_receive([&](Channel*, packet_ptr& a_packet) {
+			std::lock_guard<std::mutex> lock(mutex);
+			EXPECT_EQ(a_packet->get_size(), PAYLOAD_SIZE);
+			if (holding) {
+				held.push_back(std::move(a_packet));
+			}
+			if (++received == COUNT) {
+				p.set_value();
+			}
+		});
+	});
+
+	Channel* channel = client.connect("localhost:1986");
+	TcpThread* thread = pt.get_future().get();
+	for (size_t i = 0; i < COUNT; i++) {
+		packet_ptr packet = client.take_packet();
+		packet->get_payload().grow(PAYLOAD_SIZE);
+		channel->send(packet);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		EXPECT_LT(received, COUNT);
+	}
+
+	// the thread of the server does not wait for packets meanwhile
+	std::promise<void> pp;
+	auto fp = pp.get_future();
+	thread->post([&pp]() { pp.set_value(); });
+	EXPECT_EQ(fp.wait_for(std::chrono::milliseconds(200)), std::future_status::ready);
+
+	// and receives the rest once they are recycled
+	thread->post([&]() {
+		std::lock_guard<std::mutex> lock(mutex);
+		holding = false;
+		held.clear();
+	});
+	ASSERT_EQ(f.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+}
+
+//------------------------------------------------------------------------------
+//
+static void SetupEcho(Transport& a_transport)
+{
+	// reply to each packet with the number it starts with
+	a_transport.on_accept([&a_transport](Channel* a_channel) {
+		a_channel->on_receive([&a_transport](Channel* a_channel, packet_ptr& a_packet) {
+			packet_ptr reply = a_transport.take_packet();
+			Writer(reply->get_payload()).write<uint32_t>(Reader(a_packet->get_payload()).read<uint32_t>());
+			a_channel->send(reply);
+		});
+	});
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestReactors(const TcpTransport::Settings& a_settings)
+{
+	const size_t CHANNELS = 8;
+	const size_t COUNT = 200;
+
+	TcpTransport transport(a_settings);
+
+	SetupEcho(transport);
+
+	// remember which threads the replies are received on, per channel
+	std::mutex mutex;
+	std::map<Channel*, std::set<std::thread::id>> threads;
+	std::map<Channel*, uint32_t> received;
+	size_t total = 0;
+	std::promise<void> p;
+	auto f = p.get_future();
+
+	std::vector<Channel*> channels;
+	for (size_t i = 0; i < CHANNELS; i++) {
+		Channel* channel = transport.connect("localhost:1986");
+		channel->on_receive([&](Channel* a_channel, packet_ptr& a_packet) {
+			std::lock_guard<std::mutex> lock(mutex);
+			threads[a_channel].insert(std::this_thread::get_id());
+			// in order per channel
+			EXPECT_EQ(Reader(a_packet->get_payload()).read<uint32_t>(), received[a_channel]++);
+			if (++total == CHANNELS * COUNT) {
+				p.set_value();
+			}
+		});
+		channels.push_back(channel);
+	}
+
+	// interleave sending on all channels
+	for (uint32_t i = 0; i < COUNT; i++) {
+		for (Channel* channel : channels) {
+			packet_ptr packet = transport.take_packet();
+			Writer writer(packet->get_payload());
+			writer.write<uint32_t>(i);
+			channel->send(packet);
+		}
+	}
+	ASSERT_EQ(f.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+
+	// each channel stays with one thread, and they take turns among channels
+	std::set<std::thread::id> all;
+	for (auto& entry : threads) {
+		EXPECT_EQ(entry.second.size(), 1u);
+		all.insert(entry.second.begin(), entry.second.end());
+	}
+	EXPECT_EQ(all.size(), a_settings.reactors);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_Reactors)
+{
+	TcpTransport::Settings settings = TestSettings();
+	settings.reactors = 4;
+	TestReactors(settings);
+	settings.io_uring = true;
+	TestReactors(settings);
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestPost(const TcpTransport::Settings& a_settings)
+{
+	const size_t THREADS = 4;
+	const size_t COUNT = 1000;
+
+	TcpTransport transport(a_settings);
+	Channel* channel = transport.connect("localhost:1986");
+	TcpThread* thread = static_cast<TcpChannel*>(channel)->get_thread();
+
+	// work posted by any thread is done by the thread of the channel, in order
+	std::promise<void> p;
+	auto f = p.get_future();
+	std::vector<size_t> next(THREADS, 0);
+	size_t done = 0;
+	std::set<std::thread::id> ids;
+	std::vector<std::thread> posters;
+	for (size_t t = 0; t < THREADS; t++) {
+		posters.emplace_back([&, t]() {
+			for (size_t i = 0; i < COUNT; i++) {
+				thread->post([&, t, i]() {
+					EXPECT_EQ(next[t]++, i);
+					ids.insert(std::this_thread::get_id());
+					if (++done == THREADS * COUNT) {
+						p.set_value();
+					}
+				});
+			}
+		});
+	}
+	for (std::thread& poster : posters) {
+		poster.join();
+	}
+
+	ASSERT_EQ(f.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+	EXPECT_EQ(ids.size(), 1u);
+	EXPECT_EQ(ids.count(std::this_thread::get_id()), 0u);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, Post)
+{
+	TcpTransport::Settings settings = TestSettings();
+	TestPost(settings);
+	settings.io_uring = true;
+	TestPost(settings);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, Post_Throwing)
+{
+	TcpTransport transport(TestSettings());
+	Channel* channel = transport.connect("localhost:1986");
+	TcpThread* thread = static_cast<TcpChannel*>(channel)->get_thread();
+
+	// keep the thread busy, so that the work below is taken at once
+	std::promise<void> busy;
+	std::shared_future<void> release = busy.get_future().share();
+	thread->post([release]() { release.wait(); });
+
+	// work that fails does not drop the work posted after it
+	std::promise<void> p;
+	auto f = p.get_future();
+	thread->post([]() { throw std::runtime_error("failed"); });
+	thread->post([&p]() { p.set_value(); });
+	busy.set_value();
+	ASSERT_EQ(f.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestSendQueue(const TcpTransport::Settings& a_settings)
+{
+	const size_t PAYLOAD_SIZE = 1000;
+
+	// a peer that does not receive for now
+	Socket server(SockProto::TCP);
+	server.set_reuse_addr(true);
+	server.bind(SockAddr("localhost:1987"));
+	server.listen();
+
+	TcpTransport transport(a_settings);
+	Channel* channel = transport.connect("localhost:1987");
+	Socket peer = server.accept();
+
+	// sending does not block, but packets are queued once the socket buffers are full
+	auto make_packet = [&transport](uint32_t a_index) {
+		packet_ptr packet = transport.take_packet(PAYLOAD_SIZE);
+		Writer writer(packet->get_payload());
+		writer.write<uint32_t>(a_index);
+		for (size_t i = sizeof(uint32_t); i < PAYLOAD_SIZE; i++) {
+			writer.write<uint8_t>(0xAA);
+		}
+		return packet;
+	};
+	uint32_t sent = 0;
+	for (;;) {
+		packet_ptr packet = make_packet(sent);
+		if (!channel->try_send(packet)) {
+			// until the queue is full, which leaves the packet to us
+			EXPECT_TRUE(packet != nullptr);
+			EXPECT_EQ(packet->get_header().get_size(), 0u);
+			break;
+		}
+		ASSERT_LT(++sent, 100000u);
+	}
+	packet_ptr packet = make_packet(sent);
+	EXPECT_THROW(channel->send(packet), remo::error);
+
+	// the queue is drained as the peer catches up, in order
+	std::vector<uint8_t> frame(sizeof(uint32_t) + PAYLOAD_SIZE);
+	auto receive_frame = [&peer, &frame]() {
+		size_t received = 0;
+		while (received < frame.size()) {
+			size_t bytes = 0;
+			ASSERT_EQ(peer.recv(&frame[received], frame.size() - received, &bytes), 
+				Socket::IOResult::Success);
+			received += bytes;
+		}
+	};
+	for (uint32_t i = 0; i < sent; i++) {
+		receive_frame();
+		Buffer buffer(frame.data(), frame.size(), frame.size());
+		Reader reader(buffer);
+		ASSERT_EQ(reader.read<uint32_t>(), PAYLOAD_SIZE);
+		ASSERT_EQ(reader.read<uint32_t>(), i);
+	}
+
+	// room again
+	EXPECT_TRUE(channel->try_send(packet));
+	receive_frame();
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendQueue)
+{
+	TcpTransport::Settings settings = TestSettings();
+	settings.send_queue_packets = 16;
+	TestSendQueue(settings);
+	settings.send_queue_packets = 1024;
+	settings.send_queue_bytes = 8 * 1024;
+	TestSendQueue(settings);
+	// packets queued are gathered for a while
+	settings.send_coalesce_us = 1000;
+	TestSendQueue(settings);
+	settings.send_coalesce_us = 0;
+	settings.io_uring = true;
+	TestSendQueue(settings);
+	settings.socket_backend = SocketSet::Backend::Poll;
+	settings.io_uring = false;
+	TestSendQueue(settings);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_Coalescing)
+{
+	TcpTransport::Settings settings = TestSettings();
+	settings.tcp_nodelay = true;
+	settings.send_coalesce_us = 50;
+	TestSendReceive(32, 0, settings);
+	TestSendReceive(300 * 1000, 0, settings);
+	TestPipelined(settings);
+	settings.io_uring = true;
+	TestPipelined(settings);
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestCoalescing(const TcpTransport::Settings& a_settings, size_t a_count,
+	size_t a_payload_size)
+{
+	TcpTransport transport(a_settings);
+
+	std::promise<void> p;
+	auto f = p.get_future();
+	size_t received = 0;
+	transport.on_accept([&p, &received, a_count](Channel* a_channel) {
+		a_channel->on_receive([&p, &received, a_count](Channel*, packet_ptr& a_packet) {
+			EXPECT_EQ(Reader(a_packet->get_payload()).read<uint32_t>(), (uint32_t)received);
+			if (++received == a_count) {
+				p.set_value();
+			}
+		});
+	});
+
+	// packets are sent right away as long as none are queued, so they are not
+	// held back by a window that is much longer than the test may take
+	Channel* channel = transport.connect("localhost:1986");
+	for (size_t i = 0; i < a_count; i++) {
+		packet_ptr packet = transport.take_packet(a_payload_size);
+		Writer writer(packet->get_payload());
+		writer.write<uint32_t>((uint32_t)i);
+		for (size_t j = sizeof(uint32_t); j < a_payload_size; j++) {
+			writer.write<uint8_t>(0xAA);
+		}
+		channel->send(packet);
+	}
+	ASSERT_EQ(f.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_Coalescing_Flush)
+{
+	TcpTransport::Settings settings = TestSettings();
+	settings.send_coalesce_bytes = 4096;
+	settings.send_coalesce_us = 60 * 1000 * 1000;
+
+	// neither the last packet of a burst, nor one on its own
+	TestCoalescing(settings, 3, 8);
+	TestCoalescing(settings, 1, 8);
+	TestCoalescing(settings, 1 + 5, 1000);
+}
+
+//------------------------------------------------------------------------------
+//
+static void TestUds(const UdsTransport::Settings& a_settings, const std::string& a_endpoint)
+{
+	const size_t COUNT = 200;
+
+	const std::string path = a_settings.listen_addr.get_path();
+	{
+		UdsTransport transport(a_settings);
+		if (!path.empty()) {
+			EXPECT_EQ(::access(path.c_str(), F_OK), 0);
+		}
+
+		SetupEcho(transport);
+
+		std::promise<void> p;
+		auto f = p.get_future();
+		size_t received = 0;
+		Channel* channel = transport.connect(a_endpoint);
+		channel->on_receive([&p, &received](Channel*, packet_ptr& a_packet) {
+			EXPECT_EQ(Reader(a_packet->get_payload()).read<uint32_t>(), (uint32_t)received);
+			if (++received == COUNT) {
+				p.set_value();
+			}
+		});
+		for (size_t i = 0; i < COUNT; i++) {
+			packet_ptr packet = transport.take_packet();
+			Writer writer(packet->get_payload());
+			writer.write<uint32_t>((uint32_t)i);
+			channel->send(packet);
+		}
+
+		ASSERT_EQ(f.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+	}
+
+	// no file left behind
+	if (!path.empty()) {
+		EXPECT_NE(::access(path.c_str(), F_OK), 0);
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_Uds)
+{
+	UdsTransport::Settings settings;
+	settings.listen_addr = SockAddr("unix:///tmp/remo-test.sock");
+	TestUds(settings, "unix:///tmp/remo-test.sock");
+	// a path will do
+	TestUds(settings, "/tmp/remo-test.sock");
+
+	// channels are spread among reactors, but accepted by a single one
+	settings.reactors = 2;
+	TestUds(settings, "unix:///tmp/remo-test.sock");
+	settings.reactors = 1;
+
+	settings.io_uring = true;
+	TestUds(settings, "unix:///tmp/remo-test.sock");
+	settings.io_uring = false;
+
+#ifdef __linux__
+	settings.listen_addr = SockAddr("unix://@remo-test");
+	TestUds(settings, "unix://@remo-test");
+#endif
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_Uds_Bad)
+{
+	UdsTransport::Settings settings;
+	settings.listen_addr = SockAddr("unix:///tmp/remo-test.sock");
+	UdsTransport transport(settings);
+
+	// not a Unix socket address
+	try {
+		transport.connect("tcp://localhost:1986");
+		FAIL() << "must throw an exception";
+	} catch (const remo::error& e) {
+		EXPECT_EQ(e.code(), remo::ErrorCode::ERR_SOCKET_INVALID_ADDRESS);
+	}
+
+	// address in use by another transport, whose file must stay
+	try {
+		UdsTransport other(settings);
+		FAIL() << "must throw an exception";
+	} catch (const remo::error& e) {
+		EXPECT_EQ(e.code(), remo::ErrorCode::ERR_SOCKET_BIND_FAILED);
+	}
+	EXPECT_EQ(access("/tmp/remo-test.sock", F_OK), 0);
+	Channel* channel = transport.connect("/tmp/remo-test.sock");
+	EXPECT_TRUE(channel->is_open());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Transport, SendReceive_TcpTransport_Unix)
+{
+	// TcpTransport takes Unix socket addresses as well
+	TcpTransport::Settings settings = TestSettings();
+	settings.listen_addr = SockAddr("unix:///tmp/remo-test.sock");
+	settings.tcp_nodelay = true;
+	TcpTransport transport(settings);
+
+	std::promise<void> p;
+	auto f = p.get_future();
+	transport.on_accept([&p](Channel* a_channel) {
+		a_channel->on_receive([&p](Channel*, packet_ptr& a_packet) {
+			EXPECT_EQ(Reader(a_packet->get_payload()).read<uint32_t>(), 42u);
+			p.set_value();
+		});
+	});
+	Channel* channel = transport.connect("unix:///tmp/remo-test.sock");
+	packet_ptr packet = transport.take_packet();
+	Writer(packet->get_payload()).write<uint32_t>(42);
+	channel->send(packet);
+
+	ASSERT_EQ(f.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+}
+
 //------------------------------------------------------------------------------
 //
 TEST(Transport, SendReceive_Bad_TooLarge)
 {
 	try {
-		TestSendReceive(REMO_MAX_PACKET_PAYLOAD_SIZE + 1);		
+		TestSendReceive(REMO_MAX_MESSAGE_SIZE + 1);		
         FAIL() << "must throw an exception";
     } catch (const remo::error& e) {
         EXPECT_EQ(e.code(), remo::ErrorCode::ERR_PACKET_FULL);
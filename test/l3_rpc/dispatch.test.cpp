@@ -0,0 +1,86 @@
+#include "../test.h"
+
+#include "remo.h"
+#include "l3_rpc/function.h"
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------
+//
+using namespace remo;
+
+//! dispatch a call packet through the given path and return the reply
+template<typename... Args>
+static std::string dispatch_call(Item& a_item, bool a_generic, Args&&... args)
+{
+    trans::Packet call;
+    trans::BinaryWriter call_writer(call.get_payload());
+    call_writer.write_call(a_item.get_name(), args...);
+
+    trans::BinaryReader reader(call.get_payload());
+    reader.read_call_header();
+
+    trans::Packet reply;
+    trans::BinaryWriter reply_writer(reply.get_payload());
+    if (a_generic) {
+        a_item.Item::dispatch(reader, reply_writer);
+    } else {
+        a_item.dispatch(reader, reply_writer);
+    }
+    return reply.get_payload().to_hex();
+}
+
+//------------------------------------------------------------------------------
+// tests
+//------------------------------------------------------------------------------
+//
+TEST(Dispatch, static_matches_generic)
+{
+    auto lambda = [](uint32_t a1, arraysize_t n, float* a2, const double* a3, bool a4) {
+        for (size_t i = 0; i < n.value; i++) {
+            a2[i] = (float)(a2[i] * a3[0]);
+        }
+        return a4 ? a1 : 0;
+    };
+    lambda_function<decltype(lambda)> func("test_func", lambda);
+
+    float a2[3] = { 1.0f, 2.0f, 3.0f };
+    const double a3 = 2.5;
+    EXPECT_EQ(
+        dispatch_call(func, false, (uint32_t)42, arraysize_t(3), &a2[0], &a3, true),
+        dispatch_call(func, true,  (uint32_t)42, arraysize_t(3), &a2[0], &a3, true));
+
+    // const parameter passed as mutable pointer is written back
+    double a4 = 1.5;
+    EXPECT_EQ(
+        dispatch_call(func, false, (uint32_t)42, arraysize_t(3), &a2[0], &a4, false),
+        dispatch_call(func, true,  (uint32_t)42, arraysize_t(3), &a2[0], &a4, false));
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(Dispatch, param_num_mismatch)
+{
+    auto lambda = [](uint32_t, uint32_t) {};
+    lambda_function<decltype(lambda)> func("test_func", lambda);
+
+    // too few
+    try {
+        dispatch_call(func, false, (uint32_t)1);
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_PARAM_NUM_MISMATCH);
+    }
+
+    // too many
+    try {
+        dispatch_call(func, false, (uint32_t)1, (uint32_t)2, (uint32_t)3);
+        FAIL() << "must throw an exception";
+    } catch (const remo::error& e) {
+        EXPECT_EQ(e.code(), remo::ErrorCode::ERR_PARAM_NUM_MISMATCH);
+    }
+}
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------
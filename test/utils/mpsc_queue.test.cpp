@@ -0,0 +1,106 @@
+#include "../test.h"
+
+#include "utils/mpsc_queue.h"
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// tests
+//------------------------------------------------------------------------------
+//
+using namespace remo::utils;
+
+//------------------------------------------------------------------------------
+//
+TEST(MpscQueue, push_and_consume)
+{
+	MpscQueue<int> queue;
+	EXPECT_TRUE(queue.empty());
+	EXPECT_EQ(queue.consume_all([](int&) { FAIL(); }), 0u);
+
+	// only the first push finds the queue empty
+	EXPECT_TRUE(queue.push(1));
+	EXPECT_FALSE(queue.push(2));
+	EXPECT_FALSE(queue.push(3));
+	EXPECT_FALSE(queue.empty());
+
+	// items come out in the order pushed
+	std::vector<int> items;
+	EXPECT_EQ(queue.consume_all([&items](int& a_item) { items.push_back(a_item); }), 3u);
+	EXPECT_EQ(items, std::vector<int>({ 1, 2, 3 }));
+	EXPECT_TRUE(queue.empty());
+
+	// and it is empty again afterwards
+	EXPECT_TRUE(queue.push(4));
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(MpscQueue, move_only)
+{
+	MpscQueue<std::unique_ptr<int>> queue;
+	queue.push(std::unique_ptr<int>(new int(42)));
+	int value = 0;
+	queue.consume_all([&value](std::unique_ptr<int>& a_item) { value = *a_item; });
+	EXPECT_EQ(value, 42);
+
+	// items not consumed are freed with the queue
+	queue.push(std::unique_ptr<int>(new int(43)));
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(MpscQueue, throwing)
+{
+	MpscQueue<int> queue;
+	queue.push(1);
+	queue.push(2);
+	queue.push(3);
+
+	// the items after the failing one are dropped
+	std::vector<int> items;
+	EXPECT_THROW(queue.consume_all([&items](int& a_item) {
+		items.push_back(a_item);
+		if (a_item == 2) {
+			throw std::runtime_error("failed");
+		}
+	}), std::runtime_error);
+	EXPECT_EQ(items, std::vector<int>({ 1, 2 }));
+	EXPECT_TRUE(queue.empty());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(MpscQueue, concurrent)
+{
+	const size_t THREADS = 8;
+	const size_t ITERATIONS = 20000;
+
+	MpscQueue<std::pair<size_t, size_t>> queue;
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < THREADS; t++) {
+		threads.emplace_back([&queue, t]() {
+			for (size_t i = 0; i < ITERATIONS; i++) {
+				queue.push(std::make_pair(t, i));
+			}
+		});
+	}
+
+	// items of each thread come in order, and none is lost
+	std::vector<size_t> next(THREADS, 0);
+	size_t count = 0;
+	while (count < THREADS * ITERATIONS) {
+		count += queue.consume_all([&next](std::pair<size_t, size_t>& a_item) {
+			EXPECT_EQ(a_item.second, next[a_item.first]);
+			next[a_item.first] = a_item.second + 1;
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(count, THREADS * ITERATIONS);
+	EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,190 @@
+#include "../test.h"
+
+#include "utils/recycling.h"
+#include "utils/elastic_pool.h"
+
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// tests
+//------------------------------------------------------------------------------
+//
+using namespace remo;
+
+class MyObject: public Recyclable<MyObject>
+{
+public:
+	using Recyclable<MyObject>::recycle;
+	int value = 0;
+};
+
+typedef RecyclingPool<MyObject> MyPool;
+typedef ElasticPool<MyObject> MyElasticPool;
+
+//------------------------------------------------------------------------------
+//
+TEST(RecyclingPool, take_and_recycle)
+{
+	MyPool pool;
+	EXPECT_EQ(pool.take(), nullptr);
+
+	// objects are taken in reverse order
+	MyObject* obj1 = new MyObject();
+	MyObject* obj2 = new MyObject();
+	pool.add(obj1);
+	pool.add(obj2);
+	EXPECT_EQ(pool.take(), obj2);
+	EXPECT_EQ(pool.take(), obj1);
+	EXPECT_EQ(pool.take(), nullptr);
+
+	// and given back by recycling them
+	obj1->recycle();
+	EXPECT_EQ(pool.take(), obj1);
+	obj1->recycle();
+	obj2->recycle();
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(RecyclingPool, other_pool)
+{
+	MyPool pool1;
+	MyPool pool2;
+	MyObject* obj = new MyObject();
+	pool1.add(obj);
+
+	// objects belong to the pool they were first added to
+	EXPECT_THROW(pool2.add(pool1.take()), remo::error);
+	obj->recycle();
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(RecyclingPool, concurrent)
+{
+	const size_t THREADS = 8;
+	const size_t OBJECTS = 16;
+	const size_t ITERATIONS = 20000;
+
+	MyPool pool;
+	for (size_t i = 0; i < OBJECTS; i++) {
+		pool.add(new MyObject());
+	}
+
+	// each object is owned by a single thread at a time
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < THREADS; t++) {
+		threads.emplace_back([&pool, t]() {
+			for (size_t i = 0; i < ITERATIONS; i++) {
+				MyObject* obj = pool.take();
+				if (obj) {
+					obj->value = (int)t;
+					std::this_thread::yield();
+					EXPECT_EQ(obj->value, (int)t);
+					obj->recycle();
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	// all objects are back
+	size_t count = 0;
+	std::vector<MyObject*> objects;
+	while (MyObject* obj = pool.take()) {
+		objects.push_back(obj);
+		count++;
+	}
+	EXPECT_EQ(count, OBJECTS);
+	for (MyObject* obj : objects) {
+		obj->recycle();
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(ElasticPool, grow_and_shrink)
+{
+	PoolLimits limits;
+	limits.low_watermark = 2;
+	limits.high_watermark = 4;
+	limits.wait_timeout_ms = 0;
+	MyElasticPool pool(limits);
+	EXPECT_EQ(pool.get_stats().size, 2u);
+
+	// grows on demand up to the ceiling
+	std::vector<MyObject*> objects;
+	while (MyObject* obj = pool.take()) {
+		objects.push_back(obj);
+	}
+	EXPECT_EQ(objects.size(), 4u);
+	EXPECT_EQ(pool.get_stats().size, 4u);
+	EXPECT_EQ(pool.get_stats().peak_size, 4u);
+	EXPECT_EQ(pool.get_stats().waits, 0u);
+
+	// shrinks back to the low watermark when recycled
+	for (MyObject* obj : objects) {
+		obj->recycle();
+	}
+	EXPECT_EQ(pool.get_stats().size, 2u);
+	EXPECT_EQ(pool.get_stats().peak_size, 4u);
+
+	// and grows again
+	objects.clear();
+	while (MyObject* obj = pool.take()) {
+		objects.push_back(obj);
+	}
+	EXPECT_EQ(objects.size(), 4u);
+	for (MyObject* obj : objects) {
+		obj->recycle();
+	}
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(ElasticPool, wait_timeout)
+{
+	PoolLimits limits;
+	limits.low_watermark = 1;
+	limits.high_watermark = 1;
+	limits.wait_timeout_ms = 20;
+	MyElasticPool pool(limits);
+
+	// gives up after the timeout at the ceiling
+	MyObject* obj = pool.take();
+	ASSERT_NE(obj, nullptr);
+	EXPECT_EQ(pool.take(), nullptr);
+	EXPECT_EQ(pool.try_take(), nullptr);
+	EXPECT_EQ(pool.get_stats().waits, 1u);
+	obj->recycle();
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(ElasticPool, wait_for_recycle)
+{
+	PoolLimits limits;
+	limits.low_watermark = 0;
+	limits.high_watermark = 1;
+	limits.wait_timeout_ms = 10000;
+	MyElasticPool pool(limits);
+
+	// a waiting thread gets the object as soon as it is recycled
+	MyObject* obj = pool.take();
+	ASSERT_NE(obj, nullptr);
+	std::thread thread([obj]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		obj->recycle();
+	});
+	EXPECT_EQ(pool.take(), obj);
+	thread.join();
+	EXPECT_EQ(pool.get_stats().waits, 1u);
+	obj->recycle();
+}
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------
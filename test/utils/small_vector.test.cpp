@@ -0,0 +1,116 @@
+#include "../test.h"
+
+#include "utils/small_vector.h"
+
+#include <memory>
+
+//------------------------------------------------------------------------------
+// tests
+//------------------------------------------------------------------------------
+//
+using namespace remo::utils;
+
+typedef SmallVector<int, 4> MyVector;
+
+//------------------------------------------------------------------------------
+//
+TEST(SmallVector, empty)
+{
+	MyVector vec;
+
+	EXPECT_EQ(vec.size(), (size_t)0);
+	EXPECT_EQ(vec.capacity(), (size_t)4);
+	EXPECT_TRUE(vec.empty());
+	EXPECT_TRUE(vec.is_inline());
+	EXPECT_EQ(vec.begin(), vec.end());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SmallVector, push_back)
+{
+	MyVector vec;
+
+	// fill inline storage
+	for (int i = 0; i < 4; i++) {
+		vec.push_back(i);
+	}
+	EXPECT_EQ(vec.size(), (size_t)4);
+	EXPECT_TRUE(vec.is_inline());
+
+	// spill to heap
+	for (int i = 4; i < 10; i++) {
+		vec.push_back(i);
+	}
+	EXPECT_EQ(vec.size(), (size_t)10);
+	EXPECT_EQ(vec.capacity(), (size_t)16);
+	EXPECT_FALSE(vec.is_inline());
+
+	// check contents
+	int expected = 0;
+	for (int value : vec) {
+		EXPECT_EQ(value, expected++);
+	}
+
+	// capacity is retained
+	vec.clear();
+	EXPECT_TRUE(vec.empty());
+	EXPECT_EQ(vec.capacity(), (size_t)16);
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SmallVector, copy_and_move)
+{
+	MyVector small;
+	small.push_back(1);
+	small.push_back(2);
+
+	MyVector large;
+	for (int i = 0; i < 10; i++) {
+		large.push_back(i);
+	}
+
+	// copy
+	MyVector copy(large);
+	EXPECT_EQ(copy.size(), (size_t)10);
+	EXPECT_EQ(copy[9], 9);
+	copy = small;
+	EXPECT_EQ(copy.size(), (size_t)2);
+	EXPECT_EQ(copy[1], 2);
+
+	// move from heap storage
+	MyVector moved(std::move(large));
+	EXPECT_EQ(moved.size(), (size_t)10);
+	EXPECT_FALSE(moved.is_inline());
+	EXPECT_TRUE(large.empty());
+	EXPECT_TRUE(large.is_inline());
+
+	// move from inline storage
+	moved = std::move(small);
+	EXPECT_EQ(moved.size(), (size_t)2);
+	EXPECT_TRUE(moved.is_inline());
+	EXPECT_EQ(moved[0], 1);
+	EXPECT_TRUE(small.empty());
+}
+
+//------------------------------------------------------------------------------
+//
+TEST(SmallVector, destroys_elements)
+{
+	std::shared_ptr<int> ptr = std::make_shared<int>(42);
+	{
+		SmallVector<std::shared_ptr<int>, 2> vec;
+		for (int i = 0; i < 5; i++) {
+			vec.push_back(ptr);
+		}
+		EXPECT_EQ(ptr.use_count(), 6);
+		vec.pop_back();
+		EXPECT_EQ(ptr.use_count(), 5);
+	}
+	EXPECT_EQ(ptr.use_count(), 1);
+}
+
+//------------------------------------------------------------------------------
+// end of file
+//------------------------------------------------------------------------------